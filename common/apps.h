@@ -0,0 +1,24 @@
+// Defines the app index file format used by both the patcher and the launcher
+#ifndef _APPS_H_
+#define _APPS_H_
+
+#include <stdint.h>
+
+// Every memory card has its own index listing save directories that contain title.cfg.
+// The launcher adds the app directory to the index when the app is launched from the memory card browser
+// and removes it when title.cfg no longer exists. The patched browser uses the index to launch indexed apps
+// without waiting for the directory listing.
+#define APP_INDEX_MAGIC 0x5050414F // "OAPP"
+#define APP_INDEX_MAX_ENTRIES 64
+#define APP_INDEX_NAME_LEN 32 // Memory card directory names are limited to 31 characters
+
+typedef struct {
+  uint32_t magic;
+  uint32_t count; // Number of entries following the header
+} appIndexHeader;
+
+typedef struct {
+  char dirName[APP_INDEX_NAME_LEN];
+} appIndexEntry;
+
+#endif
@@ -0,0 +1,22 @@
+// COP0 Count register access shared by the patcher and the launcher
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <stdint.h>
+
+// The Count register increments at the EE clock rate (294.912 MHz) and wraps around every ~14.5 s
+#define CLOCK_TICKS_PER_MS 294912
+
+#ifdef _EE
+// Returns the current COP0 Count value
+static inline uint32_t readCount(void) {
+  uint32_t count;
+  asm volatile("mfc0 %0, $9" : "=r"(count));
+  return count;
+}
+#else
+// Host builds (see tests/) provide the clock source
+uint32_t readCount(void);
+#endif
+
+#endif
@@ -12,6 +12,22 @@
 #define LAUNCHER_PATH "mc0:/BOOT/launcher.elf"
 #endif
 
+#ifndef STATS_PATH
+#define STATS_PATH "mc0:/SYS-CONF/OSDMENU.STA"
+#endif
+
+#ifndef APP_INDEX_PATH
+#define APP_INDEX_PATH "mc0:/SYS-CONF/OSDMENU.APP"
+#endif
+
+#ifndef TRACE_PATH
+#define TRACE_PATH "mc0:/SYS-CONF/OSDMENU.TRC"
+#endif
+
+#ifndef IPCONFIG_PATH
+#define IPCONFIG_PATH "mc0:/SYS-CONF/IPCONFIG.DAT"
+#endif
+
 #ifndef DKWDRV_PATH
 #define DKWDRV_PATH "mc0:/BOOT/DKWDRV.ELF"
 #endif
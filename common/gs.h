@@ -14,6 +14,12 @@ typedef enum {
   GS_MODE_DTV_1080I
 } GSVideoMode;
 
+// Display area position (X in VCK units, Y in raster units). Same as the gsKit defaults
+#define GS_DISPLAY_X_NTSC 652
+#define GS_DISPLAY_Y_NTSC 26
+#define GS_DISPLAY_X_PAL 680
+#define GS_DISPLAY_Y_PAL 37
+
 //---------------------------------------------------------------------------
 // GS_PACKET macros
 //---------------------------------------------------------------------------
@@ -93,8 +99,12 @@ typedef enum {
 //---------------------------------------------------------------------------
 #define GS_REG_PRIM 0x00       // Select and configure current drawing primitive
 #define GS_REG_RGBAQ 0x01      // Setup current vertex color
+#define GS_REG_UV 0x03         // Set texel coordinate
 #define GS_REG_XYZ2 0x05       // Set vertex coordinate and 'kick' drawing
+#define GS_REG_TEX0_1 0x06     // Texture buffer and CLUT settings (Context 1)
+#define GS_REG_TEX1_1 0x14     // Texture filtering settings (Context 1)
 #define GS_REG_XYOFFSET_1 0x18 // Mapping from Primitive to Window coordinate system (Context 1)
+#define GS_REG_TEXFLUSH 0x3f   // Flush texture cache
 #define GS_REG_SCISSOR_1 0x40  // Setup clipping rectangle (Context 1)
 #define GS_REG_FRAME_1 0x4c    // Frame buffer settings (Context 1)
 #define GS_REG_BITBLTBUF 0x50  // Setup Image Transfer Between EE and GS
@@ -120,10 +130,37 @@ typedef enum {
 //---------------------------------------------------------------------------
 #define GS_RGBAQ(R, G, B, A, Q) (((uint64_t)(R) << 0) | ((uint64_t)(G) << 8) | ((uint64_t)(B) << 16) | ((uint64_t)(A) << 24) | ((uint64_t)(Q) << 32))
 //---------------------------------------------------------------------------
+// UV Register
+//   U, V - Texel coordinates (12.4 fixed point)
+//---------------------------------------------------------------------------
+#define GS_UV(U, V) (((uint64_t)(U) << 0) | ((uint64_t)(V) << 16))
+//---------------------------------------------------------------------------
 // XYZ2 Register
 //---------------------------------------------------------------------------
 #define GS_XYZ2(X, Y, Z) (((uint64_t)(X) << 0) | ((uint64_t)(Y) << 16) | ((uint64_t)(Z) << 32))
 //---------------------------------------------------------------------------
+// TEX0_x Register - Texture Information
+//   TBP0 - Texture buffer address (Address/64)
+//   TBW  - Texture buffer width (Texels/64)
+//   PSM  - Texture pixel format
+//   TW   - Texture width (log2)
+//   TH   - Texture height (log2)
+//   TCC  - Color component (0 = RGB, 1 = RGBA)
+//   TFX  - Texture function (1 = DECAL)
+//   CBP  - CLUT buffer address (Address/64)
+//   CPSM - CLUT pixel format (0 = 32bit RGBA)
+//   CSM  - CLUT storage mode (0 = CSM1)
+//   CSA  - CLUT entry offset
+//   CLD  - CLUT buffer load control (1 = always load)
+//---------------------------------------------------------------------------
+#define GS_TEX0(TBP0, TBW, PSM, TW, TH, TCC, TFX, CBP, CPSM, CSM, CSA, CLD)                                                                          \
+  (((uint64_t)(TBP0) << 0) | ((uint64_t)(TBW) << 14) | ((uint64_t)(PSM) << 20) | ((uint64_t)(TW) << 26) | ((uint64_t)(TH) << 30) |                   \
+   ((uint64_t)(TCC) << 34) | ((uint64_t)(TFX) << 35) | ((uint64_t)(CBP) << 37) | ((uint64_t)(CPSM) << 51) | ((uint64_t)(CSM) << 55) |               \
+   ((uint64_t)(CSA) << 56) | ((uint64_t)(CLD) << 61))
+
+#define GS_PSM_CT32 0x00
+#define GS_PSM_T8 0x13
+//---------------------------------------------------------------------------
 // XYOFFSET_x Register
 //---------------------------------------------------------------------------
 #define GS_XYOFFSET(OFX, OFY) (((uint64_t)(OFX) << 0) | ((uint64_t)(OFY) << 32))
@@ -209,4 +246,17 @@ typedef enum {
 #define GIF_QWC ((volatile uint32_t *)(GS_REG_GIF_QWC))
 #define SET_QWC(WHICH, SIZE) *WHICH = (uint32_t)(SIZE)
 
+//---------------------------------------------------------------------------
+// GS functions (gs.c)
+//---------------------------------------------------------------------------
+
+// Resets and initializes GS
+int gsInit(GSVideoMode vmode);
+
+// Draws black rectangle
+void gsClearScreen();
+
+// Transfers image data to GS memory at specified buffer and coordinates
+void gsLoadImage(uint32_t dbp, uint32_t dbw, uint32_t psm, uint16_t x, uint16_t y, uint16_t w, uint16_t h, void *data, uint32_t qtotal);
+
 #endif
@@ -0,0 +1,74 @@
+#include "handoff.h"
+#include <string.h>
+
+// Returns the FNV-1a hash of the data
+static uint32_t hashData(uint8_t *data, uint32_t size) {
+  uint32_t hash = 0x811c9dc5;
+  for (uint32_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 0x01000193;
+  }
+  return hash;
+}
+
+// Initializes the handoff block
+void handoffInit(handoffHeader *handoff, uint16_t itemIdx, uint8_t mcSlot, uint8_t flags) {
+  handoff->magic = 0; // Keep the block invalid until it is sealed
+  handoff->version = HANDOFF_VERSION;
+  handoff->size = 0;
+  handoff->checksum = 0;
+  handoff->itemIdx = itemIdx;
+  handoff->mcSlot = mcSlot;
+  handoff->flags = flags;
+}
+
+// Appends the string to the handoff block. Returns 0 on success or -1 if the string doesn't fit into maxSize
+int handoffAddString(handoffHeader *handoff, uint32_t maxSize, HandoffStringType type, const char *str) {
+  uint32_t len = strlen(str) + 1;
+  if (sizeof(handoffHeader) + handoff->size + len + 1 > maxSize)
+    return -1;
+
+  char *data = (char *)&handoff[1] + handoff->size;
+  data[0] = type;
+  memcpy(&data[1], str, len);
+  handoff->size += len + 1;
+  return 0;
+}
+
+// Calculates the block checksum. Must be called after adding all strings
+void handoffSeal(handoffHeader *handoff) {
+  handoff->checksum = hashData((uint8_t *)&handoff[1], handoff->size);
+  handoff->magic = HANDOFF_MAGIC;
+}
+
+// Returns 0 if the handoff block is valid and fits into maxSize
+int handoffValidate(handoffHeader *handoff, uint32_t maxSize) {
+  if ((handoff->magic != HANDOFF_MAGIC) || (handoff->version != HANDOFF_VERSION) || (sizeof(handoffHeader) + handoff->size > maxSize))
+    return -1;
+
+  // The data must end with a terminated string
+  char *data = (char *)&handoff[1];
+  if (handoff->size && (data[handoff->size - 1] != '\0'))
+    return -1;
+
+  if (hashData((uint8_t *)data, handoff->size) != handoff->checksum)
+    return -1;
+
+  return 0;
+}
+
+// Returns the next string of the given type after prev or the first one if prev is NULL.
+// Returns NULL if there are no more strings. The block must be validated first
+char *handoffNextString(handoffHeader *handoff, HandoffStringType type, char *prev) {
+  char *data = (char *)&handoff[1];
+  char *end = data + handoff->size;
+  // Skip to the string following prev
+  char *pos = prev ? (prev + strlen(prev) + 1) : data;
+
+  while (pos < end) {
+    if (*pos == type)
+      return pos + 1;
+    pos += strlen(pos) + 1;
+  }
+  return NULL;
+}
@@ -0,0 +1,54 @@
+// Defines the handoff block passed from the patcher to the launcher
+#ifndef _HANDOFF_H_
+#define _HANDOFF_H_
+
+#include <stdint.h>
+
+// When launching an OSDMENU.CNF item, the patcher stores the item paths, arguments
+// and CDROM options in the unused BIOS memory right below the patcher.
+// ExecPS2 doesn't clear this memory, so the launcher can use the block instead of parsing OSDMENU.CNF again.
+// The launcher falls back to parsing the config file if the block is missing, doesn't match the item or fails validation.
+// The block is cleared by the launcher when it is consumed and by the ELF loader when the launcher wipes 0x84000-0x100000.
+//
+// The header is followed by header.size bytes of string data.
+// Every string starts with the HandoffStringType byte and is terminated by the NUL character.
+#define HANDOFF_ADDRESS 0x000da000 // Must stay above the ELF loader (0x84000) and below the patcher (0xdb000)
+#define HANDOFF_MAX_SIZE 0x1000
+#define HANDOFF_MAGIC 0x46444E48 // "HNDF"
+#define HANDOFF_VERSION 1
+
+typedef enum {
+  HANDOFF_PATH = 'P',   // Item path
+  HANDOFF_ARG = 'A',    // Item argument
+  HANDOFF_DKWDRV = 'D', // DKWDRV path resolved by the patcher
+} HandoffStringType;
+
+typedef enum {
+  HANDOFF_FLAG_SKIP_PS2_LOGO = (1 << 0),  // cdrom_skip_ps2logo
+  HANDOFF_FLAG_DISABLE_GAMEID = (1 << 1), // cdrom_disable_gameid
+  HANDOFF_FLAG_USE_DKWDRV = (1 << 2),     // cdrom_use_dkwdrv
+} HandoffFlags;
+
+typedef struct {
+  uint32_t magic;    // HANDOFF_MAGIC
+  uint16_t version;  // HANDOFF_VERSION
+  uint16_t size;     // Size of the string data following the header
+  uint32_t checksum; // FNV-1a hash of the string data
+  uint16_t itemIdx;  // Item index in OSDMENU.CNF
+  uint8_t mcSlot;    // Memory card containing OSDMENU.CNF
+  uint8_t flags;     // HandoffFlags
+} handoffHeader;
+
+// Initializes the handoff block
+void handoffInit(handoffHeader *handoff, uint16_t itemIdx, uint8_t mcSlot, uint8_t flags);
+// Appends the string to the handoff block. Returns 0 on success or -1 if the string doesn't fit into maxSize
+int handoffAddString(handoffHeader *handoff, uint32_t maxSize, HandoffStringType type, const char *str);
+// Calculates the block checksum. Must be called after adding all strings
+void handoffSeal(handoffHeader *handoff);
+// Returns 0 if the handoff block is valid and fits into maxSize
+int handoffValidate(handoffHeader *handoff, uint32_t maxSize);
+// Returns the next string of the given type after prev or the first one if prev is NULL.
+// Returns NULL if there are no more strings. The block must be validated first
+char *handoffNextString(handoffHeader *handoff, HandoffStringType type, char *prev);
+
+#endif
@@ -0,0 +1,22 @@
+// Defines the launch statistics file format used by both the patcher and the launcher
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stdint.h>
+
+// The launcher appends a record to the statistics file every time a menu item is launched.
+// Once the file reaches STATS_MAX_RECORDS records, the launcher compacts it into one record per item.
+#define STATS_MAX_RECORDS 512
+
+// Packs the date and time into a single value that can be compared directly
+#define STATS_SET_TIMESTAMP(year, month, day, hour, minute, second)                                                                                  \
+  (((uint32_t)(year) & 0x7F) << 25 | ((uint32_t)(month) & 0xF) << 21 | ((uint32_t)(day) & 0x1F) << 16 | ((uint32_t)(hour) & 0x1F) << 11 |            \
+   ((uint32_t)(minute) & 0x3F) << 5 | (((uint32_t)(second) >> 1) & 0x1F))
+
+typedef struct {
+  uint16_t itemIdx;     // Item index in OSDMENU.CNF
+  uint16_t launchCount; // Number of launches, always 1 for appended records
+  uint32_t timestamp;   // Last launch timestamp
+} launchStatsRecord;
+
+#endif
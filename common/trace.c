@@ -0,0 +1,51 @@
+#include "trace.h"
+#include "clock.h"
+
+static traceEvent traceRing[TRACE_MAX_EVENTS];
+static uint32_t traceHead = 0;  // Index of the next event
+static uint32_t traceCount = 0; // Number of valid events in the ring
+static uint32_t lastCount = 0;  // Last COP0 Count value
+static uint32_t epoch = 0;      // Number of detected Count wraparounds
+
+// Block buffer used by traceDump
+static struct {
+  traceBlockHeader header;
+  traceEvent events[TRACE_MAX_EVENTS];
+} traceBlock;
+
+// Records the event in the ring
+void traceRecord(uint8_t phase, uint8_t type, uint16_t arg) {
+  uint32_t count = readCount();
+
+  if (count < lastCount)
+    epoch++;
+  lastCount = count;
+
+  traceEvent *event = &traceRing[traceHead];
+  event->timestamp = (epoch << 24) | (count >> 8);
+  event->phase = phase;
+  event->type = type;
+  event->arg = arg;
+
+  traceHead = (traceHead + 1) % TRACE_MAX_EVENTS;
+  if (traceCount < TRACE_MAX_EVENTS)
+    traceCount++;
+}
+
+// Copies the header and all recorded events into the static buffer and resets the ring.
+// Returns the pointer to the buffer and stores the block size in size
+void *traceDump(uint16_t source, int *size) {
+  // Copy events starting from the oldest one
+  uint32_t start = (traceHead + TRACE_MAX_EVENTS - traceCount) % TRACE_MAX_EVENTS;
+  for (uint32_t i = 0; i < traceCount; i++)
+    traceBlock.events[i] = traceRing[(start + i) % TRACE_MAX_EVENTS];
+
+  traceBlock.header.magic = TRACE_MAGIC;
+  traceBlock.header.eventCount = traceCount;
+  traceBlock.header.source = source;
+  *size = sizeof(traceBlockHeader) + traceCount * sizeof(traceEvent);
+
+  traceHead = 0;
+  traceCount = 0;
+  return &traceBlock;
+}
@@ -0,0 +1,76 @@
+// Lightweight boot-time tracing shared by the patcher and the launcher.
+// Tracing is compiled in only when ENABLE_TRACE is defined, otherwise all TRACE_* macros are no-ops.
+//
+// Trace file format (TRACE_PATH, little-endian):
+// Every program that flushes the trace appends a block made of traceBlockHeader
+// followed by traceBlockHeader.eventCount traceEvent records.
+// The patcher truncates the file on boot, the launcher appends to it.
+// patcher/tools/tracedump.c decodes the file into per-phase timelines.
+//
+// Event timestamps are derived from the COP0 Count register, which increments at the EE clock rate (294.912 MHz).
+// The lower 24 bits contain Count >> 8 (~0.87 us resolution) and the upper 8 bits count Count wraparounds (~14.5 s).
+// Wraparounds can only be detected for consecutive events, so timestamps are comparable only within a single block.
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+
+#define TRACE_MAGIC 0x43525430 // "0TRC"
+#define TRACE_MAX_EVENTS 64    // Ring size, older events are overwritten
+
+// Traced phases
+typedef enum {
+  TRACE_PATCHER_MAIN = 1, // Patcher entry point
+  TRACE_LOAD_CONFIG,      // Patcher config parsing
+  TRACE_SPLASH,           // Splash screen
+  TRACE_PATCH_OSDSYS,     // OSDSYS pattern scans and patching
+  TRACE_LAUNCH_ITEM,      // Patcher handing off to the launcher
+  TRACE_LAUNCHER_MAIN,    // Launcher entry point
+  TRACE_INIT_MODULES,     // IOP reset and module loading, arg contains DeviceType
+  TRACE_BDM_WAIT,         // Waiting for BDM mountpoints, end arg contains the number of mounted devices
+  TRACE_DISC_READY,       // Waiting for disc
+  TRACE_LOAD_ELF,         // Loading the target ELF
+} TracePhase;
+
+typedef enum {
+  TRACE_EVENT_BEGIN = 1, // Phase started
+  TRACE_EVENT_END,       // Phase ended, arg contains the result
+  TRACE_EVENT_MARK,      // Single point in time
+} TraceEventType;
+
+typedef struct {
+  uint32_t timestamp; // See the format description above
+  uint8_t phase;      // TracePhase
+  uint8_t type;       // TraceEventType
+  uint16_t arg;       // Phase-specific argument
+} traceEvent;
+
+typedef struct {
+  uint32_t magic;      // TRACE_MAGIC
+  uint16_t eventCount; // Number of events following the header
+  uint16_t source;     // 0 for patcher, 1 for launcher
+} traceBlockHeader;
+
+#ifdef ENABLE_TRACE
+// Records the event in the ring
+void traceRecord(uint8_t phase, uint8_t type, uint16_t arg);
+// Copies the header and all recorded events into the static buffer and resets the ring.
+// Returns the pointer to the buffer and stores the block size in size
+void *traceDump(uint16_t source, int *size);
+
+#define TRACE_BEGIN(phase, arg) traceRecord((phase), TRACE_EVENT_BEGIN, (arg))
+#define TRACE_END(phase, arg) traceRecord((phase), TRACE_EVENT_END, (arg))
+#define TRACE_MARK(phase, arg) traceRecord((phase), TRACE_EVENT_MARK, (arg))
+#else
+#define TRACE_BEGIN(phase, arg)                                                                                                                      \
+  do {                                                                                                                                               \
+  } while (0)
+#define TRACE_END(phase, arg)                                                                                                                        \
+  do {                                                                                                                                               \
+  } while (0)
+#define TRACE_MARK(phase, arg)                                                                                                                       \
+  do {                                                                                                                                               \
+  } while (0)
+#endif
+
+#endif
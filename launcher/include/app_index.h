@@ -0,0 +1,9 @@
+#ifndef _APP_INDEX_H_
+#define _APP_INDEX_H_
+
+// Adds the directory containing cfgPath to the app index on the same memory card if cfgPath points to title.cfg.
+// If isApp is 0, removes the directory from the index instead since title.cfg no longer exists.
+// Returns 1 if the index has been updated, 0 if the directory is already up to date or a negative number on error
+int updateAppIndex(const char *cfgPath, int isApp);
+
+#endif
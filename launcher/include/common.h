@@ -24,11 +24,6 @@ typedef enum {
   Device_CDROM = (1 << 9),
 } DeviceType;
 
-typedef enum {
-  PAL_640_512_32,
-  NTSC_640_448_32
-} GSVideoMode;
-
 // A simple linked list for paths and arguments
 typedef struct linkedStr {
   char *str;
@@ -53,12 +48,22 @@ char *normalizePath(char *path, DeviceType type);
 // Attempts to launch ELF from device and path in argv[0]
 int launchPath(int argc, char *argv[]);
 
+// Attempts to launch ELF from every path in paths, in order.
+// Loads drivers for all compatible devices at once to avoid resetting IOP between attempts.
+// argv[0] is set to the path being tried
+int launchPaths(int argc, char *argv[], linkedStr *paths);
+
 // Adds a new string to linkedStr and returns
 linkedStr *addStr(linkedStr *lstr, char *str);
 
 // Frees all elements of linkedStr
 void freeLinkedStr(linkedStr *lstr);
 
+#ifdef ENABLE_TRACE
+// Appends recorded trace events to the trace file on the memory card
+void flushTrace(void);
+#endif
+
 #ifdef ENABLE_PRINTF
     #define DPRINTF(x...) printf(x)
 #else
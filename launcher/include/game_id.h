@@ -1,6 +1,23 @@
 #ifndef _GAME_ID_H_
 #define _GAME_ID_H_
 
+#include "gs.h"
+#include <stdint.h>
+
+// Game ID data: detect word, address offset, CRC, length, up to 11 characters, end word and padding
+#define GAMEID_MAX_DATA 18
+// Strip height in pixels. The strip is 16 pixels wide for every data byte
+#define GAMEID_STRIP_HEIGHT 2
+
+// Encodes the game ID into data. Returns the data length
+int encodeGameID(const char *gameID, uint8_t *data);
+
+// Renders encoded data into PSMCT32 pixels
+void buildStrip(const uint8_t *data, int dataLen, uint32_t *pixels);
+
+// Returns the frame buffer position of the strip for the video mode
+void getStripPosition(GSVideoMode mode, int dataLen, int *x, int *y);
+
 // Initializes GS and displays visual game ID
 void gsDisplayGameID(const char *gameID);
 
@@ -15,4 +15,15 @@ void applyXPARAM(char *gameID);
 // Initializes IOP modules for given device type
 int initModules(DeviceType device);
 
+// Returns the devices served by the module that failed to load during the last initModules call
+DeviceType getFailedDevices();
+
+// Sets IPCONFIG.DAT path resolved by the patcher
+void setIPConfigPath(const char *path);
+
+#ifdef EXTERNAL_DRIVERS
+// Sets the directory to load device drivers from
+void initDriverPath(const char *launcherPath);
+#endif
+
 #endif
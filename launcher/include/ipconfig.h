@@ -0,0 +1,26 @@
+#ifndef _IPCONFIG_H_
+#define _IPCONFIG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Max IPCONFIG.DAT size, the file contains three space-separated IPv4 addresses
+#define IPCONFIG_MAX_SIZE 64
+// Max length of the dotted-decimal IPv4 address including the string terminator
+#define IP_ADDRESS_LEN 16
+
+typedef struct {
+  uint8_t ip[4];      // IP address
+  uint8_t netmask[4]; // Network mask, all zeroes if missing
+  uint8_t gateway[4]; // Gateway address, all zeroes if missing
+} ipConfig;
+
+// Parses IPCONFIG.DAT contents. data must be NUL-terminated.
+// Netmask and gateway are optional. Returns 0 on success or -EINVAL if any present address is invalid
+int parseIPConfig(const char *data, ipConfig *config);
+
+// Writes the address in dotted-decimal notation without leading zeroes into buf.
+// Returns the string length or -1 if the buffer is too small
+int formatIPAddress(char *buf, size_t size, const uint8_t *addr);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef _LAUNCH_STATS_H_
+#define _LAUNCH_STATS_H_
+
+// Appends the launch record for OSDMENU.CNF item to the statistics file on the memory card containing cnfPath
+int updateLaunchStats(const char *cnfPath, int itemIdx);
+
+#endif
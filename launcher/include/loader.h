@@ -1,6 +1,10 @@
 #ifndef _LOADER_H_
 #define _LOADER_H_
 
+// If set, the ELF loader clears all user memory instead of only the memory used by the launcher.
+// Defaults to LOADER_FULL_WIPE and is set by the -fullwipe argument
+extern int loaderFullWipe;
+
 // Loads and executes ELF specified in argv[0]
 int LoadELFFromFile(int argc, char *argv[]);
 
@@ -10,10 +10,14 @@
 # Modified to not reset IOP
 */
 
+#include <fcntl.h>
+#include <fileXio_rpc.h>
 #include <kernel.h>
 #include <loadfile.h>
 #include <ps2sdkapi.h>
 #include <sifrpc.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 //--------------------------------------------------------------
@@ -33,17 +37,182 @@ PS2_DISABLE_AUTOSTART_PTHREAD();
 //--------------------------------------------------------------
 // Start of function code:
 //--------------------------------------------------------------
+// Clears 64 bytes at the quadword-aligned address
+static inline void wipeBlock(uint32_t addr) {
+#ifdef _EE
+  asm volatile("\tsq $0, 0(%0) \n"
+               "\tsq $0, 16(%0) \n"
+               "\tsq $0, 32(%0) \n"
+               "\tsq $0, 48(%0) \n" ::"r"(addr));
+#else
+  // Host tests
+  memset((void *)addr, 0, 64);
+#endif
+}
+
+// Clears 16 bytes at the quadword-aligned address
+static inline void wipeQuad(uint32_t addr) {
+#ifdef _EE
+  asm volatile("\tsq $0, 0(%0) \n" ::"r"(addr));
+#else
+  memset((void *)addr, 0, 16);
+#endif
+}
+
 // Clear user memory
 // PS2Link (C) 2003 Tord Lindstrom (pukko@home.se)
 //         (C) 2003 adresd (adresd_ps2dev@yahoo.com)
 //--------------------------------------------------------------
 static void wipeUserMem(void) {
-  for (int i = 0x100000; i < 0x02000000; i += 64) {
-    asm volatile("\tsq $0, 0(%0) \n"
-                 "\tsq $0, 16(%0) \n"
-                 "\tsq $0, 32(%0) \n"
-                 "\tsq $0, 48(%0) \n" ::"r"(i));
+  for (int i = 0x100000; i < 0x02000000; i += 64)
+    wipeBlock(i);
+}
+
+// Clears memory in [start, end) range
+static void wipeRange(uint32_t start, uint32_t end) {
+  if (start >= end)
+    return;
+
+  // Clear unaligned head and tail with memset and the rest with quadword stores
+  uint32_t alignedStart = (start + 15) & ~15;
+  uint32_t alignedEnd = end & ~15;
+  if (alignedStart >= alignedEnd) {
+    memset((void *)start, 0, end - start);
+    return;
+  }
+  memset((void *)start, 0, alignedStart - start);
+  for (uint32_t i = alignedStart; i < alignedEnd; i += 16)
+    wipeQuad(i);
+  memset((void *)alignedEnd, 0, end - alignedEnd);
+}
+
+//
+// ELF loader that reads segments directly to their target addresses via fileXio
+//
+
+typedef struct {
+  uint8_t ident[16]; // struct definition for ELF object header
+  uint16_t type;
+  uint16_t machine;
+  uint32_t version;
+  uint32_t entry;
+  uint32_t phoff;
+  uint32_t shoff;
+  uint32_t flags;
+  uint16_t ehsize;
+  uint16_t phentsize;
+  uint16_t phnum;
+  uint16_t shentsize;
+  uint16_t shnum;
+  uint16_t shstrndx;
+} elf_header_t;
+
+typedef struct {
+  uint32_t type; // struct definition for ELF program section header
+  uint32_t offset;
+  uint32_t vaddr;
+  uint32_t paddr;
+  uint32_t filesz;
+  uint32_t memsz;
+  uint32_t flags;
+  uint32_t align;
+} elf_pheader_t;
+
+#define ELF_MAGIC 0x464c457f
+#define ELF_PT_LOAD 1
+#define ELF_MAX_PHDRS 16
+#define USER_MEM_START 0x00100000
+#define USER_MEM_END 0x02000000
+
+static elf_header_t ehdr;
+static elf_pheader_t phdrs[ELF_MAX_PHDRS];
+
+// Memory ranges that contain leftover data and must be cleared.
+// Set to the whole user memory unless the launcher passes the ranges it has used
+typedef struct {
+  uint32_t start;
+  uint32_t end;
+} memRange;
+static memRange dirtyRanges[2];
+
+// Clears [start, end) range, skipping file-backed parts of the loaded segments.
+// Expects segments to be sorted by address
+static void wipeGaps(uint32_t start, uint32_t end) {
+  for (int i = 0; (i < ehdr.phnum) && (start < end); i++) {
+    if ((phdrs[i].type != ELF_PT_LOAD) || (phdrs[i].vaddr + phdrs[i].filesz <= start))
+      continue;
+    if (phdrs[i].vaddr >= end)
+      break;
+
+    wipeRange(start, phdrs[i].vaddr);
+    start = phdrs[i].vaddr + phdrs[i].filesz;
+  }
+  wipeRange(start, end);
+}
+
+// Loads ELF segments directly to their target addresses and clears leftover data in dirtyRanges.
+// Returns non-zero if the ELF can't be loaded this way and must be loaded with SifLoadElf.
+// User memory might be partially overwritten on failure.
+static int loadELF(const char *path, t_ExecData *data) {
+  int fd, i, j, res;
+
+  if ((fd = fileXioOpen(path, O_RDONLY)) < 0)
+    return fd;
+
+  // Read and validate the ELF header and program headers
+  res = -ENOEXEC;
+  if ((fileXioRead(fd, &ehdr, sizeof(ehdr)) != sizeof(ehdr)) || (_lw((uint32_t)&ehdr.ident) != ELF_MAGIC) ||
+      (ehdr.phentsize != sizeof(elf_pheader_t)) || (ehdr.phnum > ELF_MAX_PHDRS))
+    goto fail;
+
+  if ((fileXioLseek(fd, ehdr.phoff, SEEK_SET) != ehdr.phoff) ||
+      (fileXioRead(fd, phdrs, ehdr.phnum * sizeof(elf_pheader_t)) != ehdr.phnum * sizeof(elf_pheader_t)))
+    goto fail;
+
+  // Make sure all segments are within user memory, the loader itself lives below USER_MEM_START
+  for (i = 0; i < ehdr.phnum; i++) {
+    if (phdrs[i].type != ELF_PT_LOAD)
+      continue;
+    if ((phdrs[i].vaddr < USER_MEM_START) || (phdrs[i].vaddr + phdrs[i].memsz > USER_MEM_END) || (phdrs[i].filesz > phdrs[i].memsz))
+      goto fail;
+  }
+
+  // Writeback data cache before DMA transfers
+  FlushCache(0);
+
+  // Read segments straight to their target addresses and clear the .bss tails
+  for (i = 0; i < ehdr.phnum; i++) {
+    if (phdrs[i].type != ELF_PT_LOAD)
+      continue;
+
+    if (phdrs[i].filesz) {
+      if ((fileXioLseek(fd, phdrs[i].offset, SEEK_SET) != phdrs[i].offset) ||
+          (fileXioRead(fd, (void *)phdrs[i].vaddr, phdrs[i].filesz) != phdrs[i].filesz)) {
+        res = -EIO;
+        goto fail;
+      }
+    }
+    wipeRange(phdrs[i].vaddr + phdrs[i].filesz, phdrs[i].vaddr + phdrs[i].memsz);
+  }
+  fileXioClose(fd);
+
+  // Sort segments by address and clear leftover data not covered by them
+  for (i = 1; i < ehdr.phnum; i++) {
+    elf_pheader_t tmp = phdrs[i];
+    for (j = i; (j > 0) && (phdrs[j - 1].vaddr > tmp.vaddr); j--)
+      phdrs[j] = phdrs[j - 1];
+    phdrs[j] = tmp;
   }
+  for (i = 0; i < sizeof(dirtyRanges) / sizeof(memRange); i++)
+    wipeGaps(dirtyRanges[i].start, dirtyRanges[i].end);
+
+  data->epc = ehdr.entry;
+  data->gp = 0;
+  return 0;
+
+fail:
+  fileXioClose(fd);
+  return res;
 }
 
 int main(int argc, char *argv[]) {
@@ -51,6 +220,23 @@ int main(int argc, char *argv[]) {
   int ret;
 
   elfdata.epc = 0;
+  dirtyRanges[0] = (memRange){USER_MEM_START, USER_MEM_END};
+  dirtyRanges[1] = (memRange){0, 0};
+
+  // Optional arg[0] contains memory ranges used by the launcher in -wipe=<heap end>:<stack start> format.
+  // The launcher doesn't pass it when launcher_full_wipe or LOADER_FULL_WIPE is enabled
+  if ((argc > 1) && !strncmp(argv[0], "-wipe=", 6)) {
+    char *end;
+    uint32_t heapEnd = strtoul(&argv[0][6], &end, 16);
+    uint32_t stackStart = (*end == ':') ? strtoul(end + 1, NULL, 16) : 0;
+    if ((heapEnd > USER_MEM_START) && (heapEnd <= USER_MEM_END) && (stackStart >= heapEnd) && (stackStart <= USER_MEM_END)) {
+      dirtyRanges[0].end = heapEnd;
+      dirtyRanges[1].start = stackStart;
+      dirtyRanges[1].end = USER_MEM_END;
+    }
+    argc--;
+    argv = &argv[1];
+  }
 
   // arg[0] is path to ELF
   if (argc < 1) {
@@ -59,7 +245,6 @@ int main(int argc, char *argv[]) {
 
   // Initialize
   SifInitRpc(0);
-  wipeUserMem();
 
   char *elfPath = NULL;
   if (!strncmp(argv[0], "hdd", 3)) {
@@ -74,11 +259,23 @@ int main(int argc, char *argv[]) {
   } else
     elfPath = argv[0];
 
-  // Writeback data cache before loading ELF.
-  FlushCache(0);
-  SifLoadFileInit();
-  ret = SifLoadElf(elfPath, &elfdata);
-  SifLoadFileExit();
+  // Try to load the ELF directly, falling back to SifLoadElf
+  // PFS paths are handled by LOADFILE, so always use SifLoadElf for them
+  ret = -ENODEV;
+  if (elfPath == argv[0]) {
+    fileXioInit();
+    ret = loadELF(elfPath, &elfdata);
+    fileXioExit();
+  }
+
+  if (ret) {
+    wipeUserMem();
+    // Writeback data cache before loading ELF.
+    FlushCache(0);
+    SifLoadFileInit();
+    ret = SifLoadElf(elfPath, &elfdata);
+    SifLoadFileExit();
+  }
   if (ret == 0 && elfdata.epc != 0) {
     FlushCache(0);
     FlushCache(2);
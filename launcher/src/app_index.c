@@ -0,0 +1,110 @@
+#include "app_index.h"
+#include "apps.h"
+#include "common.h"
+#include "defaults.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The 'X' in "mcX" will be replaced with the memory card number in updateAppIndex
+static char appIndexPath[] = APP_INDEX_PATH;
+
+static int readAppIndex(appIndexEntry *entries);
+static int writeAppIndex(appIndexEntry *entries, int count);
+
+// Adds the directory containing cfgPath to the app index on the same memory card if cfgPath points to title.cfg.
+// If isApp is 0, removes the directory from the index instead since title.cfg no longer exists.
+// Returns 1 if the index has been updated, 0 if the directory is already up to date or a negative number on error.
+// Expects memory card modules to be loaded
+int updateAppIndex(const char *cfgPath, int isApp) {
+  // Only handle mc?:/<directory>/title.cfg
+  const char *dirName = &cfgPath[5];
+  const char *fileName = strrchr(cfgPath, '/');
+  if (strncmp(cfgPath, "mc", 2) || (cfgPath[2] != '0' && cfgPath[2] != '1') || strncmp(&cfgPath[3], ":/", 2) || !fileName ||
+      strcmp(fileName, "/title.cfg") || (fileName != strchr(dirName, '/')) || (fileName == dirName) || (fileName - dirName >= APP_INDEX_NAME_LEN))
+    return 0;
+
+  appIndexPath[2] = cfgPath[2];
+
+  appIndexEntry *entries = calloc(APP_INDEX_MAX_ENTRIES, sizeof(appIndexEntry));
+  if (!entries)
+    return -ENOMEM;
+
+  // Start a new index if the file is missing or invalid
+  int count = readAppIndex(entries);
+  if (count < 0)
+    count = 0;
+
+  int idx;
+  for (idx = 0; idx < count; idx++) {
+    if (!strncmp(entries[idx].dirName, dirName, fileName - dirName) && (entries[idx].dirName[fileName - dirName] == '\0'))
+      break;
+  }
+
+  // Rewrite the index only if it has changed
+  int res = 0;
+  if (isApp && (idx == count)) {
+    if (count == APP_INDEX_MAX_ENTRIES) {
+      // Drop the oldest entry to make room
+      count--;
+      memmove(entries, &entries[1], count * sizeof(appIndexEntry));
+    }
+    memset(&entries[count], 0, sizeof(appIndexEntry));
+    memcpy(entries[count++].dirName, dirName, fileName - dirName);
+    res = 1;
+  } else if (!isApp && (idx < count)) {
+    memmove(&entries[idx], &entries[idx + 1], (count - idx - 1) * sizeof(appIndexEntry));
+    count--;
+    res = 1;
+  }
+
+  if (res) {
+    DPRINTF("Writing %d apps to %s\n", count, appIndexPath);
+    int err = writeAppIndex(entries, count);
+    if (err)
+      res = err;
+  }
+
+  free(entries);
+  return res;
+}
+
+// Reads the app index into entries. Returns the number of entries or a negative number if the index is invalid
+static int readAppIndex(appIndexEntry *entries) {
+  appIndexHeader header;
+  int fd, res;
+
+  if ((fd = open(appIndexPath, O_RDONLY)) < 0)
+    return fd;
+
+  res = -EINVAL;
+  if ((read(fd, &header, sizeof(header)) == sizeof(header)) && (header.magic == APP_INDEX_MAGIC) && (header.count <= APP_INDEX_MAX_ENTRIES)) {
+    if (read(fd, entries, header.count * sizeof(appIndexEntry)) == header.count * sizeof(appIndexEntry))
+      res = header.count;
+  }
+  close(fd);
+  return res;
+}
+
+// Writes entries to the app index
+static int writeAppIndex(appIndexEntry *entries, int count) {
+  appIndexHeader header = {
+      .magic = APP_INDEX_MAGIC,
+      .count = count,
+  };
+  int fd, res;
+
+  if ((fd = open(appIndexPath, O_WRONLY | O_CREAT | O_TRUNC)) < 0) {
+    DPRINTF("ERROR: Failed to open %s: %d\n", appIndexPath, fd);
+    return fd;
+  }
+
+  res = -EIO;
+  if ((write(fd, &header, sizeof(header)) == sizeof(header)) && (write(fd, entries, count * sizeof(appIndexEntry)) == count * sizeof(appIndexEntry)))
+    res = 0;
+  close(fd);
+  return res;
+}
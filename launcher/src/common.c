@@ -1,5 +1,7 @@
 #include "handlers.h"
 #include "init.h"
+#include "defaults.h"
+#include "trace.h"
 #include <debug.h>
 #include <fcntl.h>
 #include <kernel.h>
@@ -114,6 +116,71 @@ int launchPath(int argc, char *argv[]) {
   return ret;
 }
 
+// Returns the set of devices that conflict with the device when loaded at the same time.
+// MMCE and memory cards don't conflict: mmceman only handles MMCE commands on the SIO2 ports
+// and is meant to run alongside mcman and mcserv, which keep serving mc?: on the same ports
+static DeviceType getConflictingDevices(DeviceType device) {
+  if (device & Device_BDM)
+    // All BDM devices share mass?: mountpoints, so only one BDM device type can be probed at a time.
+    // exFAT and APA HDD drivers can't be loaded together.
+    return (Device_BDM & ~device) | ((device & Device_ATA) ? Device_PFS : 0);
+  if (device & Device_PFS)
+    return Device_ATA;
+  return Device_None;
+}
+
+// Returns the largest set of compatible devices for paths, prioritizing the first paths.
+// Devices in excluded are skipped
+static DeviceType getDeviceSet(linkedStr *paths, DeviceType excluded) {
+  DeviceType deviceSet = Device_None;
+  DeviceType device;
+
+  for (; paths; paths = paths->next) {
+    device = guessDeviceType(paths->str);
+    if (device == Device_None || ((deviceSet | excluded) & device))
+      continue;
+
+    if (!(getConflictingDevices(device) & deviceSet))
+      deviceSet |= device;
+  }
+  return deviceSet;
+}
+
+// Attempts to launch ELF from every path in paths, in order.
+// Loads drivers for all compatible devices at once to avoid resetting IOP between attempts.
+// argv[0] is set to the path being tried
+int launchPaths(int argc, char *argv[], linkedStr *paths) {
+  DeviceType failed = Device_None;
+  DeviceType deviceSet;
+  linkedStr *tlstr;
+
+  // Load drivers for all devices at once.
+  // Handlers for devices in this set will not reset the IOP.
+  while ((deviceSet = getDeviceSet(paths, failed)) != Device_None) {
+    DPRINTF("Loading drivers for device set %x\n", deviceSet);
+    if (!initModules(deviceSet))
+      break;
+
+    // Drop the devices whose drivers failed to load (e.g. UDPBD without IPCONFIG.DAT) and retry with the rest.
+    // If a basic module has failed, leave driver loading to the handlers
+    if (!(getFailedDevices() & deviceSet))
+      break;
+    failed |= getFailedDevices() & deviceSet;
+  }
+
+  for (tlstr = paths; tlstr; tlstr = tlstr->next) {
+    // Skip paths on devices that failed to initialize
+    if (guessDeviceType(tlstr->str) & failed)
+      continue;
+
+    argv[0] = tlstr->str;
+    // If target path is valid, it'll never return from launchPath
+    DPRINTF("Trying to launch %s\n", argv[0]);
+    launchPath(argc, argv);
+  }
+  return -ENODEV;
+}
+
 // Adds a new string to linkedStr and returns
 linkedStr *addStr(linkedStr *lstr, char *str) {
   linkedStr *newLstr = malloc(sizeof(linkedStr));
@@ -222,3 +289,27 @@ char *normalizePath(char *path, DeviceType type) {
   }
   return pathbuffer;
 }
+
+#ifdef ENABLE_TRACE
+// Appends recorded trace events to the trace file on the memory card
+void flushTrace(void) {
+  char tracePath[] = TRACE_PATH;
+  int fd, size;
+  void *block = traceDump(1, &size);
+  if (size == sizeof(traceBlockHeader))
+    return; // Nothing to write
+
+  // Look for the trace file created by the patcher
+  for (char i = '0'; i < '2'; i++) {
+    tracePath[2] = i;
+    if ((fd = open(tracePath, O_WRONLY | O_APPEND)) < 0)
+      continue;
+
+    lseek(fd, 0, SEEK_END);
+    write(fd, block, size);
+    close(fd);
+    return;
+  }
+  DPRINTF("Failed to write the trace file\n");
+}
+#endif
@@ -1,16 +1,27 @@
-// GS functions
-// Based on code by Tony Saveski, t_saveski@yahoo.com
+// Visual game ID
+#include "game_id.h"
 #include "common.h"
-#include <dmaKit.h>
-#include <gsKit.h>
+#include "gs.h"
+#include <fcntl.h>
 #include <stdint.h>
-#include <stdio.h>
-#include <kernel.h>
+#include <string.h>
+#include <unistd.h>
 
 //
 // GameID code based on https://github.com/CosmicScale/Retro-GEM-PS2-Disc-Launcher
 //
 
+// Every bit is encoded as a 2x2 pixel cell: magenta separator followed by cyan (1) or yellow (0) pixel
+#define GAMEID_STRIP_WIDTH (GAMEID_MAX_DATA * 16)
+
+#define GAMEID_COLOR_SEPARATOR 0x00FF00FF // Magenta
+#define GAMEID_COLOR_ONE 0x00FFFF00       // Cyan
+#define GAMEID_COLOR_ZERO 0x0000FFFF      // Yellow
+
+// The strip is uploaded in a single DMA transfer: GIFtag + 4 A+D qwords + IMAGE GIFtag + pixel data
+#define GAMEID_PACKET_ITEMS (6 + (GAMEID_STRIP_WIDTH * GAMEID_STRIP_HEIGHT / 4))
+DECLARE_GS_PACKET(gameIDBuf, GAMEID_PACKET_ITEMS);
+
 static uint8_t calculateCRC(const uint8_t *data, int len) {
   uint8_t crc = 0x00;
   for (int i = 0; i < len; i++) {
@@ -19,31 +30,14 @@ static uint8_t calculateCRC(const uint8_t *data, int len) {
   return 0x100 - crc;
 }
 
-// Initializes GS and displays visual game ID
-void gsDisplayGameID(const char *gameID) {
-  GSGLOBAL *gsGlobal = gsKit_init_global();
-  gsGlobal->DoubleBuffering = GS_SETTING_ON;
-
-  dmaKit_init(D_CTRL_RELE_OFF, D_CTRL_MFD_OFF, D_CTRL_STS_UNSPEC, D_CTRL_STD_OFF, D_CTRL_RCYC_8, 1 << DMA_CHANNEL_GIF);
-
-  // Initialize the DMAC
-  int res;
-  if ((res = dmaKit_chan_init(DMA_CHANNEL_GIF)))
-    return;
-
-  // Init screen
-  gsKit_init_screen(gsGlobal);
-  gsKit_display_buffer(gsGlobal); // Switch display buffer to avoid garbage appearing on screen
-  gsKit_mode_switch(gsGlobal, GS_ONESHOT);
-  gsKit_clear(gsGlobal, GS_SETREG_RGBA(0x00, 0x00, 0x00, 0x00));
-
-  uint8_t data[64] = {0};
+// Encodes the game ID into data. Returns the data length
+int encodeGameID(const char *gameID, uint8_t *data) {
   int gidlen = strnlen(gameID, 11); // Ensure the length does not exceed 11 characters
 
   int dpos = 0;
   data[dpos++] = 0xA5; // detect word
   data[dpos++] = 0x00; // address offset
-  dpos++;
+  data[dpos++] = 0x00; // CRC
   data[dpos++] = gidlen;
 
   memcpy(&data[dpos], gameID, gidlen);
@@ -53,26 +47,72 @@ void gsDisplayGameID(const char *gameID) {
   data[dpos++] = 0xD5; // end word
   data[dpos++] = 0x00; // padding
 
-  int data_len = dpos;
-  data[2] = calculateCRC(&data[3], data_len - 3);
-
-  int xstart = (gsGlobal->Width / 2) - (data_len * 8);
-  int ystart = gsGlobal->Height - (((gsGlobal->Height / 8) * 2) + 20);
-  int height = 2;
+  data[2] = calculateCRC(&data[3], dpos - 3);
+  return dpos;
+}
 
-  for (int i = 0; i < data_len; i++) {
+// Renders encoded data into PSMCT32 pixels
+void buildStrip(const uint8_t *data, int dataLen, uint32_t *pixels) {
+  int width = dataLen * 16;
+  uint32_t *px = pixels;
+  for (int i = 0; i < dataLen; i++) {
     for (int j = 7; j >= 0; j--) {
-      int x = xstart + (i * 16 + ((7 - j) * 2));
-      int x1 = x + 1;
-      gsKit_prim_sprite(gsGlobal, x, ystart, x1, ystart + height, 0, GS_SETREG_RGBA(0xFF, 0x00, 0xFF, 0x00));
-
-      uint32_t color = (data[i] >> j) & 1 ? GS_SETREG_RGBA(0x00, 0xFF, 0xFF, 0x00) : GS_SETREG_RGBA(0xFF, 0xFF, 0x00, 0x00);
-      gsKit_prim_sprite(gsGlobal, x1, ystart, x1 + 1, ystart + height, 0, color);
+      *px++ = GAMEID_COLOR_SEPARATOR;
+      *px++ = (data[i] >> j) & 1 ? GAMEID_COLOR_ONE : GAMEID_COLOR_ZERO;
     }
   }
+  // Duplicate the first row
+  for (int y = 1; y < GAMEID_STRIP_HEIGHT; y++) {
+    memcpy(&pixels[y * width], pixels, width * sizeof(uint32_t));
+  }
+}
+
+// Returns the video mode matching the console region
+static GSVideoMode getVideoMode() {
+  char romver[5] = {0};
+  int fd = open("rom0:ROMVER", O_RDONLY);
+  if (fd >= 0) {
+    read(fd, romver, sizeof(romver));
+    close(fd);
+  }
+  return (romver[4] == 'E') ? GS_MODE_PAL : GS_MODE_NTSC;
+}
+
+// Initializes GS and displays visual game ID
+// Returns the frame buffer position of the strip for the video mode.
+// The strip is centered horizontally and placed above the bottom of the screen, like the gsKit implementation did
+void getStripPosition(GSVideoMode mode, int dataLen, int *x, int *y) {
+  int height = (mode == GS_MODE_PAL) ? 512 : 448;
+  *x = (640 / 2) - (dataLen * 8);
+  *y = height - (((height / 8) * 2) + 20);
+}
+
+void gsDisplayGameID(const char *gameID) {
+  uint8_t data[GAMEID_MAX_DATA];
+  int dataLen = encodeGameID(gameID, data);
+
+  GSVideoMode mode = getVideoMode();
+  int xstart, ystart;
+  getStripPosition(mode, dataLen, &xstart, &ystart);
+
+  gsInit(mode);
+
+  BEGIN_GS_PACKET(gameIDBuf);
+  GIF_TAG_AD(gameIDBuf, 4, 0, 0, 0, 0);
+  GIF_DATA_AD(gameIDBuf, GS_REG_BITBLTBUF,
+              GS_BITBLTBUF(0, 0, 0,
+                           0,        // frame buffer address
+                           640 / 64, // frame buffer width
+                           GS_PSM_CT32));
+  GIF_DATA_AD(gameIDBuf, GS_REG_TRXPOS, GS_TRXPOS(0, 0, xstart, ystart, 0)); // left to right/top to bottom
+  GIF_DATA_AD(gameIDBuf, GS_REG_TRXREG, GS_TRXREG(dataLen * 16, GAMEID_STRIP_HEIGHT));
+  GIF_DATA_AD(gameIDBuf, GS_REG_TRXDIR, GS_TRXDIR(XDIR_EE_GS));
+
+  // Build the strip right after the IMAGE GIFtag
+  int qwc = (dataLen * 16 * GAMEID_STRIP_HEIGHT) / 4;
+  GIF_TAG_IMG(gameIDBuf, qwc);
+  buildStrip(data, dataLen, (uint32_t *)&gameIDBuf[gameIDBuf_cur]);
+  gameIDBuf_dma_size = (gameIDBuf_cur / 2) + qwc;
 
-  // Execute the queue
-  gsKit_queue_exec(gsGlobal);
-  gsKit_finish();
-  gsKit_sync_flip(gsGlobal);
+  SEND_GS_PACKET(gameIDBuf);
 }
@@ -1,14 +1,30 @@
+#include "clock.h"
 #include "common.h"
 #include "init.h"
 #include "loader.h"
+#include "trace.h"
 #include <fcntl.h>
 #include <ps2sdkapi.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 char bdmMountpoint[] = BDM_MOUNTPOINT;
 #define BDM_MAX_DEVICES 10
 
+// Total time to wait for BDM devices, in milliseconds
+#ifndef BDM_TIMEOUT
+#define BDM_TIMEOUT 20000
+#endif
+#define BDM_TIMEOUT_TICKS ((uint64_t)BDM_TIMEOUT * CLOCK_TICKS_PER_MS)
+// Time to wait for another device after the last new device has come up, in milliseconds
+#ifndef BDM_SETTLE_TIME
+#define BDM_SETTLE_TIME 5000
+#endif
+#define BDM_SETTLE_TICKS ((uint64_t)BDM_SETTLE_TIME * CLOCK_TICKS_PER_MS)
+#define BDM_MIN_DELAY 10  // Initial polling delay
+#define BDM_MAX_DELAY 500 // Max polling delay
+
 // Launches ELF from BDM device
 int handleBDM(DeviceType device, int argc, char *argv[]) {
   if ((argv[0] == 0) || (strlen(argv[0]) < 5))
@@ -24,34 +40,60 @@ int handleBDM(DeviceType device, int argc, char *argv[]) {
   if (res)
     return res;
 
-  // Try all BDM devices while decreasing the number of wait
-  // attempts for each consecutive device to reduce init times
-  int delayAttempts = 20; // Max number of attempts
-  for (int i = 0; i < BDM_MAX_DEVICES; i++) {
-    // Build mountpoint path
-    bdmMountpoint[4] = i + '0';
-    elfPath[4] = i + '0';
-    while (delayAttempts != 0) {
+  // Poll all mountpoints with exponential backoff until the file is found or the deadline is reached.
+  // Devices that don't have the file keep the search going for BDM_SETTLE_TIME since the right one may still be coming up.
+  // Without any devices, polling continues until BDM_TIMEOUT to give slow devices time to spin up.
+  // Elapsed time is measured with the Count register so it includes the time spent opening files
+  uint16_t checkedDevices = 0; // Devices that have already been checked for the file
+  int deviceCount = 0;
+  int delay = BDM_MIN_DELAY;
+  uint64_t elapsed = 0; // In EE cycles
+  uint64_t deadline = BDM_TIMEOUT_TICKS;
+  uint32_t lastCount = readCount();
+  uint32_t count, remaining;
+  int newDevices;
+  TRACE_BEGIN(TRACE_BDM_WAIT, 0);
+  while (1) {
+    newDevices = 0;
+    for (int i = 0; i < BDM_MAX_DEVICES; i++) {
       // Try to open the mountpoint to make sure the device exists
+      bdmMountpoint[4] = i + '0';
       res = open(bdmMountpoint, O_DIRECTORY | O_RDONLY);
-      if (res >= 0) {
-        // If mountpoint is available
-        close(res);
-
-        // Jump to launch if file exists
-        if (!(res = tryFile(elfPath)))
-          goto found;
-        // Else, try next device
-        break;
+      if (res < 0)
+        break; // Mountpoints are assigned sequentially
+      close(res);
+
+      if (checkedDevices & (1 << i))
+        continue;
+      checkedDevices |= (1 << i);
+      deviceCount++;
+      newDevices = 1;
+
+      // Jump to launch if file exists
+      elfPath[4] = i + '0';
+      if (!tryFile(elfPath)) {
+        TRACE_END(TRACE_BDM_WAIT, deviceCount);
+        goto found;
       }
-      // If the mountpoitnt is unavailable, delay and decrement the number of wait attempts
-      sleep(1);
-      delayAttempts--;
     }
-    // No more mountpoints available
-    if (res < 0)
+
+    count = readCount();
+    elapsed += count - lastCount; // Wraps around correctly as long as a single pass takes less than ~14.5 s
+    lastCount = count;
+    // Wait for the next device until the device set is stable for BDM_SETTLE_TIME
+    if (newDevices)
+      deadline = (elapsed + BDM_SETTLE_TICKS < BDM_TIMEOUT_TICKS) ? elapsed + BDM_SETTLE_TICKS : BDM_TIMEOUT_TICKS;
+    if (elapsed >= deadline)
       break;
+
+    // Don't sleep past the deadline
+    remaining = (deadline - elapsed) / CLOCK_TICKS_PER_MS + 1;
+    usleep(((delay < remaining) ? delay : remaining) * 1000);
+    delay <<= 1;
+    if (delay > BDM_MAX_DELAY)
+      delay = BDM_MAX_DELAY;
   }
+  TRACE_END(TRACE_BDM_WAIT, deviceCount);
   return -ENODEV;
 
 found:
@@ -5,6 +5,7 @@
 #include "history.h"
 #include "init.h"
 #include "loader.h"
+#include "trace.h"
 #include <ctype.h>
 #include <fcntl.h>
 #include <kernel.h>
@@ -72,7 +73,9 @@ int startCDROM(int displayGameID, int skipPS2LOGO, char *dkwdrvPath) {
       return -ENOENT;
     }
 
-    // Find DKWDRV path
+    // Find DKWDRV path, starting from the path resolved by the patcher
+    if ((dkwdrvPath[2] != '?') && !tryFile(dkwdrvPath))
+      goto dkwdrvFound;
     for (int i = '0'; i < '2'; i++) {
       dkwdrvPath[2] = i;
       if (!tryFile(dkwdrvPath))
@@ -96,6 +99,7 @@ int startCDROM(int displayGameID, int skipPS2LOGO, char *dkwdrvPath) {
     DPRINTF("CDROM: Skipping PS2LOGO\n");
 
   // Wait until the drive is ready
+  TRACE_BEGIN(TRACE_DISC_READY, 0);
   sceCdDiskReady(0);
   int discType = sceCdGetDiskType();
 
@@ -106,6 +110,7 @@ int startCDROM(int displayGameID, int skipPS2LOGO, char *dkwdrvPath) {
       discType = sceCdGetDiskType();
     }
   }
+  TRACE_END(TRACE_DISC_READY, discType);
 
   // Make sure the disc is a valid PS1/PS2 disc
   discType = sceCdGetDiskType();
@@ -141,6 +146,10 @@ int startCDROM(int displayGameID, int skipPS2LOGO, char *dkwdrvPath) {
 
   sceCdInit(SCECdEXIT);
 
+#ifdef ENABLE_TRACE
+  flushTrace();
+#endif
+
   switch (discType) {
   case DiscType_PS1:
     if (dkwdrvPath) {
@@ -1,6 +1,8 @@
 #include "common.h"
 #include "defaults.h"
 #include "handlers.h"
+#include "handoff.h"
+#include "launch_stats.h"
 #include <ctype.h>
 #include <init.h>
 #include <kernel.h>
@@ -13,22 +15,54 @@
 // Defined in common/defaults.h
 char cnfPath[] = CONF_PATH;
 
+// Loads item paths, arguments and CDROM options from the handoff block written by the patcher.
+// Returns 0 on success or -1 if the block is invalid or belongs to another item
+static int loadHandoff(int targetIdx, linkedStr **targetPaths, linkedStr **targetArgs, int *targetArgc, int *displayGameID, int *skipPS2LOGO,
+                       int *useDKWDRV, char **dkwdrvPath) {
+  handoffHeader *handoff = (handoffHeader *)HANDOFF_ADDRESS;
+  int res = -1;
+  if (handoffValidate(handoff, HANDOFF_MAX_SIZE) || (handoff->itemIdx != targetIdx) || (handoff->mcSlot > 1))
+    goto out;
+
+  // Copy all strings out of the block since the memory will be wiped before launching the ELF
+  char *str = NULL;
+  while ((str = handoffNextString(handoff, HANDOFF_PATH, str)))
+    *targetPaths = addStr(*targetPaths, str);
+  while ((str = handoffNextString(handoff, HANDOFF_ARG, str))) {
+    *targetArgs = addStr(*targetArgs, str);
+    (*targetArgc)++;
+  }
+  if ((str = handoffNextString(handoff, HANDOFF_DKWDRV, NULL)))
+    *dkwdrvPath = strdup(str);
+
+  *displayGameID = !(handoff->flags & HANDOFF_FLAG_DISABLE_GAMEID);
+  *skipPS2LOGO = (handoff->flags & HANDOFF_FLAG_SKIP_PS2_LOGO) ? 1 : 0;
+  *useDKWDRV = (handoff->flags & HANDOFF_FLAG_USE_DKWDRV) ? 1 : 0;
+
+  // Use the memory card containing the config file for launch statistics
+  cnfPath[2] = '0' + handoff->mcSlot;
+  res = 0;
+  DPRINTF("FMCB: Using the handoff block for entry %d\n", targetIdx);
+
+out:
+  // Make sure the block is consumed only once
+  if (handoff->magic == HANDOFF_MAGIC)
+    handoff->magic = 0;
+  return res;
+}
+
 // Loads ELF specified in OSDMENU.CNF on the memory card
 int handleFMCB(int argc, char *argv[]) {
   int res = initModules(Device_MemoryCard);
   if (res)
     return res;
 
-  if (cnfPath[2] == '?')
-    cnfPath[2] = '0';
-
   // Get memory card slot from argv[0] (fmcb0/1)
-  if (!strncmp("mc0", cnfPath, 3) && (argv[0][4] == '1')) {
-    // If path is fmcb1:, try to get config from mc1 first
-    cnfPath[2] = '1';
-    if (tryFile(cnfPath)) // If file is not found, revert to mc0
-      cnfPath[2] = '0';
-  }
+  // The patcher passes the memory card containing the config file, so there's no need to probe it
+  if (!strncmp("mc", cnfPath, 2) && ((argv[0][4] == '0') || (argv[0][4] == '1')))
+    cnfPath[2] = argv[0][4];
+  else if (cnfPath[2] == '?')
+    cnfPath[2] = '0';
 
   char *idx = strchr(argv[0], ':');
   if (!idx) {
@@ -37,11 +71,13 @@ int handleFMCB(int argc, char *argv[]) {
   }
   int targetIdx = atoi(++idx);
 
-  // Open the config file
-  FILE *file = fopen(cnfPath, "r");
-  if (!file) {
-    msg("FMCB: Failed to open %s\n", cnfPath);
-    return -ENOENT;
+  // Parse paths resolved by the patcher
+  char *resolvedDKWDRVPath = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-dkwdrv=", 8))
+      resolvedDKWDRVPath = &argv[i][8];
+    else if (!strncmp(argv[i], "-ipconfig=", 10))
+      setIPConfigPath(&argv[i][10]);
   }
 
   // CDROM arguments
@@ -55,6 +91,17 @@ int handleFMCB(int argc, char *argv[]) {
   linkedStr *targetArgs = NULL;
   int targetArgc = 1; // argv[0] is the ELF path
 
+  // Skip parsing the config file if the patcher has passed the item in the handoff block
+  if (!loadHandoff(targetIdx, &targetPaths, &targetArgs, &targetArgc, &displayGameID, &skipPS2LOGO, &useDKWDRV, &dkwdrvPath))
+    goto parsed;
+
+  // Open the config file
+  FILE *file = fopen(cnfPath, "r");
+  if (!file) {
+    msg("FMCB: Failed to open %s\n", cnfPath);
+    return -ENOENT;
+  }
+
   char lineBuffer[PATH_MAX] = {0};
   char *valuePtr = NULL;
   char *idxPtr = NULL;
@@ -113,13 +160,17 @@ int handleFMCB(int argc, char *argv[]) {
       useDKWDRV = 1;
       continue;
     }
-    if (!strncmp(lineBuffer, "path_DKWDRV_ELF", 15)) {
+    if (!strncmp(lineBuffer, "path_DKWDRV_ELF", 15) && !resolvedDKWDRVPath) {
       dkwdrvPath = strdup(valuePtr);
       continue;
     }
   }
   fclose(file);
 
+  if (resolvedDKWDRVPath)
+    dkwdrvPath = strdup(resolvedDKWDRVPath);
+
+parsed:
   if (!targetPaths) {
     msg("FMCB: No paths found for entry %d\n", targetIdx);
     freeLinkedStr(targetPaths);
@@ -147,6 +198,9 @@ int handleFMCB(int argc, char *argv[]) {
     shutdownPS2();
   }
 
+  // Record the launch for the menu ordering
+  updateLaunchStats(cnfPath, targetIdx);
+
   // Handle 'cdrom' entry
   if (!strcmp(targetPaths->str, "cdrom")) {
     freeLinkedStr(targetPaths);
@@ -176,18 +230,8 @@ int handleFMCB(int argc, char *argv[]) {
   }
 
   // Try every path
-  tlstr = targetPaths;
-  while (tlstr) {
-    targetArgv[0] = tlstr->str;
-    // If target path is valid, it'll never return from launchPath
-    DPRINTF("Trying to launch %s\n", targetArgv[0]);
-    launchPath(targetArgc, targetArgv);
-    free(tlstr->str);
-    tlstr = tlstr->next;
-    free(targetPaths);
-    targetPaths = tlstr;
-  }
-  free(targetPaths);
+  launchPaths(targetArgc, targetArgv, targetPaths);
+  freeLinkedStr(targetPaths);
 
   msg("FMCB: All paths have been tried\n");
   return -ENODEV;
@@ -1,3 +1,4 @@
+#include "app_index.h"
 #include "common.h"
 #include <ctype.h>
 #include <init.h>
@@ -35,10 +36,21 @@ int handleQuickboot(char *cnfPath) {
 
   FILE *file = fopen(cnfPath, "r");
   if (!file) {
+#ifdef FMCB
+    // The patched browser launched a directory that is no longer an app.
+    // Drop the stale index entry and go back to OSDSYS so the browser lists the directory
+    if (updateAppIndex(cnfPath, 0) > 0)
+      rebootPS2();
+#endif
     msg("Quickboot: Failed to open %s\n", cnfPath);
     return -ENODEV;
   }
 
+#ifdef FMCB
+  // Keep the memory card browser app index up to date
+  updateAppIndex(cnfPath, 1);
+#endif
+
   // Temporary path and argument lists
   linkedStr *targetPaths = NULL;
   linkedStr *targetArgs = NULL;
@@ -104,17 +116,8 @@ int handleQuickboot(char *cnfPath) {
   }
 
   // Try every path
-  tlstr = targetPaths;
-  while (tlstr) {
-    targetArgv[0] = tlstr->str;
-    // If target path is valid, it'll never return from launchPath
-    launchPath(targetArgc, targetArgv);
-    free(tlstr->str);
-    tlstr = tlstr->next;
-    free(targetPaths);
-    targetPaths = tlstr;
-  }
-  free(targetPaths);
+  launchPaths(targetArgc, targetArgv, targetPaths);
+  freeLinkedStr(targetPaths);
 
   msg("Quickboot: all paths have been tried\n");
   return -ENODEV;
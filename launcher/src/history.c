@@ -31,7 +31,7 @@ struct historyListEntry {
 #define ICON_SYS_SIZE 1776
 
 static inline int initSystemDataDir(void);
-void processHistoryList(const char *titleID, struct historyListEntry *historyList);
+int processHistoryList(const char *titleID, struct historyListEntry *historyList);
 int evictEntry(const struct historyListEntry *evictedhistoryEntry);
 static uint16_t getTimestamp(void);
 
@@ -105,7 +105,7 @@ int updateHistoryFile(const char *titleID) {
   }
 
   // Try opening history file on mc0 and mc1
-  int histfileFd, count, mcType, format;
+  int histfileFd, count, mcType, format, slot, isValid;
   struct historyListEntry historyList[MAX_HISTORY_ENTRIES];
 
   for (char i = 0; i < 2; i++) {
@@ -119,6 +119,7 @@ int updateHistoryFile(const char *titleID) {
 
     historyFilePath[2] = i + '0'; // Skipping int-char conversions thanks to ASCII code ordering
     // Attempt to open history file
+    isValid = 0;
     histfileFd = open(historyFilePath, O_RDONLY);
     if (histfileFd < 0) {
       // File doesn't exist
@@ -135,12 +136,32 @@ int updateHistoryFile(const char *titleID) {
       if (count != (HISTORY_FILE_SIZE)) {
         DPRINTF("Failed to load the history file, reinitializing\n");
         memset(historyList, 0, HISTORY_FILE_SIZE);
-      }
+      } else
+        isValid = 1;
       close(histfileFd);
     }
 
     // Process history file
-    processHistoryList(titleID, historyList);
+    slot = processHistoryList(titleID, historyList);
+
+    if (isValid) {
+      // Only one entry has changed, so overwrite it in place
+      // instead of rewriting the whole file
+      histfileFd = open(historyFilePath, O_WRONLY);
+      if (histfileFd >= 0) {
+        if (lseek(histfileFd, slot * sizeof(struct historyListEntry), SEEK_SET) == slot * sizeof(struct historyListEntry)) {
+          count = write(histfileFd, &historyList[slot], sizeof(struct historyListEntry));
+          close(histfileFd);
+          if (count == sizeof(struct historyListEntry))
+            continue;
+
+          DPRINTF("ERROR: Failed to write: %d/%d bytes written\n", count, sizeof(struct historyListEntry));
+        } else
+          close(histfileFd);
+      }
+      // Fall back to rewriting the whole file
+      DPRINTF("WARN: Failed to update slot %d in place, rewriting the history file\n", slot);
+    }
 
     // Write history file
     histfileFd = open(historyFilePath, O_WRONLY | O_CREAT | O_TRUNC);
@@ -191,8 +212,9 @@ static inline int initSystemDataDir(void) {
 }
 
 // Processes history record list, updating title entry if it already exists in the list
-// or adding it to the list, evicting the least used title along the way
-void processHistoryList(const char *titleID, struct historyListEntry *historyList) {
+// or adding it to the list, evicting the least used title along the way.
+// Returns the index of the modified slot
+int processHistoryList(const char *titleID, struct historyListEntry *historyList) {
   // Used to find least used record
   int leastUsedRecordIdx = 0;
   int leastUsedRecordTimestamp = INT_MAX;
@@ -254,7 +276,7 @@ void processHistoryList(const char *titleID, struct historyListEntry *historyLis
           historyList[i].shiftAmount = 7;
         }
       }
-      return;
+      return i;
     }
   }
 
@@ -263,7 +285,7 @@ void processHistoryList(const char *titleID, struct historyListEntry *historyLis
   int slot = 0;
   if (blankSlotCount > 0) {
     // Use random unused slot
-    newEntry = &historyList[blankSlots[slot = rand() % blankSlotCount]];
+    newEntry = &historyList[slot = blankSlots[rand() % blankSlotCount]];
   } else {
     // Copy out the victim record and evict it into history.old
     struct historyListEntry evictedhistoryEntry;
@@ -281,6 +303,7 @@ void processHistoryList(const char *titleID, struct historyListEntry *historyLis
   newEntry->bitmask = 1;
   newEntry->shiftAmount = 0;
   newEntry->timestamp = getTimestamp();
+  return slot;
 }
 
 // Appends evicted history entry to history.old file
@@ -1,7 +1,9 @@
 
 #include "init.h"
 #include "common.h"
-#include <ctype.h>
+#include "defaults.h"
+#include "ipconfig.h"
+#include "trace.h"
 #include <fcntl.h>
 #include <iopcontrol.h>
 #include <kernel.h>
@@ -23,6 +25,23 @@
 // Defines moduleList entry for embedded and external modules
 #define INT_MODULE(mod, argFunc, deviceType) {#mod, NULL, mod##_irx, &size_##mod##_irx, 0, NULL, deviceType, argFunc}
 #define EXT_MODULE(mod, path, argFunc, deviceType) {#mod, path, NULL, NULL, 0, NULL, deviceType, argFunc}
+// Defines moduleList entry for embedded and external modules with constant arguments
+#define INT_MODULE_ARGS(mod, args, deviceType) {#mod, NULL, mod##_irx, &size_##mod##_irx, sizeof(args), args, deviceType, NULL}
+#define EXT_MODULE_ARGS(mod, path, args, deviceType) {#mod, path, NULL, NULL, sizeof(args), args, deviceType, NULL}
+
+#ifdef EXTERNAL_DRIVERS
+// Device drivers are loaded from the launcher directory, see initDriverPath.
+// Memory card modules must always be loaded to access them.
+#define DRV_DEFINE(mod)
+#define DRV_MODULE(mod, argFunc, deviceType) EXT_MODULE(mod, NULL, argFunc, deviceType)
+#define DRV_MODULE_ARGS(mod, args, deviceType) EXT_MODULE_ARGS(mod, NULL, args, deviceType)
+#define MC_DEVICES Device_Basic
+#else
+#define DRV_DEFINE(mod) IRX_DEFINE(mod)
+#define DRV_MODULE(mod, argFunc, deviceType) INT_MODULE(mod, argFunc, deviceType)
+#define DRV_MODULE_ARGS(mod, args, deviceType) INT_MODULE_ARGS(mod, args, deviceType)
+#define MC_DEVICES (Device_MemoryCard | Device_UDPBD | Device_CDROM)
+#endif
 
 // Embedded IOP modules
 IRX_DEFINE(iomanX);
@@ -35,44 +54,44 @@ IRX_DEFINE(mcserv);
 
 #ifdef MMCE
 #define SIO2MAN
-IRX_DEFINE(mmceman);
+DRV_DEFINE(mmceman);
 #endif
 
 #ifdef ATA
 #define DEV9
 #define BDM
-IRX_DEFINE(ata_bd);
+DRV_DEFINE(ata_bd);
 #endif
 
 #ifdef USB
 #define BDM
-IRX_DEFINE(usbd_mini);
-IRX_DEFINE(usbmass_bd_mini);
+DRV_DEFINE(usbd_mini);
+DRV_DEFINE(usbmass_bd_mini);
 #endif
 
 #ifdef MX4SIO
 #define SIO2MAN
 #define BDM
-IRX_DEFINE(mx4sio_bd_mini);
+DRV_DEFINE(mx4sio_bd_mini);
 #endif
 
 #ifdef ILINK
 #define BDM
-IRX_DEFINE(iLinkman);
-IRX_DEFINE(IEEE1394_bd_mini);
+DRV_DEFINE(iLinkman);
+DRV_DEFINE(IEEE1394_bd_mini);
 #endif
 
 #ifdef UDPBD
 #define DEV9
 #define BDM
-IRX_DEFINE(smap_udpbd);
+DRV_DEFINE(smap_udpbd);
 #endif
 
 #ifdef APA
 #define DEV9
-IRX_DEFINE(ps2atad);
-IRX_DEFINE(ps2hdd);
-IRX_DEFINE(ps2fs);
+DRV_DEFINE(ps2atad);
+DRV_DEFINE(ps2hdd);
+DRV_DEFINE(ps2fs);
 #endif
 
 #ifdef CDROM
@@ -84,12 +103,12 @@ IRX_DEFINE(sio2man);
 #endif
 
 #ifdef DEV9
-IRX_DEFINE(ps2dev9);
+DRV_DEFINE(ps2dev9);
 #endif
 
 #ifdef BDM
-IRX_DEFINE(bdm);
-IRX_DEFINE(bdmfs_fatfs);
+DRV_DEFINE(bdm);
+DRV_DEFINE(bdmfs_fatfs);
 #endif
 
 #ifdef FMCB
@@ -98,7 +117,7 @@ IRX_DEFINE(poweroff);
 
 // Function used to initialize module arguments.
 // Must set argLength and return non-null pointer to a argument string if successful.
-// Returned pointer must point to dynamically allocated memory
+// Returned pointer must point to static memory that stays valid until the module is loaded
 typedef char *(*moduleArgFunc)(uint32_t *argLength);
 
 typedef struct ModuleListEntry {
@@ -114,70 +133,129 @@ typedef struct ModuleListEntry {
 
 // Argument functions
 char *initSMAPArguments(uint32_t *argLength);
-char *initPS2HDDArguments(uint32_t *argLength);
-char *initPS2FSArguments(uint32_t *argLength);
+
+#ifdef APA
+// up to 4 descriptors, 20 buffers
+static char ps2hddArguments[] = "-o"
+                                "\0"
+                                "4"
+                                "\0"
+                                "-n"
+                                "\0"
+                                "20";
+
+// up to 10 descriptors, 40 buffers
+static char ps2fsArguments[] = "-o"
+                               "\0"
+                               "10"
+                               "\0"
+                               "-n"
+                               "\0"
+                               "40";
+#endif
 
 // List of modules to load
 static ModuleListEntry moduleList[] = {
     INT_MODULE(iomanX, NULL, Device_Basic),
     INT_MODULE(fileXio, NULL, Device_Basic),
 #ifdef SIO2MAN
-    INT_MODULE(sio2man, NULL, Device_MemoryCard | Device_MMCE | Device_UDPBD | Device_CDROM),
+    INT_MODULE(sio2man, NULL, MC_DEVICES | Device_MMCE),
 #else
-    EXT_MODULE(sio2man, "rom0:SIO2MAN", NULL, Device_MemoryCard | Device_UDPBD | Device_CDROM),
+    EXT_MODULE(sio2man, "rom0:SIO2MAN", NULL, MC_DEVICES),
 #endif
 #ifndef USE_ROM_MODULES
-    INT_MODULE(mcman, NULL, Device_MemoryCard | Device_UDPBD | Device_CDROM),
-    INT_MODULE(mcserv, NULL, Device_MemoryCard | Device_UDPBD | Device_CDROM),
+    INT_MODULE(mcman, NULL, MC_DEVICES),
+    INT_MODULE(mcserv, NULL, MC_DEVICES),
 #else
-    EXT_MODULE(mcman, "rom0:MCMAN", NULL, Device_MemoryCard | Device_UDPBD | Device_CDROM),
-    EXT_MODULE(mcserv, "rom0:MCSERV", NULL, Device_MemoryCard | Device_UDPBD | Device_CDROM),
+    EXT_MODULE(mcman, "rom0:MCMAN", NULL, MC_DEVICES),
+    EXT_MODULE(mcserv, "rom0:MCSERV", NULL, MC_DEVICES),
 #endif
 #ifdef MMCE
-    INT_MODULE(mmceman, NULL, Device_MMCE),
+    DRV_MODULE(mmceman, NULL, Device_MMCE),
 #endif
 #ifdef DEV9
-    INT_MODULE(ps2dev9, NULL, Device_ATA | Device_UDPBD | Device_PFS),
+    DRV_MODULE(ps2dev9, NULL, Device_ATA | Device_UDPBD | Device_PFS),
 #endif
 #ifdef BDM
-    INT_MODULE(bdm, NULL, Device_BDM),
-    INT_MODULE(bdmfs_fatfs, NULL, Device_BDM),
+    DRV_MODULE(bdm, NULL, Device_BDM),
+    DRV_MODULE(bdmfs_fatfs, NULL, Device_BDM),
 #endif
 #ifdef ATA
-    INT_MODULE(ata_bd, NULL, Device_ATA),
+    DRV_MODULE(ata_bd, NULL, Device_ATA),
 #endif
 #ifdef USB
-    INT_MODULE(usbd_mini, NULL, Device_USB),
-    INT_MODULE(usbmass_bd_mini, NULL, Device_USB),
+    DRV_MODULE(usbd_mini, NULL, Device_USB),
+    DRV_MODULE(usbmass_bd_mini, NULL, Device_USB),
 #endif
 #ifdef MX4SIO
-    INT_MODULE(mx4sio_bd_mini, NULL, Device_MX4SIO),
+    DRV_MODULE(mx4sio_bd_mini, NULL, Device_MX4SIO),
 #endif
 #ifdef ILINK
-    INT_MODULE(iLinkman, NULL, Device_iLink),
-    INT_MODULE(IEEE1394_bd_mini, NULL, Device_iLink),
+    DRV_MODULE(iLinkman, NULL, Device_iLink),
+    DRV_MODULE(IEEE1394_bd_mini, NULL, Device_iLink),
 #endif
 #ifdef UDPBD
-    INT_MODULE(smap_udpbd, &initSMAPArguments, Device_UDPBD),
+    DRV_MODULE(smap_udpbd, &initSMAPArguments, Device_UDPBD),
 #endif
 #ifdef APA
-    INT_MODULE(ps2atad, NULL, Device_PFS),
-    INT_MODULE(ps2hdd, &initPS2HDDArguments, Device_PFS),
-    INT_MODULE(ps2fs, &initPS2FSArguments, Device_PFS),
+    DRV_MODULE(ps2atad, NULL, Device_PFS),
+    DRV_MODULE_ARGS(ps2hdd, ps2hddArguments, Device_PFS),
+    DRV_MODULE_ARGS(ps2fs, ps2fsArguments, Device_PFS),
 #endif
 };
 #define MODULE_COUNT sizeof(moduleList) / sizeof(ModuleListEntry)
 
 static DeviceType currentDevice = Device_None;
+static DeviceType failedDevices = Device_None;
+
+#ifdef EXTERNAL_DRIVERS
+static char driverPath[PATH_MAX];
+static char *driverName = NULL; // Points to the end of the directory path in driverPath
+
+// Sets the directory to load device drivers from. Only memory card paths are supported.
+// Falls back to the directory containing LAUNCHER_PATH
+void initDriverPath(const char *launcherPath) {
+  if (strncmp(launcherPath, "mc", 2))
+    launcherPath = LAUNCHER_PATH;
+
+  strncpy(driverPath, launcherPath, PATH_MAX - 1);
+  driverName = strrchr(driverPath, '/');
+  if (!driverName)
+    driverName = strchr(driverPath, ':');
+  driverName++;
+}
+
+// Loads the device driver from the launcher directory
+static int loadDriver(const char *name, uint32_t argLength, char *argStr) {
+  if (!driverName)
+    return -ENOENT;
+
+  snprintf(driverName, PATH_MAX - (driverName - driverPath), "%s.irx", name);
+  if (driverPath[2] != '?')
+    return SifLoadModule(driverPath, argLength, argStr);
+
+  // Try both memory cards
+  int ret = -ENOENT;
+  for (char i = '0'; i < '2'; i++) {
+    driverPath[2] = i;
+    if ((ret = SifLoadModule(driverPath, argLength, argStr)) >= 0)
+      break;
+  }
+  driverPath[2] = '?';
+  return ret;
+}
+#endif
 
 // Initializes IOP modules for given device type
 int initModules(DeviceType device) {
-  if (currentDevice == device)
+  if ((currentDevice & device) == device)
     // Do nothing if the drivers are already loaded
     return 0;
 
   int ret = 0;
   int iopret = 0;
+  TRACE_BEGIN(TRACE_INIT_MODULES, device);
+  failedDevices = Device_None;
 
   // Initialize the RPC manager and reboot the IOP
   sceSifInitRpc(0);
@@ -185,6 +263,7 @@ int initModules(DeviceType device) {
   };
   while (!SifIopSync()) {
   };
+  currentDevice = Device_None;
 
   // Initialize the RPC manager
   sceSifInitRpc(0);
@@ -199,7 +278,7 @@ int initModules(DeviceType device) {
   for (int i = 0; i < MODULE_COUNT; i++) {
     ret = 0;
     iopret = 0;
-    if (!(device & moduleList[i].type) && (moduleList[i].type != Device_Basic))
+    if (!(device & moduleList[i].type) && !(moduleList[i].type & Device_Basic))
       continue;
 
     // If module has an arugment function, execute it
@@ -207,12 +286,17 @@ int initModules(DeviceType device) {
       moduleList[i].argStr = moduleList[i].argumentFunction(&moduleList[i].argLength);
       if (moduleList[i].argStr == NULL) {
         msg("ERROR: Failed to initialize arguments for module %s\n", moduleList[i].name);
+        failedDevices = moduleList[i].type;
         return -ENOENT;
       }
     }
 
     if (moduleList[i].path)
       ret = SifLoadModule(moduleList[i].path, moduleList[i].argLength, moduleList[i].argStr);
+#ifdef EXTERNAL_DRIVERS
+    else if (!moduleList[i].irx)
+      ret = loadDriver(moduleList[i].name, moduleList[i].argLength, moduleList[i].argStr);
+#endif
     else
       ret = SifExecModuleBuffer(moduleList[i].irx, *moduleList[i].size, moduleList[i].argLength, moduleList[i].argStr, &iopret);
 
@@ -223,18 +307,19 @@ int initModules(DeviceType device) {
 
     if (ret) {
       msg("ERROR: Failed to initialize module %s: %d\n", moduleList[i].name, ret);
+      failedDevices = moduleList[i].type;
       return ret;
     }
-
-    // Clean up arguments
-    if (moduleList[i].argStr != NULL)
-      free(moduleList[i].argStr);
   }
 
   currentDevice = device;
+  TRACE_END(TRACE_INIT_MODULES, device);
   return 0;
 }
 
+// Returns the devices served by the module that failed to load during the last initModules call
+DeviceType getFailedDevices() { return failedDevices; }
+
 // Reboots the console
 void rebootPS2() {
   sceSifInitRpc(0);
@@ -269,79 +354,53 @@ void applyXPARAM(char *gameID) {
 
 // Argument functions
 
+// IPCONFIG.DAT path resolved by the patcher
+static const char *resolvedIPConfigPath = NULL;
+
+// Sets IPCONFIG.DAT path resolved by the patcher
+void setIPConfigPath(const char *path) { resolvedIPConfigPath = path; }
+
 #ifdef UDPBD
 // Builds IP address argument for SMAP module
 // using mc?:SYS-CONF/IPCONFIG.DAT from memory card
 char *initSMAPArguments(uint32_t *argLength) {
   // Try to get IP from IPCONFIG.DAT
-  // The 'X' in "mcX" will be replaced with memory card number
-  static char ipconfigPath[] = "mcX:/SYS-CONF/IPCONFIG.DAT";
-
-  int ipconfigFd, count;
-  char ipAddr[16]; // IP address will not be longer than 15 characters
-  for (char i = '0'; i < '2'; i++) {
+  // The '?' in "mc?" will be replaced with memory card number
+  static char ipconfigPath[] = IPCONFIG_PATH;
+  static char ipArg[IP_ADDRESS_LEN + 3] = "ip="; // 3 bytes for 'ip='
+
+  int ipconfigFd = -ENOENT, count = 0;
+  char ipconfigData[IPCONFIG_MAX_SIZE];
+  // Try the path resolved by the patcher first
+  if (resolvedIPConfigPath && ((ipconfigFd = open(resolvedIPConfigPath, O_RDONLY)) >= 0)) {
+    count = read(ipconfigFd, ipconfigData, sizeof(ipconfigData) - 1);
+    close(ipconfigFd);
+  }
+  for (char i = '0'; (ipconfigFd < 0) && (i < '2'); i++) {
     ipconfigPath[2] = i;
     // Attempt to open IPCONFIG.DAT
     ipconfigFd = open(ipconfigPath, O_RDONLY);
     if (ipconfigFd >= 0) {
-      count = read(ipconfigFd, ipAddr, sizeof(ipAddr) - 1);
+      count = read(ipconfigFd, ipconfigData, sizeof(ipconfigData) - 1);
       close(ipconfigFd);
-      break;
     }
   }
 
-  if ((ipconfigFd < 0) || (count < sizeof(ipAddr) - 1)) {
-    msg("ERROR: Failed to read IP address from IPCONFIG.DAT\n");
+  if ((ipconfigFd < 0) || (count <= 0)) {
+    msg("ERROR: Failed to read IPCONFIG.DAT\n");
     return NULL;
   }
+  ipconfigData[count] = '\0';
 
-  count = 0; // Reuse count as line index
-  // In case IP address is shorter than 15 chars
-  while (!isspace((unsigned char)ipAddr[count])) {
-    // Advance index until we read a whitespace character
-    count++;
+  // SMAP only needs the IP address, netmask and gateway are not used by UDPBD
+  ipConfig config;
+  int len;
+  if (parseIPConfig(ipconfigData, &config) || ((len = formatIPAddress(&ipArg[3], sizeof(ipArg) - 3, config.ip)) < 0)) {
+    msg("ERROR: Failed to parse IP address from IPCONFIG.DAT\n");
+    return NULL;
   }
 
-  char ipArg[19]; // 15 bytes for IP string + 3 bytes for 'ip='
-  *argLength = 19;
-  char *argStr = calloc(sizeof(char), 19);
-  snprintf(argStr, sizeof(ipArg), "ip=%s", ipAddr);
-  return argStr;
-}
-#endif
-
-#ifdef APA
-// up to 4 descriptors, 20 buffers
-static char ps2hddArguments[] = "-o"
-                                "\0"
-                                "4"
-                                "\0"
-                                "-n"
-                                "\0"
-                                "20";
-// Sets arguments for PS2HDD modules
-char *initPS2HDDArguments(uint32_t *argLength) {
-  *argLength = sizeof(ps2hddArguments);
-
-  char *argStr = malloc(sizeof(ps2hddArguments));
-  memcpy(argStr, ps2hddArguments, sizeof(ps2hddArguments));
-  return argStr;
-}
-
-// up to 10 descriptors, 40 buffers
-char ps2fsArguments[] = "-o"
-                        "\0"
-                        "10"
-                        "\0"
-                        "-n"
-                        "\0"
-                        "40";
-// Sets arguments for PS2HDD modules
-char *initPS2FSArguments(uint32_t *argLength) {
-  *argLength = sizeof(ps2fsArguments);
-
-  char *argStr = malloc(sizeof(ps2fsArguments));
-  memcpy(argStr, ps2fsArguments, sizeof(ps2fsArguments));
-  return argStr;
+  *argLength = len + 4; // 'ip=' and the string terminator
+  return ipArg;
 }
 #endif
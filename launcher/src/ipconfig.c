@@ -0,0 +1,61 @@
+#include "ipconfig.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Returns non-zero if c separates IPCONFIG.DAT fields
+static int isSeparator(char c) { return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'); }
+
+// Parses the dotted-decimal IPv4 address at *pos and advances *pos past it.
+// Octets can have leading zeroes (e.g. 192.168.001.010). Returns 0 on success
+static int parseAddress(const char **pos, uint8_t *addr) {
+  const char *p = *pos;
+  for (int i = 0; i < 4; i++) {
+    if ((i > 0) && (*p++ != '.'))
+      return -EINVAL;
+
+    int value = 0, digits = 0;
+    while ((*p >= '0') && (*p <= '9') && (digits < 3)) {
+      value = value * 10 + (*p++ - '0');
+      digits++;
+    }
+    if (!digits || (value > 255))
+      return -EINVAL;
+    addr[i] = value;
+  }
+
+  // The address must be followed by a separator or the end of the data
+  if ((*p != '\0') && !isSeparator(*p))
+    return -EINVAL;
+
+  *pos = p;
+  return 0;
+}
+
+// Parses IPCONFIG.DAT contents. data must be NUL-terminated.
+// Netmask and gateway are optional. Returns 0 on success or -EINVAL if any present address is invalid
+int parseIPConfig(const char *data, ipConfig *config) {
+  uint8_t *fields[] = {config->ip, config->netmask, config->gateway};
+  memset(config, 0, sizeof(ipConfig));
+
+  for (int i = 0; i < 3; i++) {
+    while (isSeparator(*data))
+      data++;
+    if (*data == '\0')
+      // IP address is required
+      return i ? 0 : -EINVAL;
+
+    if (parseAddress(&data, fields[i]))
+      return -EINVAL;
+  }
+  return 0;
+}
+
+// Writes the address in dotted-decimal notation without leading zeroes into buf.
+// Returns the string length or -1 if the buffer is too small
+int formatIPAddress(char *buf, size_t size, const uint8_t *addr) {
+  int len = snprintf(buf, size, "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+  if ((len < 0) || (len >= size))
+    return -1;
+  return len;
+}
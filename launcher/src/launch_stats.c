@@ -0,0 +1,141 @@
+#include "launch_stats.h"
+#include "common.h"
+#include "defaults.h"
+#include "stats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <libcdvd.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// The 'X' in "mcX" will be replaced with the memory card number in updateLaunchStats
+static char statsPath[] = STATS_PATH;
+
+static int compactLaunchStats(int recordCount);
+static uint32_t getStatsTimestamp(void);
+
+// Appends the launch record for OSDMENU.CNF item to the statistics file on the memory card containing cnfPath
+// Expects memory card modules to be loaded
+int updateLaunchStats(const char *cnfPath, int itemIdx) {
+  launchStatsRecord record;
+  int fd, size, res;
+
+  // Keep the statistics file on the same card as the config file
+  statsPath[2] = cnfPath[2];
+
+  record.itemIdx = itemIdx;
+  record.launchCount = 1;
+  record.timestamp = getStatsTimestamp();
+
+  // Records are written at an explicit offset. O_APPEND would ignore the seek past an incomplete record
+  if ((fd = open(statsPath, O_WRONLY | O_CREAT)) < 0) {
+    DPRINTF("ERROR: Failed to open %s: %d\n", statsPath, fd);
+    return fd;
+  }
+
+  size = lseek(fd, 0, SEEK_END);
+  if (size < 0) {
+    close(fd);
+    return size;
+  }
+
+  if ((size / sizeof(launchStatsRecord)) >= STATS_MAX_RECORDS) {
+    // Merge records belonging to the same item
+    close(fd);
+    if ((res = compactLaunchStats(size / sizeof(launchStatsRecord))) < 0) {
+      DPRINTF("ERROR: Failed to compact %s: %d\n", statsPath, res);
+      return res;
+    }
+    if ((fd = open(statsPath, O_WRONLY)) < 0)
+      return fd;
+    if ((size = lseek(fd, 0, SEEK_END)) < 0) {
+      close(fd);
+      return size;
+    }
+  }
+
+  // Write after the last complete record, overwriting the incomplete record left by an interrupted write
+  if ((res = lseek(fd, size - (size % sizeof(launchStatsRecord)), SEEK_SET)) < 0) {
+    close(fd);
+    return res;
+  }
+
+  DPRINTF("Writing launch record for item %d to %s\n", itemIdx, statsPath);
+  res = write(fd, &record, sizeof(record)) == sizeof(record) ? 0 : -EIO;
+  close(fd);
+  return res;
+}
+
+// Replaces the statistics file contents with one record per item
+static int compactLaunchStats(int recordCount) {
+  launchStatsRecord *records = malloc(recordCount * sizeof(launchStatsRecord));
+  if (!records)
+    return -ENOMEM;
+
+  int fd = open(statsPath, O_RDONLY);
+  if (fd < 0) {
+    free(records);
+    return fd;
+  }
+  int res = read(fd, records, recordCount * sizeof(launchStatsRecord));
+  close(fd);
+  if (res != recordCount * sizeof(launchStatsRecord)) {
+    free(records);
+    return -EIO;
+  }
+
+  int compactCount = 0;
+  for (int i = 0; i < recordCount; i++) {
+    int j;
+    for (j = 0; j < compactCount; j++) {
+      if (records[j].itemIdx != records[i].itemIdx)
+        continue;
+
+      // Saturate the launch count
+      if ((uint32_t)records[j].launchCount + records[i].launchCount > 0xFFFF)
+        records[j].launchCount = 0xFFFF;
+      else
+        records[j].launchCount += records[i].launchCount;
+
+      if (records[i].timestamp > records[j].timestamp)
+        records[j].timestamp = records[i].timestamp;
+      break;
+    }
+    if (j == compactCount)
+      records[compactCount++] = records[i];
+  }
+
+  // Drop the oldest records if the file can't be compacted any further
+  if (compactCount >= STATS_MAX_RECORDS) {
+    DPRINTF("WARN: Too many items in the statistics file, dropping the oldest records\n");
+    while (compactCount >= STATS_MAX_RECORDS / 2) {
+      int oldest = 0;
+      for (int i = 1; i < compactCount; i++)
+        if (records[i].timestamp < records[oldest].timestamp)
+          oldest = i;
+      records[oldest] = records[--compactCount];
+    }
+  }
+  DPRINTF("Compacted %d launch records into %d\n", recordCount, compactCount);
+
+  if ((fd = open(statsPath, O_WRONLY | O_CREAT | O_TRUNC)) < 0) {
+    free(records);
+    return fd;
+  }
+  res = write(fd, records, compactCount * sizeof(launchStatsRecord)) == compactCount * sizeof(launchStatsRecord) ? 0 : -EIO;
+  close(fd);
+  free(records);
+  return res;
+}
+
+// Returns timestamp suitable for the launch record
+static uint32_t getStatsTimestamp(void) {
+  sceCdCLOCK time;
+
+  if (!sceCdInit(SCECdINoD))
+    return 0;
+
+  sceCdReadClock(&time);
+  sceCdInit(SCECdEXIT);
+  return STATS_SET_TIMESTAMP(btoi(time.year), btoi(time.month & 0x7F), btoi(time.day), btoi(time.hour), btoi(time.minute), btoi(time.second));
+}
@@ -1,3 +1,5 @@
+#include "common.h"
+#include "trace.h"
 #include <kernel.h>
 #include <sifrpc.h>
 #include <stdint.h>
@@ -46,6 +48,15 @@ typedef struct {
 #define ELF_MAGIC 0x464c457f
 #define ELF_PT_LOAD 1
 
+// Extra stack space below the current stack pointer considered to be used by the launcher
+#define STACK_MARGIN 0x10000
+
+#ifdef LOADER_FULL_WIPE
+int loaderFullWipe = 1;
+#else
+int loaderFullWipe = 0;
+#endif
+
 int LoadELFFromFile(int argc, char *argv[]) {
   uint8_t *boot_elf;
   elf_header_t *eh;
@@ -72,6 +83,26 @@ int LoadELFFromFile(int argc, char *argv[]) {
     memcpy(eph[i].vaddr, pdata, eph[i].filesz);
   }
 
+  // Pass the memory ranges used by the launcher to the loader, so it clears only those
+  // and the gaps between the target ELF segments. Without the ranges, the loader clears all user memory
+  static char wipeArg[24];
+  char **loaderArgv = loaderFullWipe ? NULL : malloc((argc + 1) * sizeof(char *));
+  if (loaderArgv) {
+    uint32_t sp;
+    asm volatile("move %0, $sp" : "=r"(sp));
+
+    loaderArgv[0] = wipeArg;
+    memcpy(&loaderArgv[1], argv, argc * sizeof(char *));
+    snprintf(wipeArg, sizeof(wipeArg), "-wipe=%x:%x", (uint32_t)sbrk(0), (sp & ~0xFFFF) - STACK_MARGIN);
+    argv = loaderArgv;
+    argc++;
+  }
+
+  TRACE_MARK(TRACE_LOAD_ELF, argc);
+#ifdef ENABLE_TRACE
+  flushTrace();
+#endif
+
   SifExitRpc();
   FlushCache(0);
   FlushCache(2);
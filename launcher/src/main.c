@@ -1,6 +1,8 @@
 #include "common.h"
 #include "handlers.h"
+#include "init.h"
 #include "loader.h"
+#include "trace.h"
 #include <fcntl.h>
 #include <kernel.h>
 #include <ps2sdkapi.h>
@@ -14,6 +16,12 @@ void _libcglue_rtc_update() {}
 PS2_DISABLE_AUTOSTART_PTHREAD();
 
 int main(int argc, char *argv[]) {
+  TRACE_MARK(TRACE_LAUNCHER_MAIN, argc);
+
+#ifdef EXTERNAL_DRIVERS
+  initDriverPath(argv[0]);
+#endif
+
   if (argc < 2) {
     // Try to quickboot with paths from .CNF located at the current working directory
     fail("Quickboot failed: %d", handleQuickboot(argv[0]));
@@ -25,6 +33,13 @@ int main(int argc, char *argv[]) {
   if (!argv[0])
     fail("Invalid argv[0]");
 
+  // The patcher passes -fullwipe right after the item when launcher_full_wipe is enabled in OSDMENU.CNF
+  if ((argc > 1) && !strcmp(argv[1], "-fullwipe")) {
+    loaderFullWipe = 1;
+    argc--;
+    memmove(&argv[1], &argv[2], (argc - 1) * sizeof(char *));
+  }
+
   char *p = strrchr(argv[0], '.');
   if (p && (!strcmp(p, ".cfg") || !strcmp(p, ".CFG") || !strcmp(p, ".CNF") || !strcmp(p, ".cnf")))
     // If argv[1] is a CNF/CFG file, try to load it
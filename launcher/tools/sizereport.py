@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# Prints the launcher size report from the linker map file and the built ELF files.
+# Lists the size of every embedded module (IRX drivers, the ELF loader and resource files),
+# the launcher code and data and the unpacked and packed ELF sizes.
+# The sizes can be saved and passed back as the baseline to print the change against an earlier build
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../patcher/tools"))
+from memreport import parseMap  # noqa: E402
+
+MODULE_SUFFIXES = ("_irx.o", "_elf.o", "_sys.o")
+
+
+def readSizes(path):
+    sizes = {}
+    with open(path) as f:
+        for line in f:
+            name, size = line.split()
+            sizes[name] = int(size)
+    return sizes
+
+
+def main():
+    if len(sys.argv) not in (5, 6):
+        print("Usage: %s <map file> <unpacked ELF> <packed ELF> <output sizes file> [baseline sizes file]" % sys.argv[0])
+        return 1
+
+    objects, _ = parseMap(sys.argv[1])
+    sizes = {}
+    code = 0
+    for obj, entry in objects.items():
+        if obj.endswith(MODULE_SUFFIXES):
+            sizes[obj[:-2]] = sum(entry.values())
+        else:
+            code += sum(entry.values())
+
+    modules = sorted(sizes, key=lambda m: -sizes[m])
+    sizes["modules"] = sum(sizes[m] for m in modules)
+    sizes["launcher"] = code
+    sizes["unpacked"] = os.path.getsize(sys.argv[2])
+    sizes["packed"] = os.path.getsize(sys.argv[3])
+
+    baseline = readSizes(sys.argv[5]) if len(sys.argv) == 6 else {}
+    with open(sys.argv[4], "w") as f:
+        for name, size in sizes.items():
+            f.write("%s %d\n" % (name, size))
+
+    def row(label, name):
+        size = sizes.get(name, 0)
+        if not baseline:
+            print("%-32s %8d" % (label, size))
+        elif name in baseline:
+            print("%-32s %8d %8d %+8d" % (label, size, baseline[name], size - baseline[name]))
+        else:
+            print("%-32s %8d %8s %+8d" % (label, size, "-", size))
+
+    print(("%-32s %8s" % ("module", "size")) + (" %8s %8s" % ("baseline", "change") if baseline else ""))
+    for m in modules:
+        row(m, m)
+    # Modules removed since the baseline
+    for name in baseline:
+        if name.endswith(tuple(s[:-2] for s in MODULE_SUFFIXES)) and name not in sizes:
+            print("%-32s %8s %8d %+8d" % (name, "-", baseline[name], -baseline[name]))
+    print()
+    row("Embedded modules", "modules")
+    row("Launcher code and data", "launcher")
+    row(os.path.basename(sys.argv[2]), "unpacked")
+    row(os.path.basename(sys.argv[3]), "packed")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,40 @@
+#ifndef _ANIMATION_H_
+#define _ANIMATION_H_
+#include "clock.h"
+#include <stdint.h>
+
+// Menu animations are timed with the COP0 Count register (CPU clock, 294.912 MHz)
+// so they run at the same speed regardless of the video mode refresh rate
+#define ANIM_TICKS_PER_MS CLOCK_TICKS_PER_MS
+// Legacy per-frame animations (like the cursor) are stepped at 60 Hz
+#define ANIM_TICKS_PER_STEP (ANIM_TICKS_PER_MS * 1000 / 60)
+// Fixed-point precision of the easing curve
+#define ANIM_CURVE_SHIFT 12
+
+// Eases a value towards the target over a fixed duration
+typedef struct {
+  int from;         // Value at the start of the animation
+  int to;           // Target value
+  int value;        // Current value
+  uint32_t elapsed; // Time since the start of the animation, in ticks
+} animEasing;
+
+// Precomputes the easing curve and sets the easing duration
+void animInit(int durationMs);
+
+// Returns the number of ticks elapsed since the previous call
+uint32_t animFrameTime();
+
+// Immediately sets the animated value
+void animJump(animEasing *anim, int value);
+
+// Restarts the animation from the current value if the target has changed
+void animSetTarget(animEasing *anim, int to);
+
+// Advances the animation by dt ticks and returns the current value
+int animUpdate(animEasing *anim, uint32_t dt);
+
+// Advances the step accumulator by dt ticks and returns the number of whole 60 Hz steps to run
+int animSteps(uint32_t *accumulator, uint32_t dt);
+
+#endif
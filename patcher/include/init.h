@@ -1,13 +1,26 @@
 #ifndef _INIT_H_
 #define _INIT_H_
 
+// Boot-only code and data that is not used once OSDSYS starts.
+// Placed into the .boot section, which reclaimBootMemory hands over to the heap
+#define BOOT_CODE __attribute__((section(".boot.text")))
+#define BOOT_DATA __attribute__((section(".boot.data")))
+
 // Wipes user memory
 void wipeUserMem(void);
 
+// Hands the .boot section over to the heap. Called right before OSDSYS starts, once no boot-only code is left to run
+void reclaimBootMemory(void);
+
 // Loads IOP modules
 int initModules(void);
 
 // Resets IOP before loading OSDSYS
 void resetModules();
 
+#ifdef ENABLE_TRACE
+// Writes recorded trace events to the memory card. Truncates the trace file unless append is set
+void flushTrace(int append);
+#endif
+
 #endif
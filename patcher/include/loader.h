@@ -6,4 +6,13 @@ void launchItem(char *item);
 // Uses the launcher to run the disc
 void launchDisc();
 
+// Tries to open launcher ELF on both memory cards
+int probeLauncher();
+
+// Finds DKWDRV and IPCONFIG.DAT on memory cards so the launcher doesn't have to probe both cards
+void resolveFilePaths();
+
+// Reloads the config file and restarts OSDSYS with the new settings
+void reloadOSDSYS();
+
 #endif
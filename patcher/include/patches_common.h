@@ -1,23 +1,59 @@
 #ifndef _PATCHES_COMMON_H_
 #define _PATCHES_COMMON_H_
+#include "pattern_search.h"
 #include <stdint.h>
 
 // All protokernel menu code seems to be located starting from 0x600000 (OSDSYS is loaded at 0x200000)
 #define PROTOKERNEL_MENU_OFFSET 0x400000
 
+// Patch functions return 0 if the patch was applied, PATCH_NOT_NEEDED if the patch
+// doesn't apply to the current configuration or a negative number if the patch pattern was not found
+#define PATCH_NOT_NEEDED 1
+
+// Patch table entries. Also used as bit numbers in the patch status bitmaps
+typedef enum {
+  PATCH_MENU,
+  PATCH_MENU_DRAW,
+  PATCH_INFINITE_SCROLLING,
+  PATCH_BUTTON_PANEL,
+  PATCH_BROWSER_LAUNCHER,
+  PATCH_VERSION_INFO,
+  PATCH_VIDEO_MODE,
+  PATCH_SKIP_DISC,
+  PATCH_SKIP_HDD,
+  PATCH_DISC_LAUNCH,
+  PATCH_GS_VIDEO_MODE,
+  // Protokernel patches
+  PATCH_MENU_PROTO,
+  PATCH_MENU_DRAW_PROTO,
+  PATCH_INFINITE_SCROLLING_PROTO,
+  PATCH_BROWSER_LAUNCHER_PROTO,
+  PATCH_VERSION_INFO_PROTO,
+  PATCH_GS_VIDEO_MODE_PROTO,
+  PATCH_DISC_LAUNCH_PROTO,
+  PATCH_COUNT
+} PatchID;
+
+// Returns the first match of the patch pattern in the patch search range.
+// While the patch table is being applied, returns the site found before any patch modified OSDSYS
+uint8_t *findPatchSite(PatchID id, uint8_t *osd);
+
+// Searches for the patch pattern in the given range
+uint8_t *findPatchPattern(PatchID id, uint8_t *buf, uint32_t bufsize);
+
 // Loads OSDSYS from ROM and handles the patching
 void launchOSDSYS();
 
+// Launches regular or protokernel OSDSYS depending on the ROM
+void startOSDSYS();
+
 // Calls OSDSYS deinit function
 void deinitOSDSYS();
 
 // Loads OSDSYS from ROM and injects the patching function into OSDSYS
 void launchProtokernelOSDSYS();
 
-// Searches for byte pattern in memory
-uint8_t *findPatternWithMask(uint8_t *buf, uint32_t bufsize, uint8_t *bytes, uint8_t *mask, uint32_t len);
-
-// Searches for string in memory
-char *findString(const char *string, char *buf, uint32_t bufsize);
+// Returns the patch status string for the version menu
+char *getPatchStatus();
 
 #endif
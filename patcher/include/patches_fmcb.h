@@ -4,40 +4,40 @@
 #include <stdint.h>
 
 // Patches OSD menu to include custom menu entries
-void patchMenu(uint8_t *osd);
+int patchMenu(uint8_t *osd);
 
 // Patches menu drawing functions
-void patchMenuDraw(uint8_t *osd);
+int patchMenuDraw(uint8_t *osd);
 
 // Patches OSDSYS button prompts
-void patchMenuButtonPanel(uint8_t *osd);
+int patchMenuButtonPanel(uint8_t *osd);
 
 // Patches the disc launch handlers to load discs with the launcher
-void patchDiscLaunch(uint8_t *osd);
+int patchDiscLaunch(uint8_t *osd);
 
 // Patches automatic disc launch
-void patchSkipDisc(uint8_t *osd);
+int patchSkipDisc(uint8_t *osd);
 
 // Patches menu scrolling
-void patchMenuInfiniteScrolling(uint8_t *osd, int isProtokernel);
+int patchMenuInfiniteScrolling(uint8_t *osd, int isProtokernel);
 
 // Forces the video mode
-void patchVideoMode(uint8_t *osd, GSVideoMode mode);
+int patchVideoMode(uint8_t *osd, GSVideoMode mode);
 
 // Patches HDD update code for ROMs not supporting "SkipHdd" arg
-void patchSkipHDD(uint8_t *osd);
+int patchSkipHDD(uint8_t *osd);
 
 //
 // Protokernel patches
 //
 
 // Patches OSD menu to include custom menu entries
-void patchMenuProtokernel(uint8_t *osd);
+int patchMenuProtokernel(uint8_t *osd);
 
 // Patches menu drawing functions
-void patchMenuDrawProtokernel(uint8_t *osd);
+int patchMenuDrawProtokernel(uint8_t *osd);
 
 // Patches the disc launch handlers to load discs with the launcher
-void patchDiscLaunchProtokernel(uint8_t *osd);
+int patchDiscLaunchProtokernel(uint8_t *osd);
 
 #endif
@@ -5,25 +5,29 @@
 #include <stdint.h>
 
 // Extends version menu with custom entries
-void patchVersionInfo(uint8_t *osd);
+int patchVersionInfo(uint8_t *osd);
 
 // Overrides SetGsCrt and sceGsPutDispEnv functions to support 480p and 1080i output modes
 // ALWAYS call restoreGSVideoMode before launching apps
-void patchGSVideoMode(uint8_t *osd, GSVideoMode outputMode);
+int patchGSVideoMode(uint8_t *osd, GSVideoMode outputMode);
 
 // Restores SetGsCrt.
 // Can be safely called even if GS video mode patch wasn't applied
 void restoreGSVideoMode();
 
 // Browser application launch patch
-void patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel);
+int patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel);
+
+// Loads app indexes from both memory cards for the browser application launch patch
+// Must be called before launching OSDSYS
+void loadAppIndex();
 
 // Protokernel patches
 
 // Extends version menu with custom entries
-void patchVersionInfoProtokernel(uint8_t *osd);
+int patchVersionInfoProtokernel(uint8_t *osd);
 
 // Overrides SetGsCrt and sceGsPutDispEnv functions to support 480p and 1080i output modes
-void patchGSVideoModeProtokernel(uint8_t *osd, GSVideoMode outputMode);
+int patchGSVideoModeProtokernel(uint8_t *osd, GSVideoMode outputMode);
 
 #endif
@@ -0,0 +1,11 @@
+#ifndef _PATTERN_SEARCH_H_
+#define _PATTERN_SEARCH_H_
+#include <stdint.h>
+
+// Searches for byte pattern in memory
+uint8_t *findPatternWithMask(uint8_t *buf, uint32_t bufsize, uint8_t *bytes, uint8_t *mask, uint32_t len);
+
+// Searches for string in memory
+char *findString(const char *string, char *buf, uint32_t bufsize);
+
+#endif
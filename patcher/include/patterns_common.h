@@ -7,13 +7,13 @@
 //
 
 // ExecPS2 pattern for patching OSDSYS unpacker on newer PS2 with compressed OSDSYS
-static uint32_t patternExecPS2[] = {
+static const uint32_t patternExecPS2[] = {
     0x24030007, // li v1, 7
     0x0000000c, // syscall
     0x03e00008, // jr ra
     0x00000000  // nop
 };
-static uint32_t patternExecPS2_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+static const uint32_t patternExecPS2_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
 
 //
 // The following patterns are introduced in FMCB 1.9 and found by reverse-engineering FMCB 1.9 code
@@ -21,19 +21,19 @@ static uint32_t patternExecPS2_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xf
 
 // Used to inject the patching function into the OSDSYS init on protokernels
 // Inject j <applyPatches> at offset +0x3c
-static uint32_t patternOSDSYSProtokernelInit[] = {
+static const uint32_t patternOSDSYSProtokernelInit[] = {
     0x26940414, // addiu s4,s4,0x0414
     0x26d60414, // addiu s6,s6,0x0414
     0x2aa2000c, // slti  v0,s5,0x000C
     0x14400000, // bne   v0,zero,0x????
     0x26520414, // addiu s2,s2,0x0414
 };
-static uint32_t patternOSDSYSProtokernelInit_mask[] = {
+static const uint32_t patternOSDSYSProtokernelInit_mask[] = {
     0xffffffff, 0xffffffff, 0xffffffff, 0xffff0000, 0xffffffff,
 };
 
 // Used to deinit OSDSYS
-static uint32_t patternOSDSYSDeinit[] = {
+static const uint32_t patternOSDSYSDeinit[] = {
     0x27bdffe0, // addiu sp,sp,0xFFE0
     0xffb00000, // sd    s0,0x0000,sp
     0x0080802d, // addiu s0,a0,zero
@@ -43,7 +43,7 @@ static uint32_t patternOSDSYSDeinit[] = {
     0x0c000000, // jal   DisableIntc
     0x24040002, // addiu a0,zero,0x0002
 };
-static uint32_t patternOSDSYSDeinit_mask[] = {
+static const uint32_t patternOSDSYSDeinit_mask[] = {
     0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff, 0xfc000000, 0xffffffff,
 };
 
@@ -4,17 +4,17 @@
 #include <stdint.h>
 
 // Pattern for finding OSD menu info struct
-static uint32_t patternMenuInfo[] = {
+static const uint32_t patternMenuInfo[] = {
     0x00000001, // unknown
     0x00000000, // pointer to osdmenu
     0x00000002, // number of entries
     0x00000003, // unknown
     0x00000000  // current selection
 };
-static uint32_t patternMenuInfo_mask[] = {0xffffffff, 0xff800000, 0xffffffff, 0xffffffff, 0xffffffff};
+static const uint32_t patternMenuInfo_mask[] = {0xffffffff, 0xff800000, 0xffffffff, 0xffffffff, 0xffffffff};
 
 // Pattern for injecting OSD strings
-static uint32_t patternOSDString[] = {
+static const uint32_t patternOSDString[] = {
     // Search pattern in the osd string function:
     0x10000005, //     beq	zero, zero, L2
     0x8c620000, //     lw	v0, $xxxx(v1)
@@ -24,12 +24,12 @@ static uint32_t patternOSDString[] = {
     0x8c620000, //     lw	v0, $0000(v1)	# pointer to string
     0xdfbf0010  // L2: ld	ra, $0010(sp)
 };
-static uint32_t patternOSDString_mask[] = {0xffffffff, 0xffff0000, 0xffffffff, 0xffff0000, 0xffffffff, //
+static const uint32_t patternOSDString_mask[] = {0xffffffff, 0xffff0000, 0xffffffff, 0xffff0000, 0xffffffff, //
                                            0xffffffff, 0xffffffff};
 
 // Pattern for patching the user input handling function, compatible with both CEX and DEX
 // Slightly different offsets on DEX >=2.20 are likely caused by the addition of region select menu
-static uint32_t patternUserInputHandler[] = {
+static const uint32_t patternUserInputHandler[] = {
     0x10000000, //     beq	zero, zero, exit
     0xdfbf0000, //     ld	ra, $00xx(sp)
     0x24040001, // L1: li	a0, 1		# the 2nd menu item (sys conf)
@@ -41,11 +41,11 @@ static uint32_t patternUserInputHandler[] = {
     0x10000000, //     beq	zero, zero, exit
     0xdfbf0000  //     ld	ra, $00xx(sp)
 };
-static uint32_t patternUserInputHandler_mask[] = {0xffffff00, 0xffffff00, 0xffffffff, 0xffff0000, 0xffffff00,
+static const uint32_t patternUserInputHandler_mask[] = {0xffffff00, 0xffffff00, 0xffffffff, 0xffff0000, 0xffffff00,
                                                   0xffffff00, 0xfc000000, 0xffffffff, 0xffffff00, 0xffffff00};
 
 // Pattern for patching the draw functions for selected/unselected items
-static uint32_t patternDrawMenuItem[] = {
+static const uint32_t patternDrawMenuItem[] = {
     // Search pattern in the drawmenu function:
     0x001010c0, //     sll	v0, s0, 3	# selection multiplied by 8 (offset into menu)
     0x00431021, //     addu	v0, v0, v1	# pointer to string index
@@ -58,11 +58,11 @@ static uint32_t patternDrawMenuItem[] = {
     0x0c000000, //     jal	DrawMenuItem
     0x0260382d  //     daddu	a3, s3, zero	# arg3: alpha
 };
-static uint32_t patternDrawMenuItem_mask[] = {0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff, 0xffffffff, //
+static const uint32_t patternDrawMenuItem_mask[] = {0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff, 0xffffffff, //
                                               0xffffffff, 0xffffffff, 0xff000000, 0xfc000000, 0xffffffff};
 
 // Patterns for patching the draw functions for bottom button prompts
-static uint32_t patternDrawButtonPanel_1[] = {
+static const uint32_t patternDrawButtonPanel_1[] = {
     // Search for draw_button_panel function start:
     0x00c0002d, //     daddu XX, a2, zero
     0xff000000, //     sd	 XX, 0x00XX(sp)
@@ -75,9 +75,9 @@ static uint32_t patternDrawButtonPanel_1[] = {
     0x0c000000, //     jal 	 unknown
     0xff000000  //     sd	 XX, 0x00XX(sp)
 };
-static uint32_t patternDrawButtonPanel_1_mask[] = {0xffff00ff, 0xff00ff00, 0xffffffff, 0xff00ff00, 0xff00ff00, //
+static const uint32_t patternDrawButtonPanel_1_mask[] = {0xffff00ff, 0xff00ff00, 0xffffffff, 0xff00ff00, 0xff00ff00, //
                                                    0xffffff00, 0xffffff00, 0xff00ff00, 0xfc000000, 0xff00ff00};
-static uint32_t patternDrawButtonPanel_2[] = {
+static const uint32_t patternDrawButtonPanel_2[] = {
     // Search pattern in the draw_button_panel function:
     0x3c020000, //     lui 	 v0, 0x00XX
     0x0200302d, //     daddu a2, XX, zero    # arg2 : Y
@@ -88,9 +88,9 @@ static uint32_t patternDrawButtonPanel_2[] = {
     0x0c000000, //     jal 	 DrawIcon
     0x24a5ffe4  //     addiu a1, a1, 0xffe4  # arg1 : X
 };
-static uint32_t patternDrawButtonPanel_2_mask[] = {0xffffff00, 0xff00ffff, 0xffff0000, 0xffffffff, 0xffffffff, //
+static const uint32_t patternDrawButtonPanel_2_mask[] = {0xffffff00, 0xff00ffff, 0xffff0000, 0xffffffff, 0xffffffff, //
                                                    0xffffffff, 0xfc000000, 0xffffffff};
-static uint32_t patternDrawButtonPanel_3[] = {
+static const uint32_t patternDrawButtonPanel_3[] = {
     // Search pattern in the draw_button_panel function:
     0x0040402d, //     daddu t0, v0, zero 	 # arg4 : pointer to string
     0x0200202d, //     daddu a0, s0, zero 	 # arg0 : X
@@ -100,11 +100,11 @@ static uint32_t patternDrawButtonPanel_3[] = {
     0x0c000000, //     jal 	 DrawNonSelectableItem
     0x02a0382d  //     daddu a3, s5, zero 	 # arg3 : alpha
 };
-static uint32_t patternDrawButtonPanel_3_mask[] = {0xffffffff, 0xffffffff, 0xffffff00, 0xff00ffff, 0xffff0000, //
+static const uint32_t patternDrawButtonPanel_3_mask[] = {0xffffffff, 0xffffffff, 0xffffff00, 0xff00ffff, 0xffff0000, //
                                                    0xfc000000, 0xffffffff};
 
 // Patterns for patching the ExecuteDisc function to override the disc launch handlers
-static uint32_t patternExecuteDisc[] = {
+static const uint32_t patternExecuteDisc[] = {
     // ExecuteDisc function
     0x27bdfff0, //    addiu	sp, sp, $fff0
     0x3c03001f, //    lui	v1, $001f
@@ -119,9 +119,9 @@ static uint32_t patternExecuteDisc[] = {
     0x3c030000, //    lui	v1, xxxx
     0x24630000  //    addiu	v1, v1, xxxx
 };
-static uint32_t patternExecuteDisc_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, //
+static const uint32_t patternExecuteDisc_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, //
                                              0xffffff00, 0x00000000, 0xffffffff, 0xffffffff, 0xffffff00, 0xffff0000};
-static uint32_t patternExecuteDiscProto[] = {
+static const uint32_t patternExecuteDiscProto[] = {
     // ExecuteDisc function on protokernel
     0x27bdfff0, //    addiu	sp, sp, $fff0
     0x8c430000, //    lw	v1, $XXXX(v0)
@@ -134,11 +134,11 @@ static uint32_t patternExecuteDiscProto[] = {
     0x00031880, //	  sll	v1, v1, 2
     0x24420000  //    addiu	v0, v0, xxxx
 };
-static uint32_t patternExecuteDiscProto_mask[] = {0xffffffff, 0xffff0000, 0xffffffff, 0xffff0000, 0xffffffff, //
+static const uint32_t patternExecuteDiscProto_mask[] = {0xffffffff, 0xffff0000, 0xffffffff, 0xffff0000, 0xffffffff, //
                                                   0xffffffff, 0xffff0000, 0xffff0000, 0xffffffff, 0xffff0000};
 
 // Patterns for patching the disc detection to bypass automatic disc launch
-static uint32_t patternDetectDisc_1[] = {
+static const uint32_t patternDetectDisc_1[] = {
     // Code around main menu disc detection part1
     0xac220cec, //    sw	v0, $0cec(at)
     0x0c000000, //    jal	xxxx
@@ -153,9 +153,9 @@ static uint32_t patternDetectDisc_1[] = {
     0x10000000, //    beq	zero, zero, xxxx
     0x26420000  //    addiu	v0, s2, $xxxx
 };
-static uint32_t patternDetectDisc_1_mask[] = {0xffffffff, 0xfc000000, 0xffffffff, 0xfc000000, 0xffffffff, 0xffffffff, //
+static const uint32_t patternDetectDisc_1_mask[] = {0xffffffff, 0xfc000000, 0xffffffff, 0xfc000000, 0xffffffff, 0xffffffff, //
                                               0xffff0000, 0xffffffff, 0xfc000000, 0xffffffff, 0xffff0000, 0xffff0000};
-static uint32_t patternDetectDisc_2[] = {
+static const uint32_t patternDetectDisc_2[] = {
     // Code around main menu disc detection part2
     0x3c02001f, //    lui	v0, $001f
     0x24030003, //    li	v1, 3
@@ -167,19 +167,19 @@ static uint32_t patternDetectDisc_2[] = {
     0xae0205e4, //    sw	v0, $05e4(s0)
     0x0c000000  //    jal	WaitVblankStart?
 };
-static uint32_t patternDetectDisc_2_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+static const uint32_t patternDetectDisc_2_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
                                               0xffffffff, 0xffffffff, 0xffffffff, 0xfc000000};
 
 // Pattern for patching the menu scrolling behavior
-static uint32_t patternMenuLoop[] = {0x30621000, 0x10400007, 0x2604ffe8, 0x8c830010, 0x2462ffff, 0x0441000e, 0xac820010};
-static uint32_t patternMenuLoop_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+static const uint32_t patternMenuLoop[] = {0x30621000, 0x10400007, 0x2604ffe8, 0x8c830010, 0x2462ffff, 0x0441000e, 0xac820010};
+static const uint32_t patternMenuLoop_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
 
 // Pattern for patching the OSDSYS video mode
-static uint32_t patternVideoMode[] = {0xffbf0000, 0x0c000000, 0x00000000, 0x38420002, 0xdfbf0000, 0x2c420001};
-static uint32_t patternVideoMode_mask[] = {0xffffffff, 0xfc000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+static const uint32_t patternVideoMode[] = {0xffbf0000, 0x0c000000, 0x00000000, 0x38420002, 0xdfbf0000, 0x2c420001};
+static const uint32_t patternVideoMode_mask[] = {0xffffffff, 0xfc000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
 
 // Pattern for patching update loading to bypass HDD init
-static uint32_t patternHDDLoad[] = {
+static const uint32_t patternHDDLoad[] = {
     // Code near MC Update & HDD load for early ROMs not supporting SkipHdd argument
     0x0c000000, // jal 	 CheckMcUpdate
     0x0220282d, // daddu a1, s1, zero
@@ -190,14 +190,14 @@ static uint32_t patternHDDLoad[] = {
     0x0000302d, // daduu a2, zero, zero		#arg2: 0
     0x04400000  // bltz  v0, Exit_HddLoad
 };
-static uint32_t patternHDDLoad_mask[] = {0xfc000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xffff0000, 0xfc000000, 0xffffffff, 0xffff0000};
+static const uint32_t patternHDDLoad_mask[] = {0xfc000000, 0xffffffff, 0xffffffff, 0xffffffff, 0xffff0000, 0xfc000000, 0xffffffff, 0xffff0000};
 
 //
 // The following patterns are introduced in FMCB 1.9 and found by reverse-engineering the FMCB 1.9 code
 //
 
 // Pattern for patching the draw functions for selected/unselected items
-static uint32_t patternDrawMenuItem_Proto[] = {
+static const uint32_t patternDrawMenuItem_Proto[] = {
     0x240401ae, // addiu a0,zero,0x01AE
     0x0220282d, // daddu a1,s1,zero
     0x24060000, // addiu a2,zero,0x0000
@@ -205,28 +205,28 @@ static uint32_t patternDrawMenuItem_Proto[] = {
     0x0c180f26, // jal   DrawNonSelectableItem
     0x0280382d, // daddu a3,s4,zero
 };
-static uint32_t patternDrawMenuItem_Proto_mask[] = {0xffffffff, 0xffffffff, 0xfc1f0000, 0xffffffff, 0xffffffff, 0xffffffff};
+static const uint32_t patternDrawMenuItem_Proto_mask[] = {0xffffffff, 0xffffffff, 0xfc1f0000, 0xffffffff, 0xffffffff, 0xffffffff};
 
 // Pattern for finding OSD menu info struct
-static uint32_t patternMenuInfo_Proto[] = {
+static const uint32_t patternMenuInfo_Proto[] = {
     0x00000000, // pointer to osdmenu
     0x00000002, // number of entries
     0x00000003, // unknown
     0x00000000, // current selection
 };
-static uint32_t patternMenuInfo_Proto_mask[] = {0xff800000, 0xffffffff, 0xffffffff, 0xffffffff};
+static const uint32_t patternMenuInfo_Proto_mask[] = {0xff800000, 0xffffffff, 0xffffffff, 0xffffffff};
 
 // Patterns for patching the draw functions for bottom button prompts
-static uint32_t patternDrawButtonPanel_2_Proto[] = {
+static const uint32_t patternDrawButtonPanel_2_Proto[] = {
     0x0280302d, // daddu a2,s4,zero
     0x8e640000, // lw    a0,0x0000,s3
     0x8e450000, // lw    a1,0x0000,s2
     0x0c000000, // jal 	 DrawIcon
     0x02a0382d, // daddu a3,s5,zero
 };
-static uint32_t patternDrawButtonPanel_2_Proto_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff};
+static const uint32_t patternDrawButtonPanel_2_Proto_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff};
 
-static uint32_t patternDrawButtonPanel_3_Proto[] = {
+static const uint32_t patternDrawButtonPanel_3_Proto[] = {
     0x8e440000, // lw    a0,0x0000,s2
     0x0280282d, // daddu a1,s4,zero
     0x26e6f480, // addiu a2,s7,0xF480
@@ -235,9 +235,9 @@ static uint32_t patternDrawButtonPanel_3_Proto[] = {
     0x0c000000, // jal   DrawNonSelectableItem
     0x0220402d, // daddu t0,s1,zero
 };
-static uint32_t patternDrawButtonPanel_3_Proto_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff};
+static const uint32_t patternDrawButtonPanel_3_Proto_mask[] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xfc000000, 0xffffffff};
 
 // Pattern for patching the menu scrolling behavior. Uses patternMenuLoop_mask.
-static uint32_t patternMenuLoop_Proto[] = {0x30621000, 0x10400007, 0x2604ffe4, 0x8c830014, 0x2462ffff, 0x0441000e, 0xac820014};
+static const uint32_t patternMenuLoop_Proto[] = {0x30621000, 0x10400007, 0x2604ffe4, 0x8c830014, 0x2462ffff, 0x0441000e, 0xac820014};
 
 #endif
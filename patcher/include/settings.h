@@ -2,11 +2,14 @@
 #define _SETTINGS_H_
 
 #include "gs.h"
+#include "handoff.h"
 #include <stdint.h>
 
 #define CUSTOM_ITEMS 250 // Max number of items in custom menu
 #define NAME_LEN 80      // Max menu item length (incl. the string terminator)
 
+#define MENU_FOLDER_PREFIX '>' // Menu items with names starting with this character are folders
+
 typedef enum {
   FLAG_CUSTOM_MENU = (1 << 0),      // Apply menu patches
   FLAG_SKIP_DISC = (1 << 1),        // Disable disc autolaunch
@@ -17,6 +20,11 @@ typedef enum {
   FLAG_DISABLE_GAMEID = (1 << 6),   // Disable PixelFX game ID
   FLAG_USE_DKWDRV = (1 << 7),       // Use DKWDRV for PS1 discs
   FLAG_BROWSER_LAUNCHER = (1 << 8), // Apply patches for launching applications from the Browser
+  FLAG_SORT_BY_FREQUENCY = (1 << 9), // Sort menu items by launch count
+  FLAG_SORT_BY_RECENCY = (1 << 10),  // Sort menu items by last launch time
+  FLAG_SELECT_LAST_ITEM = (1 << 11), // Preselect the last launched menu item
+  FLAG_RELOAD_ITEM = (1 << 12),      // Add the settings reload entry to the menu
+  FLAG_LOADER_FULL_WIPE = (1 << 13), // Clear all user memory before starting the ELF
 } PatcherFlags;
 
 // Patcher settings struct, contains all configurable patch settings and menu items
@@ -31,17 +39,21 @@ typedef struct {
   int versionY;                              // "Version" button Y coordinate (at main OSDSYS menu)
   int cursorMaxVelocity;                     // The cursors movement amplitude, only for scroll menu
   int cursorAcceleration;                    // The cursors speed, only for scroll menu
+  int scrollDuration;                        // Menu scrolling animation duration in milliseconds, only for scroll menu
   int displayedItems;                        // The number of menu items displayed, only for scroll menu
   int menuItemIdx[CUSTOM_ITEMS];             // Item index in the config file
+  int16_t menuItemParent[CUSTOM_ITEMS];      // Parent folder position in menuItemName, -1 for top-level items
   int menuItemCount;                         // Total number of valid menu items
+  int initialItem;                           // Menu item selected on boot
   uint16_t patcherFlags;                     // Patcher options
   char leftCursor[20];                       // The left cursor text, only for scroll menu
   char rightCursor[20];                      // The right cursor text, only for scroll menu
   char menuDelimiterTop[NAME_LEN];           // The top menu delimiter text, only for scroll menu
   char menuDelimiterBottom[NAME_LEN];        // The bottom menu delimiter text, only for scroll menu
-  char menuItemName[CUSTOM_ITEMS][NAME_LEN]; // Menu items text
+  char *menuItemName[CUSTOM_ITEMS];          // Menu items text, points into the string pool
   char launcherPath[50];                     // Path to launcher ELF
   char dkwdrvPath[50];                       // Path to DKWDRV
+  char ipconfigPath[50];                     // Path to IPCONFIG.DAT, empty if the file doesn't exist
   char romver[15];                           // ROMVER string, initialized before patching
   uint8_t mcSlot;                            // Memory card slot contaning currently loaded OSDMENU.CNF
   GSVideoMode videoMode;                     // OSDSYS Video mode (0 for auto)
@@ -52,5 +64,8 @@ extern PatcherSettings settings;
 
 int loadConfig(void);
 void initConfig(void);
+// Adds paths and arguments of the config file item captured by loadConfig to the handoff block.
+// Returns the number of item paths or a negative number on error
+int loadItemHandoff(int itemIdx, handoffHeader *handoff, uint32_t maxSize);
 
 #endif
@@ -0,0 +1,81 @@
+#include "animation.h"
+
+// Ease-out cubic curve sampled at 256 points, scaled to 1 << ANIM_CURVE_SHIFT
+static uint16_t easeCurve[257];
+static uint32_t durationStep = 1; // Easing duration / 256, in ticks
+static uint32_t lastCount = 0;
+
+// Skip frames longer than this (e.g. the first frame or OSDSYS loading something)
+#define ANIM_MAX_FRAME_TIME (ANIM_TICKS_PER_STEP * 4)
+
+// Precomputes the easing curve and sets the easing duration
+void animInit(int durationMs) {
+  for (int i = 0; i <= 256; i++) {
+    uint32_t q = 256 - i;
+    easeCurve[i] = (1 << ANIM_CURVE_SHIFT) - ((q * q * q) >> (24 - ANIM_CURVE_SHIFT)); // 1 - (1 - t)^3
+  }
+
+  if (durationMs < 1)
+    durationMs = 1;
+  if (durationMs > 10000)
+    durationMs = 10000;
+  durationStep = ((uint32_t)durationMs * ANIM_TICKS_PER_MS) >> 8;
+
+  lastCount = readCount();
+}
+
+// Returns the number of ticks elapsed since the previous call
+uint32_t animFrameTime() {
+  uint32_t count = readCount();
+  uint32_t dt = count - lastCount; // Wraps around correctly
+  lastCount = count;
+  if (dt > ANIM_MAX_FRAME_TIME)
+    dt = ANIM_TICKS_PER_STEP;
+  return dt;
+}
+
+// Immediately sets the animated value
+void animJump(animEasing *anim, int value) {
+  anim->from = value;
+  anim->to = value;
+  anim->value = value;
+  anim->elapsed = durationStep << 8;
+}
+
+// Restarts the animation from the current value if the target has changed
+void animSetTarget(animEasing *anim, int to) {
+  if (anim->to == to)
+    return;
+
+  anim->from = anim->value;
+  anim->to = to;
+  anim->elapsed = 0;
+}
+
+// Advances the animation by dt ticks and returns the current value
+int animUpdate(animEasing *anim, uint32_t dt) {
+  uint32_t idx;
+
+  anim->elapsed += dt;
+  idx = anim->elapsed / durationStep;
+  if (idx >= 256) {
+    anim->elapsed = durationStep << 8;
+    anim->value = anim->to;
+    return anim->value;
+  }
+
+  anim->value = anim->from + (((anim->to - anim->from) * (int)easeCurve[idx]) >> ANIM_CURVE_SHIFT);
+  return anim->value;
+}
+
+// Advances the step accumulator by dt ticks and returns the number of whole 60 Hz steps to run
+int animSteps(uint32_t *accumulator, uint32_t dt) {
+  int steps = 0;
+
+  *accumulator += dt;
+  while (*accumulator >= ANIM_TICKS_PER_STEP) {
+    *accumulator -= ANIM_TICKS_PER_STEP;
+    steps++;
+  }
+  return steps;
+}
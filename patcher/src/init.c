@@ -1,3 +1,7 @@
+#include "defaults.h"
+#include "init.h"
+#include "settings.h"
+#include "trace.h"
 #include <fcntl.h>
 #include <iopcontrol.h>
 #include <iopheap.h>
@@ -5,9 +9,49 @@
 #include <loadfile.h>
 #include <sbv_patches.h>
 #include <sifrpc.h>
+#include <stddef.h>
 #define NEWLIB_PORT_AWARE
 #include <fileio.h>
 
+// Image boundaries, see linkfile
+extern char _end[];
+extern char _boot_start[];
+extern char _boot_end[];
+
+// Heap break above the image and in the reclaimed .boot section
+static char *heapBreak = _end;
+static char *bootBreak = _boot_end;
+static int bootMemoryReclaimed = 0;
+
+// Replaces the libcglue sbrk. Once the .boot section is reclaimed, the heap is extended into it
+// until a request no longer fits, then the heap grows from the break above the image again
+void *_sbrk(ptrdiff_t incr) {
+  char *ptr;
+  if (bootBreak < _boot_end) {
+    if (bootBreak + incr <= _boot_end) {
+      ptr = bootBreak;
+      bootBreak += incr;
+      return ptr;
+    }
+    bootBreak = _boot_end;
+  }
+
+  if (heapBreak + incr > (char *)EndOfHeap())
+    return (void *)-1;
+  ptr = heapBreak;
+  heapBreak += incr;
+  return ptr;
+}
+
+// Hands the .boot section over to the heap.
+// Only the first call reclaims the section, later launches may already have allocated from it
+void reclaimBootMemory(void) {
+  if (bootMemoryReclaimed)
+    return;
+  bootMemoryReclaimed = 1;
+  bootBreak = _boot_start;
+}
+
 // Wipes user memory
 void wipeUserMem(void) {
   for (int i = 0x100000; i < 0x02000000; i += 64) {
@@ -64,3 +108,22 @@ void resetModules(void) {
   FlushCache(2);
   fioInit();
 }
+
+#ifdef ENABLE_TRACE
+// Writes recorded trace events to the memory card. Truncates the trace file unless append is set
+void flushTrace(int append) {
+  char tracePath[] = TRACE_PATH;
+  int size;
+  void *block = traceDump(0, &size);
+
+  tracePath[2] = '0' + settings.mcSlot;
+  int fd = fioOpen(tracePath, FIO_O_WRONLY | FIO_O_CREAT | (append ? FIO_O_APPEND : FIO_O_TRUNC));
+  if (fd < 0)
+    return;
+
+  if (append)
+    fioLseek(fd, 0, FIO_SEEK_END);
+  fioWrite(fd, block, size);
+  fioClose(fd);
+}
+#endif
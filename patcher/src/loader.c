@@ -1,16 +1,95 @@
+#include "defaults.h"
 #include "init.h"
 #include "patches_common.h"
 #include "patches_osdmenu.h"
 #include "settings.h"
 #include "splash.h"
+#include "trace.h"
 #include <kernel.h>
 #include <loadfile.h>
 #include <malloc.h>
 #include <sifrpc.h>
+#include <stdlib.h>
 #include <string.h>
+#define NEWLIB_PORT_AWARE
+#include <fileio.h>
 
-// Executes selected item by passing it to the launcher
-void launchItem(char *item) {
+// Tries to open the file on both memory cards and updates the memory card number in path.
+// mc? paths start from the memory card containing OSDMENU.CNF
+static int findOnMemoryCards(char *path) {
+  if (strncmp(path, "mc", 2))
+    return -1;
+
+  if (path[2] == '?')
+    path[2] = '0' + settings.mcSlot;
+
+  int fd;
+  for (int i = 0; i < 2; i++) {
+    if ((fd = fioOpen(path, FIO_O_RDONLY)) >= 0) {
+      fioClose(fd);
+      return 0;
+    }
+    // If the file doesn't exist, try the other slot
+    path[2] = (path[2] == '1') ? '0' : '1';
+  }
+  return -1;
+}
+
+// Tries to open launcher ELF on both memory cards
+int probeLauncher() { return findOnMemoryCards(settings.launcherPath); }
+
+// Finds DKWDRV and IPCONFIG.DAT on memory cards so the launcher doesn't have to probe both cards
+void resolveFilePaths() {
+  if (settings.patcherFlags & FLAG_USE_DKWDRV) {
+    if (settings.dkwdrvPath[0] == '\0')
+      strcpy(settings.dkwdrvPath, DKWDRV_PATH);
+    findOnMemoryCards(settings.dkwdrvPath); // The launcher will report the error if DKWDRV is missing
+  }
+
+  strcpy(settings.ipconfigPath, IPCONFIG_PATH);
+  if (findOnMemoryCards(settings.ipconfigPath))
+    settings.ipconfigPath[0] = '\0';
+}
+
+// Builds "-name=value" launcher argument
+static char *buildArgument(const char *name, const char *value) {
+  char *arg = malloc(strlen(name) + strlen(value) + 3);
+  arg[0] = '-';
+  strcpy(&arg[1], name);
+  strcat(arg, "=");
+  strcat(arg, value);
+  return arg;
+}
+
+// Stores the paths, arguments and CDROM options of the OSDMENU.CNF item captured by loadConfig
+// so the launcher doesn't have to parse the config file again
+static void writeHandoff(char *item) {
+  handoffHeader *handoff = (handoffHeader *)HANDOFF_ADDRESS;
+  handoff->magic = 0;
+
+  char *idx = strchr(item, ':');
+  if (!idx)
+    return;
+
+  uint8_t flags = 0;
+  if (settings.patcherFlags & FLAG_SKIP_PS2_LOGO)
+    flags |= HANDOFF_FLAG_SKIP_PS2_LOGO;
+  if (settings.patcherFlags & FLAG_DISABLE_GAMEID)
+    flags |= HANDOFF_FLAG_DISABLE_GAMEID;
+  if (settings.patcherFlags & FLAG_USE_DKWDRV)
+    flags |= HANDOFF_FLAG_USE_DKWDRV;
+
+  handoffInit(handoff, atoi(++idx), settings.mcSlot, flags);
+  if ((settings.patcherFlags & FLAG_USE_DKWDRV) && handoffAddString(handoff, HANDOFF_MAX_SIZE, HANDOFF_DKWDRV, settings.dkwdrvPath))
+    return;
+
+  // Leave the block invalid if the item has no paths, the launcher will report the error
+  if (loadItemHandoff(handoff->itemIdx, handoff, HANDOFF_MAX_SIZE) > 0)
+    handoffSeal(handoff);
+}
+
+// Stops OSDSYS and reinitializes EE and IOP
+static void shutdownOSDSYS() {
   DisableIntc(3);
   DisableIntc(2);
 
@@ -37,38 +116,46 @@ void launchItem(char *item) {
 
   // Reinitialize IOP to a known state
   initModules();
+}
+
+// Executes selected item by passing it to the launcher
+void launchItem(char *item) {
+  TRACE_BEGIN(TRACE_LAUNCH_ITEM, 0);
+  shutdownOSDSYS();
   SifLoadModule("rom0:CLEARSPU", 0, 0);
 
+  TRACE_END(TRACE_LAUNCH_ITEM, 0);
+#ifdef ENABLE_TRACE
+  flushTrace(1);
+#endif
+
   FlushCache(0);
   FlushCache(2);
 
   // Build argv for the launcher
-  char **argv;
-  int argc;
-  if (strcmp(item, "cdrom")) {
-    argv = malloc(2 * sizeof(char *));
-    argv[0] = settings.launcherPath;
-    argv[1] = strdup(item);
-    argc = 2;
-  } else {
+  char **argv = malloc(6 * sizeof(char *));
+  int argc = 0;
+  argv[argc++] = settings.launcherPath;
+  argv[argc++] = strdup(item);
+  if (settings.patcherFlags & FLAG_LOADER_FULL_WIPE)
+    argv[argc++] = "-fullwipe"; // Must directly follow the item, the launcher removes it before handling the item
+  int isFMCB = !strncmp(item, "fmcb", 4);
+  if (!strcmp(item, "cdrom")) {
     // Handle CDROM
-    argv = malloc(5 * sizeof(char *));
-    argv[0] = settings.launcherPath;
-    argv[1] = strdup(item);
-    argv[2] = (settings.patcherFlags & FLAG_SKIP_PS2_LOGO) ? "-nologo" : "";
-    argv[3] = (!(settings.patcherFlags & FLAG_DISABLE_GAMEID)) ? "" : "-nogameid";
-    argc = 4;
-    if (settings.patcherFlags & FLAG_USE_DKWDRV) {
-      if (settings.dkwdrvPath[0] == '\0')
-        argv[4] = "-dkwdrv";
-      else {
-        argv[4] = malloc(sizeof("-dkwdrv") + strlen(settings.dkwdrvPath) + 1);
-        strcat(argv[4], "-dkwdrv=");
-        strcat(argv[4], settings.dkwdrvPath);
-      }
-      argc++;
-    }
-  }
+    if (settings.patcherFlags & FLAG_SKIP_PS2_LOGO)
+      argv[argc++] = "-nologo";
+    if (settings.patcherFlags & FLAG_DISABLE_GAMEID)
+      argv[argc++] = "-nogameid";
+  } else if (isFMCB && (settings.ipconfigPath[0] != '\0'))
+    argv[argc++] = buildArgument("ipconfig", settings.ipconfigPath);
+
+  // Pass paths resolved by resolveFilePaths.
+  // Other items are launched with their arguments as-is
+  if ((isFMCB || !strcmp(item, "cdrom")) && (settings.patcherFlags & FLAG_USE_DKWDRV))
+    argv[argc++] = buildArgument("dkwdrv", settings.dkwdrvPath);
+
+  if (isFMCB)
+    writeHandoff(item);
 
   static t_ExecData elfdata;
   elfdata.epc = 0;
@@ -87,3 +174,23 @@ void launchItem(char *item) {
 
 // Uses the launcher to run the disc
 void launchDisc() { launchItem("cdrom"); }
+
+// Reloads the config file and restarts OSDSYS with the new settings
+void reloadOSDSYS() {
+  shutdownOSDSYS();
+
+  // Start from the memory card the current config was loaded from, as main does with the boot card
+  uint8_t mcSlot = settings.mcSlot;
+  initConfig();
+  settings.mcSlot = mcSlot;
+  if (loadConfig() || probeLauncher())
+    Exit(-1);
+  resolveFilePaths();
+
+  // Reload the list of known apps for the browser application launch patch
+  if (settings.patcherFlags & FLAG_BROWSER_LAUNCHER)
+    loadAppIndex();
+
+  startOSDSYS();
+  Exit(-1);
+}
@@ -1,14 +1,15 @@
 #include "gs.h"
 #include "init.h"
+#include "loader.h"
 #include "patches_common.h"
+#include "patches_osdmenu.h"
 #include "settings.h"
 #include "splash.h"
+#include "trace.h"
 #include <kernel.h>
 #include <ps2sdkapi.h>
 #include <stdlib.h>
 #include <string.h>
-#define NEWLIB_PORT_AWARE
-#include <fileio.h>
 
 // Reduce binary size by disabling the unneeded functionality
 void _libcglue_init() {}
@@ -18,31 +19,9 @@ DISABLE_PATCHED_FUNCTIONS();
 DISABLE_EXTRA_TIMERS_FUNCTIONS();
 PS2_DISABLE_AUTOSTART_PTHREAD();
 
-// Tries to open launcher ELF on both memory cards
-int probeLauncher() {
-  if (settings.launcherPath[2] == '?') {
-    if (settings.mcSlot == 1)
-      settings.launcherPath[2] = '1';
-    else
-      settings.launcherPath[2] = '0';
-  }
+BOOT_CODE int main(int argc, char *argv[]) {
+  TRACE_BEGIN(TRACE_PATCHER_MAIN, 0);
 
-  int fd = fioOpen(settings.launcherPath, FIO_O_RDONLY);
-  if (fd < 0) {
-    // If ELF doesn't exist on boot MC, try the other slot
-    if (settings.launcherPath[2] == '1')
-      settings.launcherPath[2] = '0';
-    else
-      settings.launcherPath[2] = '1';
-    if ((fd = fioOpen(settings.launcherPath, FIO_O_RDONLY)) < 0)
-      return -1;
-  }
-  fioClose(fd);
-
-  return 0;
-}
-
-int main(int argc, char *argv[]) {
   // Clear memory
   wipeUserMem();
 
@@ -59,12 +38,21 @@ int main(int argc, char *argv[]) {
     settings.mcSlot = 1;
 
   // Read config before to check args for an elf to load
+  TRACE_BEGIN(TRACE_LOAD_CONFIG, 0);
   loadConfig();
+  TRACE_END(TRACE_LOAD_CONFIG, 0);
 
   // Make sure launcher is accessible
   if (probeLauncher())
     Exit(-1);
 
+  // Resolve the locations of other files used by the launcher
+  resolveFilePaths();
+
+  // Load the list of known apps for the browser application launch patch
+  if (settings.patcherFlags & FLAG_BROWSER_LAUNCHER)
+    loadAppIndex();
+
 #ifdef ENABLE_SPLASH
   GSVideoMode vmode = GS_MODE_NTSC; // Use NTSC by default
 
@@ -76,16 +64,11 @@ int main(int argc, char *argv[]) {
   } else if (settings.videoMode == GS_MODE_PAL)
     vmode = GS_MODE_PAL;
 
+  TRACE_BEGIN(TRACE_SPLASH, 0);
   gsDisplaySplash(vmode);
+  TRACE_END(TRACE_SPLASH, 0);
 #endif
 
-  int fd = fioOpen("rom0:MBROWS", FIO_O_RDONLY);
-  if (fd >= 0) {
-    // MBROWS exists only on protokernel systems
-    fioClose(fd);
-    launchProtokernelOSDSYS();
-  } else
-    launchOSDSYS();
-
+  startOSDSYS();
   Exit(-1);
 }
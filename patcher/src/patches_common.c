@@ -1,78 +1,250 @@
 #include "init.h"
 #include "loader.h"
+#include "patches_common.h"
 #include "patches_fmcb.h"
 #include "patches_osdmenu.h"
 #include "patterns_common.h"
+#include "patterns_fmcb.h"
+#include "patterns_osdmenu.h"
 #include "settings.h"
+#include "trace.h"
 #include <kernel.h>
 #include <loadfile.h>
 #include <stdlib.h>
 #include <string.h>
+#define NEWLIB_PORT_AWARE
+#include <fileio.h>
 
 // OSDSYS deinit function
 static void (*osdsysDeinit)(uint32_t flags) = NULL;
 
-// Searches for byte pattern in memory
-uint8_t *findPatternWithMask(uint8_t *buf, uint32_t bufsize, uint8_t *bytes, uint8_t *mask, uint32_t len) {
-  uint32_t i, j;
+// ROM families the patch applies to
+#define ROM_FAMILY_OSDSYS (1 << 0)      // OSDSYS on ROMs >= 1.10
+#define ROM_FAMILY_PROTOKERNEL (1 << 1) // Protokernel OSDSYS
+
+// Patch table entry
+typedef struct {
+  const uint32_t *pattern; // Pattern locating the patch site
+  const uint32_t *mask;    // Pattern mask
+  uint16_t patternSize;    // Pattern size in bytes
+  uint8_t romFamily;       // ROM families the patch applies to
+  int8_t dependsOn;        // Patch that must be successfully applied first or -1
+  uint32_t searchOffset;   // Search range start relative to the OSDSYS address
+  uint32_t searchSize;     // Search range size
+  uint16_t requiredFlags;  // Patch is applied only if any of these flags is set in settings.patcherFlags. 0 to always apply
+  int (*isNeeded)(void);   // Returns 0 if the patch doesn't apply to the current settings or ROM. NULL to always apply
+  int (*apply)(uint8_t *osd);
+} patchDescriptor;
+
+#define PATTERN(name) name, name##_mask, sizeof(name)
+
+// Set if the ROM supports SkipHdd argument
+static int romSupportsSkipHdd = 0;
+
+static int isVideoModeForced(void) { return settings.videoMode != 0; }
+
+static int isDTVModeSelected(void) { return settings.videoMode >= GS_MODE_DTV_480P; }
+
+// Skip HDD patch is needed only for ROMs that don't support SkipHdd argument
+static int isSkipHDDNeeded(void) { return !romSupportsSkipHdd; }
+
+// 480p and 1080i modes are output as NTSC
+static int applyVideoMode(uint8_t *osd) { return patchVideoMode(osd, (settings.videoMode == GS_MODE_PAL) ? GS_MODE_PAL : GS_MODE_NTSC); }
+
+static int applyGSVideoMode(uint8_t *osd) { return patchGSVideoMode(osd, settings.videoMode); }
+
+static int applyInfiniteScrolling(uint8_t *osd) { return patchMenuInfiniteScrolling(osd, 0); }
+
+static int applyBrowserLauncher(uint8_t *osd) { return patchBrowserApplicationLaunch(osd, 0); }
+
+static int applyGSVideoModeProtokernel(uint8_t *osd) { return patchGSVideoModeProtokernel(osd, settings.videoMode); }
+
+static int applyInfiniteScrollingProtokernel(uint8_t *osd) { return patchMenuInfiniteScrolling(osd, 1); }
+
+static int applyBrowserLauncherProtokernel(uint8_t *osd) { return patchBrowserApplicationLaunch(osd, 1); }
+
+// Patch table. Patches are applied in the table order once the patch they depend on is applied
+static const patchDescriptor patches[PATCH_COUNT] = {
+    [PATCH_MENU] = {PATTERN(patternMenuInfo), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, FLAG_CUSTOM_MENU, NULL, patchMenu},
+    [PATCH_MENU_DRAW] = {PATTERN(patternDrawMenuItem), ROM_FAMILY_OSDSYS, PATCH_MENU, 0, 0x100000, FLAG_CUSTOM_MENU, NULL, patchMenuDraw},
+    [PATCH_INFINITE_SCROLLING] = {PATTERN(patternMenuLoop), ROM_FAMILY_OSDSYS, PATCH_MENU, 0, 0x100000, FLAG_CUSTOM_MENU, NULL, applyInfiniteScrolling},
+    [PATCH_BUTTON_PANEL] = {PATTERN(patternDrawButtonPanel_1), ROM_FAMILY_OSDSYS, PATCH_MENU, 0, 0x100000, FLAG_CUSTOM_MENU, NULL,
+                            patchMenuButtonPanel},
+    [PATCH_BROWSER_LAUNCHER] = {PATTERN(patternBrowserFileMenuInit), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, FLAG_BROWSER_LAUNCHER, NULL,
+                                applyBrowserLauncher},
+    [PATCH_VERSION_INFO] = {PATTERN(patternVersionInit), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, 0, NULL, patchVersionInfo},
+    [PATCH_VIDEO_MODE] = {PATTERN(patternVideoMode), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, 0, isVideoModeForced, applyVideoMode},
+    [PATCH_SKIP_DISC] = {PATTERN(patternDetectDisc_1), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, FLAG_SKIP_DISC, NULL, patchSkipDisc},
+    [PATCH_SKIP_HDD] = {PATTERN(patternHDDLoad), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, 0, isSkipHDDNeeded, patchSkipHDD},
+    [PATCH_DISC_LAUNCH] = {PATTERN(patternExecuteDisc), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, 0, NULL, patchDiscLaunch},
+    [PATCH_GS_VIDEO_MODE] = {PATTERN(patternGsPutDispEnv), ROM_FAMILY_OSDSYS, -1, 0, 0x100000, 0, isDTVModeSelected, applyGSVideoMode},
+    // Protokernel menu code is located at 0x600000, browser code at 0x700000
+    [PATCH_MENU_PROTO] = {PATTERN(patternMenuInfo_Proto), ROM_FAMILY_PROTOKERNEL, -1, PROTOKERNEL_MENU_OFFSET, 0x100000, FLAG_CUSTOM_MENU, NULL,
+                          patchMenuProtokernel},
+    [PATCH_MENU_DRAW_PROTO] = {PATTERN(patternDrawMenuItem_Proto), ROM_FAMILY_PROTOKERNEL, PATCH_MENU_PROTO, PROTOKERNEL_MENU_OFFSET, 0x100000,
+                               FLAG_CUSTOM_MENU, NULL, patchMenuDrawProtokernel},
+    [PATCH_INFINITE_SCROLLING_PROTO] = {patternMenuLoop_Proto, patternMenuLoop_mask, sizeof(patternMenuLoop_Proto), ROM_FAMILY_PROTOKERNEL,
+                                        PATCH_MENU_PROTO, PROTOKERNEL_MENU_OFFSET, 0x100000, FLAG_CUSTOM_MENU, NULL,
+                                        applyInfiniteScrollingProtokernel},
+    [PATCH_BROWSER_LAUNCHER_PROTO] = {PATTERN(patternBrowserFileMenuInit), ROM_FAMILY_PROTOKERNEL, -1, PROTOKERNEL_MENU_OFFSET + 0x100000,
+                                      0x100000, FLAG_BROWSER_LAUNCHER, NULL, applyBrowserLauncherProtokernel},
+    [PATCH_VERSION_INFO_PROTO] = {PATTERN(patternVersionInit_Proto), ROM_FAMILY_PROTOKERNEL, -1, 0, 0x100000, 0, NULL,
+                                  patchVersionInfoProtokernel},
+    // sceGsPutDispEnv is also patched at 0x600000 and 0x700000
+    [PATCH_GS_VIDEO_MODE_PROTO] = {PATTERN(patternGsPutDispEnv), ROM_FAMILY_PROTOKERNEL, -1, 0x300000, 0x100000, 0, isDTVModeSelected,
+                                   applyGSVideoModeProtokernel},
+    [PATCH_DISC_LAUNCH_PROTO] = {PATTERN(patternExecuteDiscProto), ROM_FAMILY_PROTOKERNEL, -1, 0, 0x100000, 0, NULL, patchDiscLaunchProtokernel},
+};
+
+// Patch sites found by resolvePatchSites in the OSDSYS image at resolvedOSD
+static uint8_t *patchSites[PATCH_COUNT];
+static uint8_t *resolvedOSD = NULL;
+
+// Bitmaps of applied and failed patches, indexed by PatchID
+static uint32_t patchesApplied = 0;
+static uint32_t patchesFailed = 0;
+
+uint8_t *findPatchPattern(PatchID id, uint8_t *buf, uint32_t bufsize) {
+  return findPatternWithMask(buf, bufsize, (uint8_t *)patches[id].pattern, (uint8_t *)patches[id].mask, patches[id].patternSize);
+}
+
+uint8_t *findPatchSite(PatchID id, uint8_t *osd) {
+  if (osd == resolvedOSD)
+    return patchSites[id];
+  return findPatchPattern(id, osd + patches[id].searchOffset, patches[id].searchSize);
+}
 
-  for (i = 0; i < bufsize - len; i++) {
-    for (j = 0; j < len; j++) {
-      if ((buf[i + j] & mask[j]) != bytes[j])
-        break;
+// Finds the first match of every patch in the bitmap with a single pass over OSDSYS.
+// Matches the findPatternWithMask results for every patch search range
+static void resolvePatchSites(uint8_t *osd, uint32_t pending) {
+  const patchDescriptor *p;
+  uint8_t ids[PATCH_COUNT];
+  uint32_t off, start = 0xffffffff, end = 0, word, words, j;
+  int i, count = 0;
+
+  for (i = 0; i < PATCH_COUNT; i++) {
+    patchSites[i] = NULL;
+    if (!(pending & (1 << i)))
+      continue;
+    ids[count++] = i;
+    if (patches[i].searchOffset < start)
+      start = patches[i].searchOffset;
+    if (patches[i].searchOffset + patches[i].searchSize > end)
+      end = patches[i].searchOffset + patches[i].searchSize;
+  }
+
+  for (off = start; (off < end) && count; off += 4) {
+    word = _lw((uint32_t)osd + off);
+    for (i = 0; i < count; i++) {
+      p = &patches[ids[i]];
+      // Out of the search range, including offsets below it
+      if ((off - p->searchOffset) >= (p->searchSize - p->patternSize))
+        continue;
+      if ((word & p->mask[0]) != p->pattern[0])
+        continue;
+
+      words = p->patternSize >> 2;
+      for (j = 1; j < words; j++) {
+        if ((_lw((uint32_t)osd + off + j * 4) & p->mask[j]) != p->pattern[j])
+          break;
+      }
+      if (j < words)
+        continue;
+
+      // Found, stop searching for this patch
+      patchSites[ids[i]] = osd + off;
+      ids[i--] = ids[--count];
     }
-    if (j == len)
-      return &buf[i];
   }
-  return NULL;
+  resolvedOSD = osd;
 }
 
-// Searches for string in memory
-char *findString(const char *string, char *buf, uint32_t bufsize) {
-  uint32_t i;
-  const char *s, *p;
-
-  for (i = 0; i < bufsize; i++) {
-    s = string;
-    for (p = buf + i; *s && *s == *p; s++, p++)
-      ;
-    if (!*s)
-      return (buf + i);
+// Applies the patches of the ROM family and records the result of every patch.
+// Sites of all patches are found before any patch is applied
+static void applyPatches(uint8_t romFamily, uint8_t *osd) {
+  uint32_t active = 0, done = 0;
+  int i, res, dep, progress;
+
+  for (i = 0; i < PATCH_COUNT; i++) {
+    if (!(patches[i].romFamily & romFamily))
+      continue;
+    if (patches[i].requiredFlags && !(settings.patcherFlags & patches[i].requiredFlags))
+      continue;
+    if (patches[i].isNeeded && !patches[i].isNeeded())
+      continue;
+    active |= (1 << i);
   }
-  return NULL;
+
+  patchesApplied = patchesFailed = 0;
+  resolvePatchSites(osd, active);
+
+  // Inactive patches are done, patches depending on them fail
+  done = ~active;
+  do {
+    progress = 0;
+    for (i = 0; i < PATCH_COUNT; i++) {
+      dep = patches[i].dependsOn;
+      if ((done & (1 << i)) || ((dep >= 0) && !(done & (1 << dep))))
+        continue; // Wait for the dependency
+
+      done |= (1 << i);
+      progress = 1;
+      if (((dep >= 0) && !(patchesApplied & (1 << dep))) || !patchSites[i]) {
+        patchesFailed |= (1 << i);
+        continue;
+      }
+
+      res = patches[i].apply(osd);
+      if (!res)
+        patchesApplied |= (1 << i);
+      else if (res < 0)
+        patchesFailed |= (1 << i);
+    }
+  } while (progress);
+
+  // Patches with circular dependencies are never applied
+  patchesFailed |= active & ~done;
+  resolvedOSD = NULL;
 }
 
-// Applies patches and executes OSDSYS
-void patchExecuteOSDSYS(void *epc, void *gp) {
-  if (settings.patcherFlags & FLAG_CUSTOM_MENU) {
-    // If hacked OSDSYS is enabled, apply menu patch
-    patchMenu((uint8_t *)epc);
-    patchMenuDraw((uint8_t *)epc);
-    patchMenuInfiniteScrolling((uint8_t *)epc, 0);
-    patchMenuButtonPanel((uint8_t *)epc);
+static const char hexChars[] = "0123456789ABCDEF";
+// Returns the patch status string: "<applied>/<attempted>" followed by the bitmap of failed patches, if any
+char *getPatchStatus() {
+  static char status[16];
+  int applied = 0, attempted = 0;
+  for (int i = 0; i < PATCH_COUNT; i++) {
+    if (patchesApplied & (1 << i))
+      applied++;
+    if ((patchesApplied | patchesFailed) & (1 << i))
+      attempted++;
   }
 
-  // Apply browser application launch patch
-  if (settings.patcherFlags & FLAG_BROWSER_LAUNCHER)
-    patchBrowserApplicationLaunch((uint8_t *)epc, 0);
-
-  // Apply version menu patch
-  patchVersionInfo((uint8_t *)epc);
-
-  switch (settings.videoMode) {
-  case GS_MODE_PAL:
-    patchVideoMode((uint8_t *)epc, settings.videoMode);
-    break;
-  case GS_MODE_DTV_480P:
-  case GS_MODE_DTV_1080I:
-    patchGSVideoMode((uint8_t *)epc, settings.videoMode); // Apply 480p or 1080i patch
-  case GS_MODE_NTSC:
-    patchVideoMode((uint8_t *)epc, GS_MODE_NTSC); // Force NTSC
+  char *ptr = status;
+  if (applied >= 10)
+    *ptr++ = '0' + applied / 10;
+  *ptr++ = '0' + applied % 10;
+  *ptr++ = '/';
+  if (attempted >= 10)
+    *ptr++ = '0' + attempted / 10;
+  *ptr++ = '0' + attempted % 10;
+  if (patchesFailed) {
+    *ptr++ = ' ';
+    *ptr++ = '(';
+    for (int i = (PATCH_COUNT - 1) & ~3; i >= 0; i -= 4)
+      *ptr++ = hexChars[(patchesFailed >> i) & 0xf];
+    *ptr++ = ')';
   }
+  *ptr = '\0';
+  return status;
+}
 
-  // Apply skip disc patch
-  if (settings.patcherFlags & FLAG_SKIP_DISC)
-    patchSkipDisc((uint8_t *)epc);
+// Applies patches and executes OSDSYS
+void patchExecuteOSDSYS(void *epc, void *gp) {
+  TRACE_BEGIN(TRACE_PATCH_OSDSYS, 0);
+  // Check for the SkipHdd argument support before applying the Skip HDD patch
+  romSupportsSkipHdd = (findString("SkipHdd", (char *)epc, 0x100000) != NULL);
+
+  applyPatches(ROM_FAMILY_OSDSYS, (uint8_t *)epc);
 
   // Replace function calls with no-ops?
   // Not sure what it does, but leaving it here just in case
@@ -93,13 +265,8 @@ void patchExecuteOSDSYS(void *epc, void *gp) {
   if (findString("SkipMc", (char *)epc, 0x100000)) // Pass SkipMc argument
     args[n++] = "SkipMc";                          // Skip mc?:/BREXEC-SYSTEM/osdxxx.elf update on v5 and above
 
-  if (findString("SkipHdd", (char *)epc, 0x100000)) // Pass SkipHdd argument if the ROM supports it
-    args[n++] = "SkipHdd";                          // Skip HDDLOAD on v5 and above
-  else
-    patchSkipHDD((uint8_t *)epc); // Skip HDD patch for earlier ROMs
-
-  // Apply disc launch patch to forward disc launch to the launcher
-  patchDiscLaunch((uint8_t *)epc);
+  if (romSupportsSkipHdd)  // Pass SkipHdd argument if the ROM supports it
+    args[n++] = "SkipHdd"; // Skip HDDLOAD on v5 and above. Earlier ROMs get the Skip HDD patch
 
   // Mangle system update paths to prevent OSDSYS from loading system updates (for ROMs not supporting SkipMc)
   uint8_t *ptr;
@@ -112,6 +279,7 @@ void patchExecuteOSDSYS(void *epc, void *gp) {
   if (ptr)
     osdsysDeinit = (void *)ptr;
 
+  TRACE_END(TRACE_PATCH_OSDSYS, 0);
   FlushCache(0);
   FlushCache(2);
   ExecPS2(epc, gp, n, args);
@@ -136,7 +304,12 @@ void launchOSDSYS() {
     *(uint32_t *)&ptr[4] = 0;
   }
 
+  TRACE_END(TRACE_PATCHER_MAIN, 0);
+#ifdef ENABLE_TRACE
+  flushTrace(0);
+#endif
   resetModules();
+  reclaimBootMemory();
 
   // Execute the OSD unpacker. If the above patching was successful it will
   // call the patchExecuteOSDSYS() function after unpacking.
@@ -144,6 +317,17 @@ void launchOSDSYS() {
   Exit(-1);
 }
 
+// Launches regular or protokernel OSDSYS depending on the ROM
+void startOSDSYS() {
+  int fd = fioOpen("rom0:MBROWS", FIO_O_RDONLY);
+  if (fd >= 0) {
+    // MBROWS exists only on protokernel systems
+    fioClose(fd);
+    launchProtokernelOSDSYS();
+  } else
+    launchOSDSYS();
+}
+
 // Calls OSDSYS deinit function
 void deinitOSDSYS() {
   if (osdsysDeinit)
@@ -157,31 +341,10 @@ void deinitOSDSYS() {
 // Applies patches and executes OSDSYS
 static void *protoEPC;
 void applyProtokernelPatches() {
-  if (settings.patcherFlags & FLAG_CUSTOM_MENU) {
-    // If hacked OSDSYS is enabled, apply menu patch
-    patchMenuProtokernel((uint8_t *)protoEPC);
-    patchMenuDrawProtokernel((uint8_t *)protoEPC);
-    patchMenuInfiniteScrolling((uint8_t *)protoEPC, 1);
-  }
-
-  // Apply browser application launch patch
-  if (settings.patcherFlags & FLAG_BROWSER_LAUNCHER)
-    patchBrowserApplicationLaunch((uint8_t *)protoEPC, 1);
-
-  // Apply version menu patch
-  patchVersionInfoProtokernel((uint8_t *)protoEPC);
-
-  // Patch the video mode if required
-  switch (settings.videoMode) {
-  case GS_MODE_DTV_480P:
-  case GS_MODE_DTV_1080I:
-    patchGSVideoModeProtokernel((uint8_t *)protoEPC, settings.videoMode); // Apply 480p or 1080i patch
-  default:
-  }
-
-  // Apply disc launch patch to forward disc launch to the launcher
-  patchDiscLaunchProtokernel((uint8_t *)protoEPC);
+  TRACE_BEGIN(TRACE_PATCH_OSDSYS, 1);
+  applyPatches(ROM_FAMILY_PROTOKERNEL, (uint8_t *)protoEPC);
 
+  TRACE_END(TRACE_PATCH_OSDSYS, 1);
   FlushCache(0);
   FlushCache(2);
 }
@@ -220,7 +383,12 @@ void launchProtokernelOSDSYS() {
     args[n++] = "BootClock"; // Pass BootClock to skip OSDSYS intro
 
   // Execute OSDSYS
+  TRACE_END(TRACE_PATCHER_MAIN, 1);
+#ifdef ENABLE_TRACE
+  flushTrace(0);
+#endif
   resetModules();
+  reclaimBootMemory();
 
   FlushCache(0);
   FlushCache(2);
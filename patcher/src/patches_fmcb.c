@@ -1,6 +1,7 @@
 // FMCB 1.8 OSDSYS patches by Neme
 // FMCB 1.9 patches by sp193
 #include "patches_fmcb.h"
+#include "animation.h"
 #include "init.h"
 #include "loader.h"
 #include "patches_common.h"
@@ -12,11 +13,11 @@
 #include <stdlib.h>
 #include <string.h>
 
-static uint32_t osdMenu[4 + CUSTOM_ITEMS * 2];
+static uint32_t osdMenu[4 + (CUSTOM_ITEMS + 1) * 2];
 
 struct OSDMenuInfo {
   uint32_t unknown1;
-  uint32_t *menuPtr;
+  uint32_t menuPtr; // osdMenu address
   uint32_t entryCount;
   uint32_t unknown2;
   uint32_t currentEntry;
@@ -25,17 +26,102 @@ struct OSDMenuInfo {
 static struct OSDMenuInfo *menuInfo = NULL;
 #define OSD_MAGIC 0x39390000 // arbitrary number to identify added menu items
 
+// Special level item positions
+#define LEVEL_BACK_ITEM -1
+#define LEVEL_RELOAD_ITEM -2
+
+// Currently displayed folder
+static int16_t levelItems[CUSTOM_ITEMS + 1]; // Item positions in settings or one of the special positions
+static const char *levelNames[CUSTOM_ITEMS + 1]; // Item names, indexed by getStringPointer
+static int levelItemCount = 0;
+static int currentFolder = -1;
+static int isProtokernelMenu = 0;
+static const char backItemName[] = "..";
+static const char reloadItemName[] = "Reload settings";
+
+// Returns the name of the level item
+static const char *getLevelItemName(int pos) {
+  switch (pos) {
+  case LEVEL_BACK_ITEM:
+    return backItemName;
+  case LEVEL_RELOAD_ITEM:
+    return reloadItemName;
+  default:
+    return settings.menuItemName[pos];
+  }
+}
+
+// Fills the OSD menu with items from the folder and selects selectItem if it's in the folder.
+// Pass -1 as the folder to show top-level items
+static void buildMenuLevel(int folder, int selectItem) {
+  int i, n = 0, selected = -1;
+  const char *name;
+
+  if (folder >= 0)
+    levelItems[n++] = LEVEL_BACK_ITEM; // Add the "back" entry
+
+  for (i = 0; i < settings.menuItemCount; i++) {
+    if (settings.menuItemParent[i] != folder)
+      continue;
+    if (i == selectItem)
+      selected = n;
+    levelItems[n++] = i;
+  }
+
+  if ((folder < 0) && (settings.patcherFlags & FLAG_RELOAD_ITEM))
+    levelItems[n++] = LEVEL_RELOAD_ITEM; // Add the "reload" entry to the top level
+
+  for (i = 0; i < n; i++) {
+    name = getLevelItemName(levelItems[i]);
+    if (isProtokernelMenu) {
+      // Protokernels don't use the patched OSD string function
+      osdMenu[4 + i * 2] = (uint32_t)name;
+      osdMenu[5 + i * 2] = (uint32_t)name;
+    } else {
+      levelNames[i] = name;
+      osdMenu[4 + i * 2] = OSD_MAGIC + i;
+      osdMenu[5 + i * 2] = 0;
+    }
+  }
+
+  currentFolder = folder;
+  levelItemCount = n;
+  menuInfo->entryCount = 2 + n; // store number of menu items
+
+  if (selected < 0 && folder >= 0)
+    selected = (n > 1) ? 1 : 0; // Select the first item in the folder
+  if (selected >= 0)
+    menuInfo->currentEntry = 2 + selected;
+}
+
 // Handles custom menu entries
 int handleMenuEntry(int selected) {
   if (selected == 1)
     return 1;
 
-  if (selected >= 2 + settings.menuItemCount)
+  if (selected >= 2 + levelItemCount)
     return 0;
 
   if (selected - 2 >= 0) {
+    int pos = levelItems[selected - 2];
+    if (pos == LEVEL_BACK_ITEM) {
+      // Go back to the parent folder
+      buildMenuLevel(settings.menuItemParent[currentFolder], currentFolder);
+      return 0;
+    }
+    if (pos == LEVEL_RELOAD_ITEM) {
+      // Re-read the config file and restart OSDSYS
+      reloadOSDSYS();
+      return 0;
+    }
+    if (settings.menuItemName[pos][0] == MENU_FOLDER_PREFIX) {
+      // Open the folder
+      buildMenuLevel(pos, -1);
+      return 0;
+    }
+
     // Build 'fmcb<mc slot>:<idx>' string for the launcher
-    int idx = settings.menuItemIdx[selected - 2];
+    int idx = settings.menuItemIdx[pos];
 
     char *item = malloc(10 * sizeof(char));
     item[0] = 'f';
@@ -67,42 +153,41 @@ int handleMenuEntry(int selected) {
   return 0;
 }
 
-// Returns the pointer to OSD string
+// Returns the pointer to OSD string.
+// Custom entries are numbered by their position in the current level, so their names come straight from levelNames
 const char *getStringPointer(const char **strings, uint32_t index) {
   if ((index & 0xffff0000) == OSD_MAGIC)
-    return settings.menuItemName[index & 0xffff];
+    return levelNames[index & 0xffff];
 
   return strings[index];
 }
 
 // Patches OSD menu to include custom menu entries
-void patchMenu(uint8_t *osd) {
+int patchMenu(uint8_t *osd) {
   uint8_t *ptr;
-  uint32_t tmp, menuAddr, osdstrAddr, entryAddr, i;
-
-  // Try to find the menu info struct
-  for (tmp = 0; tmp < 0x100000; tmp = (uint32_t)(ptr - osd + 4)) {
-    ptr = findPatternWithMask(osd + tmp, 0x100000 - tmp, (uint8_t *)patternMenuInfo, (uint8_t *)patternMenuInfo_mask, sizeof(patternMenuInfo));
-    if (!ptr)
-      return;
+  uint32_t tmp, menuAddr, osdstrAddr, entryAddr;
 
+  // Try to find the menu info struct, starting from the first match
+  for (ptr = findPatchSite(PATCH_MENU, osd); ptr; ptr = findPatchPattern(PATCH_MENU, ptr + 4, 0x100000 - (uint32_t)(ptr - osd + 4))) {
     // Found if the current address points to the pointer to "Browser" string
     if (_lw((uint32_t)ptr + 4) == (uint32_t)ptr - 4 * 4)
       break;
   }
+  if (!ptr)
+    return -1;
   menuAddr = (uint32_t)ptr;
 
   menuInfo = (struct OSDMenuInfo *)menuAddr;
 
   ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternOSDString, (uint8_t *)patternOSDString_mask, sizeof(patternOSDString));
   if (!ptr)
-    return;
+    return -1;
   osdstrAddr = (uint32_t)ptr;
 
   ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternUserInputHandler, (uint8_t *)patternUserInputHandler_mask,
                             sizeof(patternUserInputHandler));
   if (!ptr)
-    return;
+    return -1;
   entryAddr = (uint32_t)ptr;
 
   // Patch the OSD string function
@@ -128,13 +213,14 @@ void patchMenu(uint8_t *osd) {
   osdMenu[2] = _lw(menuAddr - 2 * 4); // "System Configuration"
   osdMenu[3] = _lw(menuAddr - 1 * 4);
 
-  for (i = 0; i < settings.menuItemCount; i++) {
-    osdMenu[4 + i * 2] = OSD_MAGIC + i;
-    osdMenu[5 + i * 2] = 0;
-  }
+  // Open the folder containing the initial item and preselect it
+  menuInfo->menuPtr = (uint32_t)osdMenu; // store menu pointer
+  if (settings.initialItem >= 0)
+    buildMenuLevel(settings.menuItemParent[settings.initialItem], settings.initialItem);
+  else
+    buildMenuLevel(-1, -1);
 
-  menuInfo->menuPtr = osdMenu;                       // store menu pointer
-  menuInfo->entryCount = 2 + settings.menuItemCount; // store number of menu items
+  return 0;
 }
 
 static uint32_t colorSelected[4] __attribute__((aligned(16)));
@@ -148,79 +234,105 @@ static int dx = 0;
 static int vel, acc;
 static int offsY = 0;
 static int fontHeight = 16;
+static animEasing scrollAnim;   // Menu scrolling animation
+static uint32_t cursorTime = 0; // Cursor animation step accumulator
+static int cursorSteps = 0;     // Cursor animation steps to run in the current frame
+
+// Per-frame menu render plan
+static int visibleLimit = 0;            // Items are visible while -visibleLimit < Y < visibleLimit
+static int visibleMin;                  // Visible window for the current frame, in (num << 1) units.
+static uint32_t visibleSpan;            // The window covers every item until the first scroll menu frame
+static uint8_t alphaRamp[8 * (15 + 1)]; // Unselected item alpha indexed by distance from the center
+
+// Returns whether the item is within the visible window using a single unsigned comparison
+#define ITEM_VISIBLE(num) ((uint32_t)((num) - visibleMin - 1) < visibleSpan)
+
+// Precomputes values that don't change between frames
+static void initMenuDrawPlan() {
+  for (int i = 0; i < 4; i++) {
+    colorSelected[i] = settings.colorSelected[i];
+    colorUnselected[i] = settings.colorUnselected[i];
+  }
 
-// Draws selected items
-void drawMenuItemSelected(int X, int Y, uint32_t *color, int alpha, const char *string, int num) {
-  int i;
+  animInit(settings.scrollDuration);
 
-  for (i = 0; i < 4; i++)
-    colorSelected[i] = settings.colorSelected[i];
+  visibleMin = -1;
+  visibleSpan = 0xffffff;
+  visibleLimit = (settings.displayedItems + 1) * (fontHeight / 2);
+  int alphaStep = 128 / visibleLimit;
+  for (int i = 0; i < visibleLimit; i++) {
+    int alpha = 128 - i * alphaStep;
+    alphaRamp[i] = (alpha < 0) ? 0 : alpha;
+  }
+}
+
+// Scrolls the menu towards the current entry and computes the visible window.
+// Called once per frame when drawing the first item
+static void planMenuFrame() {
+  uint32_t dt = animFrameTime();
+
+  animSetTarget(&scrollAnim, menuInfo->currentEntry << 4);
+  offsY = animUpdate(&scrollAnim, dt);
+  cursorSteps = animSteps(&cursorTime, dt);
+
+  visibleMin = offsY - visibleLimit;
+  visibleSpan = 2 * visibleLimit - 1;
+}
 
+// Draws selected items
+void drawMenuItemSelected(int X, int Y, uint32_t *color, int alpha, const char *string, int num) {
   if (alpha > 0x80)
     alpha = 0x80;
 
   if (!(settings.patcherFlags & FLAG_SCROLL_MENU)) { // Old style menu
-    DrawMenuItem(settings.menuX, Y - settings.menuItemCount * 10, colorSelected, alpha, string);
+    DrawMenuItem(settings.menuX, Y - levelItemCount * 10, colorSelected, alpha, string);
   } else { // New style menu
-    if (num == 0) {
-      int amount;
-      if (offsY < 0) {
-        amount = -offsY >> 2;
-        offsY += (amount > 0 ? amount : 1);
-      } else if (offsY > 0) {
-        amount = offsY >> 2;
-        offsY -= (amount > 0 ? amount : 1);
+    if (num == 0)
+      planMenuFrame();
+
+    num <<= 1;
+    if (ITEM_VISIBLE(num)) {
+      Y = num - offsY;
+      for (; cursorSteps > 0; cursorSteps--) {
+        vel -= acc;
+        if (vel < -settings.cursorMaxVelocity || vel > settings.cursorMaxVelocity)
+          acc = -acc;
+        dx += vel;
       }
-    }
-    Y = (num << 1) - offsY;
-    if ((Y < ((settings.displayedItems + 1) * (fontHeight / 2))) && (Y > -((settings.displayedItems + 1) * (fontHeight / 2)))) {
-      vel -= acc;
-      if (vel < -settings.cursorMaxVelocity || vel > settings.cursorMaxVelocity)
-        acc = -acc;
-      dx += vel;
       DrawMenuItem(settings.menuX, settings.menuY + Y, colorSelected, alpha, string);
       DrawMenuItemStringPtr(settings.menuX - 220 + (dx >> 8), settings.menuY + Y, colorSelected, alpha, settings.leftCursor);
       DrawMenuItemStringPtr(settings.menuX + 220 - (dx >> 8), settings.menuY + Y, colorSelected, alpha, settings.rightCursor);
     }
-    DrawMenuItemStringPtr(settings.menuX, settings.menuY - (settings.displayedItems * (fontHeight / 2) + (fontHeight / 2)), colorSelected, alpha,
-                          settings.menuDelimiterTop);
-    DrawMenuItemStringPtr(settings.menuX, settings.menuY + (settings.displayedItems * (fontHeight / 2) + (fontHeight / 2)), colorSelected, alpha,
-                          settings.menuDelimiterBottom);
+    DrawMenuItemStringPtr(settings.menuX, settings.menuY - visibleLimit, colorSelected, alpha, settings.menuDelimiterTop);
+    DrawMenuItemStringPtr(settings.menuX, settings.menuY + visibleLimit, colorSelected, alpha, settings.menuDelimiterBottom);
   }
 }
 
-// Draws unselected items
-void drawMenuItemUnselected(int X, int Y, uint32_t *color, int alpha, const char *string, int num) {
-  int i;
-
-  for (i = 0; i < 4; i++)
-    colorUnselected[i] = settings.colorUnselected[i];
-
+// Draws the unselected item that passed the visible window check
+static __attribute__((noinline)) void drawVisibleItemUnselected(int Y, int alpha, const char *string, int num) {
   if (!(settings.patcherFlags & FLAG_SCROLL_MENU)) { // Old style menu
-    DrawMenuItem(settings.menuX, Y - settings.menuItemCount * 10, colorUnselected, alpha, string);
-  } else { // New style menu
-    if (num == 0) {
-      int amount, destY = menuInfo->currentEntry << 4;
-      if (offsY < destY) {
-        amount = (destY - offsY) >> 2;
-        offsY += (amount > 0 ? amount : 1);
-      } else if (offsY > destY) {
-        amount = (offsY - destY) >> 2;
-        offsY -= (amount > 0 ? amount : 1);
-      }
-    }
-    Y = (num << 1) - offsY;
-    if ((Y < ((settings.displayedItems + 1) * (fontHeight / 2))) && (Y > -((settings.displayedItems + 1) * (fontHeight / 2)))) {
-      if (Y < 0)
-        alpha = 128 + (Y * (128 / ((settings.displayedItems + 1) * (fontHeight / 2))));
-      else
-        alpha = 128 - (Y * (128 / ((settings.displayedItems + 1) * (fontHeight / 2))));
-      if (alpha < 0)
-        alpha = 0;
-
-      DrawMenuItem(settings.menuX, settings.menuY + Y, colorUnselected, alpha, string);
-    }
+    DrawMenuItem(settings.menuX, Y - levelItemCount * 10, colorUnselected, alpha, string);
+    return;
+  }
+
+  // New style menu
+  if (num == 0) {
+    planMenuFrame();
+    if (!ITEM_VISIBLE(0))
+      return;
   }
+
+  Y = (num << 1) - offsY;
+  DrawMenuItem(settings.menuX, settings.menuY + Y, colorUnselected, alphaRamp[(Y < 0) ? -Y : Y], string);
+}
+
+// Draws unselected items.
+// Items outside of the visible window return without touching the stack. The window is only set up
+// by the scroll menu, so every item passes the check in the old style menu
+void drawMenuItemUnselected(int X, int Y, uint32_t *color, int alpha, const char *string, int num) {
+  if (num && !ITEM_VISIBLE(num << 1))
+    return;
+  drawVisibleItemUnselected(Y, alpha, string, num);
 }
 
 // Patches menu drawing functions
@@ -237,7 +349,7 @@ void drawMenuItemUnselected(int X, int Y, uint32_t *color, int alpha, const char
 // X = 430 (this is the center of the menu)
 // Y = 110 (this is the Y of the first item)
 // alpha = 128 (smaller value is more transparency)
-void patchMenuDraw(uint8_t *osd) {
+int patchMenuDraw(uint8_t *osd) {
   uint8_t *ptr;
   uint32_t tmp, pSelItem, pUnselItem;
 
@@ -249,18 +361,23 @@ void patchMenuDraw(uint8_t *osd) {
     settings.displayedItems = 1;
   if (settings.displayedItems > 15)
     settings.displayedItems = 15;
+  initMenuDrawPlan();
 
   if (!menuInfo)
-    return;
+    return -1;
 
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternDrawMenuItem, (uint8_t *)patternDrawMenuItem_mask, sizeof(patternDrawMenuItem));
+  // Start with the menu scrolled to the current entry
+  offsY = menuInfo->currentEntry << 4;
+  animJump(&scrollAnim, offsY);
+
+  ptr = findPatchSite(PATCH_MENU_DRAW, osd);
   if (!ptr)
-    return;
+    return -1;
   pSelItem = (uint32_t)ptr; // code for selected menu item
 
-  ptr = findPatternWithMask(ptr + 4, 256, (uint8_t *)patternDrawMenuItem, (uint8_t *)patternDrawMenuItem_mask, sizeof(patternDrawMenuItem));
+  ptr = findPatchPattern(PATCH_MENU_DRAW, ptr + 4, 256);
   if (ptr != (uint8_t *)(pSelItem + 48))
-    return;
+    return -1;
   pUnselItem = (uint32_t)ptr; // code for unselected menu item
 
   tmp = _lw(pSelItem + 32); // get the OSD's DrawMenuItem function pointer
@@ -281,6 +398,8 @@ void patchMenuDraw(uint8_t *osd) {
   _sw(0x01231021, pSelItem + 4);   // by loading it into t1 (multiplied by 8):
   _sw(0x001048c0, pUnselItem);     // sll   t1, s0, 3
   _sw(0x01231021, pUnselItem + 4); // addu  v0, t1, v1
+
+  return 0;
 }
 
 static void (*DrawNonSelectableItem)(int X, int Y, uint32_t *color, int alpha, const char *string);
@@ -370,7 +489,7 @@ void drawIconRight(int type, int X, int Y, int alpha) {
 // 	- Version icon Y : 230 on PAL
 // 	- Version text X : 529
 // 	- Version text Y : 230 on PAL
-void patchMenuButtonPanel(uint8_t *osd) {
+int patchMenuButtonPanel(uint8_t *osd) {
   uint8_t *ptr;
   uint8_t *firstPtr;
   uint32_t tmp;
@@ -379,10 +498,9 @@ void patchMenuButtonPanel(uint8_t *osd) {
   uint32_t mask[1];
 
   // Search and overwrite 1st function call in DrawButtonPanel function
-  firstPtr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternDrawButtonPanel_1, (uint8_t *)patternDrawButtonPanel_1_mask,
-                                 sizeof(patternDrawButtonPanel_1));
+  firstPtr = findPatchSite(PATCH_BUTTON_PANEL, osd);
   if (!firstPtr)
-    return;
+    return -1;
   pButtonsPanelType = (uint32_t)firstPtr;
 
   tmp = _lw(pButtonsPanelType + 32);
@@ -398,7 +516,7 @@ void patchMenuButtonPanel(uint8_t *osd) {
   ptr = findPatternWithMask(firstPtr, 0x1000, (uint8_t *)patternDrawButtonPanel_2, (uint8_t *)patternDrawButtonPanel_2_mask,
                             sizeof(patternDrawButtonPanel_2));
   if (!ptr)
-    return;
+    return -1;
   pBottomRightIcon = (uint32_t)ptr; // code for bottom right icon
 
   tmp = _lw(pBottomRightIcon + 24);
@@ -418,7 +536,7 @@ void patchMenuButtonPanel(uint8_t *osd) {
   // Search and overwrite 2nd DrawIcon function call in DrawButtonPanel function
   ptr = findPatternWithMask(ptr + 28, 0x1000, (uint8_t *)pattern, (uint8_t *)mask, sizeof(pattern));
   if (!ptr)
-    return;
+    return -1;
   pBottomLeftIcon = (uint32_t)ptr; // code for bottom left icons
 
   tmp = 0x0c000000;
@@ -429,7 +547,7 @@ void patchMenuButtonPanel(uint8_t *osd) {
   ptr = findPatternWithMask(firstPtr, 0x1000, (uint8_t *)patternDrawButtonPanel_3, (uint8_t *)patternDrawButtonPanel_3_mask,
                             sizeof(patternDrawButtonPanel_3));
   if (!ptr)
-    return;
+    return -1;
   pBottomRightItem = (uint32_t)ptr; // code for bottom right item
 
   tmp = _lw(pBottomRightItem + 20); // get the OSD's DrawNonSelectableItem function pointer
@@ -449,12 +567,14 @@ void patchMenuButtonPanel(uint8_t *osd) {
   // Search and overwrite 2nd DrawNonSelectableItem function call in DrawButtonPanel function
   ptr = findPatternWithMask(ptr + 24, 0x1000, (uint8_t *)pattern, (uint8_t *)mask, sizeof(pattern));
   if (!ptr)
-    return;
+    return -1;
   pBottomLeftItem = (uint32_t)ptr; // code for bottom left item
 
   tmp = 0x0c000000;
   tmp |= ((uint32_t)drawNonselectableEntryLeft >> 2);
   _sw(tmp, pBottomLeftItem); // overwrite the function call for bottom left item
+
+  return 0;
 }
 
 // An array that stores what function to call for each disc type.
@@ -469,14 +589,14 @@ void patchMenuButtonPanel(uint8_t *osd) {
 //    exec_hdd_stuff			  // HDDLOAD
 //}
 // Patches the disc launch handlers to load discs with the launcher
-void patchDiscLaunch(uint8_t *osd) {
+int patchDiscLaunch(uint8_t *osd) {
   uint8_t *ptr;
   uint32_t tmp, pFn;
   static uint32_t *discLaunchHandlers = NULL;
 
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternExecuteDisc, (uint8_t *)patternExecuteDisc_mask, sizeof(patternExecuteDisc));
+  ptr = findPatchSite(PATCH_DISC_LAUNCH, osd);
   if (!ptr)
-    return;
+    return -1;
 
   pFn = (uint32_t)ptr; // address of the ExecuteDisc function
 
@@ -487,30 +607,34 @@ void patchDiscLaunch(uint8_t *osd) {
   discLaunchHandlers[0] = (uint32_t)launchDisc; // Overwrite PS2 DVD function pointer
   discLaunchHandlers[1] = (uint32_t)launchDisc; // Overwrite PS2 CD function pointer
   discLaunchHandlers[2] = (uint32_t)launchDisc; // Overwrite PS1 function pointer
+
+  return 0;
 }
 
 // Patches automatic disc launch
-void patchSkipDisc(uint8_t *osd) {
+int patchSkipDisc(uint8_t *osd) {
   uint8_t *ptr;
   uint32_t tmp, addr2, addr3, dist;
 
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternDetectDisc_1, (uint8_t *)patternDetectDisc_1_mask, sizeof(patternDetectDisc_1));
+  ptr = findPatchSite(PATCH_SKIP_DISC, osd);
   if (!ptr)
-    return;
+    return -1;
   addr2 = (uint32_t)ptr;
 
   ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternDetectDisc_2, (uint8_t *)patternDetectDisc_2_mask, sizeof(patternDetectDisc_2));
   if (!ptr)
-    return;
+    return -1;
   addr3 = (uint32_t)ptr;
 
   tmp = addr2 + 48; // patch start
   dist = ((addr3 - tmp) >> 2) - 1;
   if (dist > 0x40)
-    return;
+    return -1;
 
   _sw(0x10000000 + dist, tmp); // branch to addr3
   _sw(0, tmp + 4);             // nop
+
+  return 0;
 }
 
 static uint32_t menuLoopPatch_1[7] = {0x8e04fff8, 0x8e05fff0, 0x0004102a, 0x0082280b, 0x20a3ffff, 0x1000000c, 0xae03fff8};
@@ -519,19 +643,14 @@ static uint32_t menuLoopPatch_2[9] = {
 };
 
 // Patches menu scrolling
-void patchMenuInfiniteScrolling(uint8_t *osd, int isProtokernel) {
+int patchMenuInfiniteScrolling(uint8_t *osd, int isProtokernel) {
   int i;
   uint8_t *ptr;
   uint32_t *addr, *src, *dst;
 
-  if (isProtokernel)
-    ptr = findPatternWithMask(osd + PROTOKERNEL_MENU_OFFSET, 0x100000, (uint8_t *)patternMenuLoop_Proto, (uint8_t *)patternMenuLoop_mask,
-                              sizeof(patternMenuLoop_Proto));
-  else
-    ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternMenuLoop, (uint8_t *)patternMenuLoop_mask, sizeof(patternMenuLoop));
-
+  ptr = findPatchSite(isProtokernel ? PATCH_INFINITE_SCROLLING_PROTO : PATCH_INFINITE_SCROLLING, osd);
   if (!ptr)
-    return;
+    return -1;
 
   addr = (uint32_t *)ptr;
 
@@ -548,36 +667,42 @@ void patchMenuInfiniteScrolling(uint8_t *osd, int isProtokernel) {
 
     addr[10] = addr[-1]; // reload normal pad variable
     addr[-1] += 8;       // get key repeat variable
+    return 0;
   }
+  return -1;
 }
 
 // Forces the video mode
-void patchVideoMode(uint8_t *osd, GSVideoMode mode) {
+int patchVideoMode(uint8_t *osd, GSVideoMode mode) {
   uint8_t *ptr;
 
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternVideoMode, (uint8_t *)patternVideoMode_mask, sizeof(patternVideoMode));
+  ptr = findPatchSite(PATCH_VIDEO_MODE, osd);
   if (!ptr)
-    return;
+    return -1;
 
   if (mode == GS_MODE_PAL)
     _sw(0x24020001, (uint32_t)ptr + 20); // set return value to 1
   else
     _sw(0x0000102d, (uint32_t)ptr + 20); // set return value to 0 to force NTSC
+
+  return 0;
 }
 
 // Patches HDD update code for ROMs not supporting "SkipHdd" arg
-void patchSkipHDD(uint8_t *osd) {
+int patchSkipHDD(uint8_t *osd) {
   uint8_t *ptr;
   uint32_t addr;
 
   // Search code near MC Update & HDD load
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternHDDLoad, (uint8_t *)patternHDDLoad_mask, sizeof(patternHDDLoad));
+  ptr = findPatchSite(PATCH_SKIP_HDD, osd);
   if (!ptr)
-    return;
+    return -1;
   addr = (uint32_t)ptr;
 
   // Place "beq zero, zero, Exit_HddLoad" just after CheckMcUpdate() call
   _sw(0x10000000 + ((signed short)(_lw(addr + 28) & 0xffff) + 5), addr + 8);
+
+  return 0;
 }
 
 //
@@ -586,28 +711,26 @@ void patchSkipHDD(uint8_t *osd) {
 //
 
 // Patches OSD menu to include custom menu entries
-void patchMenuProtokernel(uint8_t *osd) {
+int patchMenuProtokernel(uint8_t *osd) {
   uint8_t *ptr;
-  uint32_t tmp, menuAddr, entryAddr, i;
-
-  // Try to find the menu info struct
-  for (tmp = 0; tmp < 0x100000; tmp = (uint32_t)(ptr - osd + 4)) {
-    ptr = findPatternWithMask(osd + PROTOKERNEL_MENU_OFFSET + tmp, 0x100000 - tmp, (uint8_t *)patternMenuInfo_Proto,
-                              (uint8_t *)patternMenuInfo_Proto_mask, sizeof(patternMenuInfo_Proto));
-    if (!ptr)
-      return;
+  uint32_t tmp, menuAddr, entryAddr;
 
+  // Try to find the menu info struct, starting from the first match
+  uint8_t *end = osd + PROTOKERNEL_MENU_OFFSET + 0x100000;
+  for (ptr = findPatchSite(PATCH_MENU_PROTO, osd); ptr; ptr = findPatchPattern(PATCH_MENU_PROTO, ptr + 4, (uint32_t)(end - ptr - 4))) {
     // Found if the current address points to the pointer to "Browser" string
     if (_lw((uint32_t)ptr) == (uint32_t)ptr - 4 * 8)
       break;
   }
+  if (!ptr)
+    return -1;
   menuAddr = (uint32_t)ptr - 4;
   menuInfo = (struct OSDMenuInfo *)menuAddr;
 
   ptr = findPatternWithMask(osd + PROTOKERNEL_MENU_OFFSET, 0x100000, (uint8_t *)patternUserInputHandler, (uint8_t *)patternUserInputHandler_mask,
                             sizeof(patternUserInputHandler));
   if (!ptr)
-    return;
+    return -1;
   entryAddr = (uint32_t)ptr;
 
   // Patch the user input handling function
@@ -625,29 +748,32 @@ void patchMenuProtokernel(uint8_t *osd) {
   osdMenu[2] = _lw(menuAddr - 4 * 4); // "System Configuration"
   osdMenu[3] = _lw(menuAddr - 4 * 3);
 
-  for (i = 0; i < settings.menuItemCount; i++) {
-    if (settings.menuItemName[i][0] == '\0')
-      continue;
-
-    osdMenu[4 + i * 2] = (uint32_t)settings.menuItemName[i];
-    osdMenu[5 + i * 2] = (uint32_t)settings.menuItemName[i];
-  }
+  // Open the folder containing the initial item and preselect it
+  isProtokernelMenu = 1;
+  menuInfo->menuPtr = (uint32_t)osdMenu; // store menu pointer
+  if (settings.initialItem >= 0)
+    buildMenuLevel(settings.menuItemParent[settings.initialItem], settings.initialItem);
+  else
+    buildMenuLevel(-1, -1);
 
-  menuInfo->menuPtr = osdMenu;                       // store menu pointer
-  menuInfo->entryCount = 2 + settings.menuItemCount; // store number of menu items
+  return 0;
 }
 
 // Protokernel drawing functions don't pass anything indicating the entry index.
 // However, s0 register contains menu index
 void drawMenuItemSelectedProtokernel(int X, int Y, uint32_t *color, int alpha, const char *string) {
   int num = 0;
+#ifdef _EE
   asm volatile("move %0, $s0" : "=r"(num)::); // Get menu index from s0 register
+#endif
   num *= 8;                                   // Multiply by 8 to align with later OSDSYS behavior
   drawMenuItemSelected(X, Y, color, alpha, string, num);
 }
 void drawMenuItemUnselectedProtokernel(int X, int Y, uint32_t *color, int alpha, const char *string) {
   int num = 0;
+#ifdef _EE
   asm volatile("move %0, $s0" : "=r"(num)::); // Get menu index from s0 register
+#endif
   num *= 8;                                   // Multiply by 8 to align with later OSDSYS behavior
   drawMenuItemUnselected(X, Y, color, alpha, string, num);
 }
@@ -665,7 +791,7 @@ void drawMenuItemProtokernel(int X, int Y, uint32_t *color, int alpha, const cha
 }
 
 // Patches menu drawing functions
-void patchMenuDrawProtokernel(uint8_t *osd) {
+int patchMenuDrawProtokernel(uint8_t *osd) {
   uint8_t *ptr;
   uint32_t tmp, pSelItem, pUnselItem;
 
@@ -677,20 +803,23 @@ void patchMenuDrawProtokernel(uint8_t *osd) {
     settings.displayedItems = 1;
   if (settings.displayedItems > 15)
     settings.displayedItems = 15;
+  initMenuDrawPlan();
 
   if (!menuInfo)
-    return;
+    return -1;
+
+  // Start with the menu scrolled to the current entry
+  offsY = menuInfo->currentEntry << 4;
+  animJump(&scrollAnim, offsY);
 
-  ptr = findPatternWithMask(osd + PROTOKERNEL_MENU_OFFSET, 0x100000, (uint8_t *)patternDrawMenuItem_Proto, (uint8_t *)patternDrawMenuItem_Proto_mask,
-                            sizeof(patternDrawMenuItem_Proto));
+  ptr = findPatchSite(PATCH_MENU_DRAW_PROTO, osd);
   if (!ptr)
-    return;
+    return -1;
   pSelItem = (uint32_t)ptr;
 
-  ptr = findPatternWithMask(ptr + 0x18, 0x100, (uint8_t *)patternDrawMenuItem_Proto, (uint8_t *)patternDrawMenuItem_Proto_mask,
-                            sizeof(patternDrawMenuItem_Proto));
+  ptr = findPatchPattern(PATCH_MENU_DRAW_PROTO, ptr + 0x18, 0x100);
   if (!ptr)
-    return;
+    return -1;
   pUnselItem = (uint32_t)ptr;
 
   tmp = _lw(pSelItem + 0x10); // get the OSD's DrawMenuItem function pointer
@@ -713,6 +842,8 @@ void patchMenuDrawProtokernel(uint8_t *osd) {
   tmp = _lw(pUnselItem + 32); // Must be addiu ??,??,0xc
   if ((tmp & 0xff0000ff) == 0x2600000c)
     _sw((tmp & 0xffffff00) | 0x08, pUnselItem + 32); // Modify to addiu ??,??,0x08
+
+  return 0;
 }
 
 // An array that stores what function to call for each disc type.
@@ -726,15 +857,14 @@ void patchMenuDrawProtokernel(uint8_t *osd) {
 //    exec_dvdv_disc			  // DVD Video
 //}
 // Patches the disc launch handlers to load discs with the launcher
-void patchDiscLaunchProtokernel(uint8_t *osd) {
+int patchDiscLaunchProtokernel(uint8_t *osd) {
   uint8_t *ptr;
   uint32_t tmp, pFn;
   static uint32_t *discLaunchHandlers = NULL;
 
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternExecuteDiscProto, (uint8_t *)patternExecuteDiscProto_mask,
-                            sizeof(patternExecuteDiscProto));
+  ptr = findPatchSite(PATCH_DISC_LAUNCH_PROTO, osd);
   if (!ptr)
-    return;
+    return -1;
 
   pFn = (uint32_t)ptr;
 
@@ -745,6 +875,8 @@ void patchDiscLaunchProtokernel(uint8_t *osd) {
   discLaunchHandlers[2] = (uint32_t)launchDisc; // Overwrite protokernel PS2 DVD function pointer
   discLaunchHandlers[3] = (uint32_t)launchDisc; // Overwrite protokernel PS2 CD function pointer
   discLaunchHandlers[4] = (uint32_t)launchDisc; // Overwrite protokernel PS1 function pointer
+
+  return 0;
 }
 
 // Finds some drawing functions. Unused.
@@ -1,4 +1,6 @@
 
+#include "apps.h"
+#include "defaults.h"
 #include "loader.h"
 #include "patches_common.h"
 #include "patterns_osdmenu.h"
@@ -7,7 +9,10 @@
 #include <gs.h>
 #include <kernel.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#define NEWLIB_PORT_AWARE
+#include <fileio.h>
 
 typedef struct {
   uint16_t sceGsInterMode; // Interlace/non-interlace value
@@ -30,6 +35,8 @@ static char romverValue[] = "\ar0.80VVVVRTYYYYMMDD\ar0.00";
 static char mechaconRev[] = "0.00 (Debug)";
 static char eeRevision[5] = {0};
 static char gsRevision[5] = {0};
+// OSDSYS base address for the deferred version menu initialization. Cleared once the initialization is done
+static uint8_t *versionInfoOSD = NULL;
 
 static uint16_t *(*sceCdApplySCmd)(uint16_t cmdNum, const void *inBuff, uint16_t inBuffSize, void *outBuff) = NULL;
 
@@ -55,16 +62,64 @@ char *getPatchVersion() { return "\ar0.80" GIT_VERSION "\ar0.00"; }
 customVersionEntry entries[] = {
     {"Video Mode", NULL, getVideoMode, getVideoMode},               //
     {"OSDMenu Patch", NULL, getPatchVersion, getPatchVersionProto}, //
+    {"Patches Applied", NULL, getPatchStatus, getPatchStatus},      //
     {"ROM", romverValue, NULL},                                     //
     {"Emotion Engine", eeRevision, NULL},                           //
     {"Graphics Synthesizer", NULL, getGSRevision, getGSRevision},   //
     {"MechaCon", NULL, getMechaConRevision, getMechaConRevision},   //
 };
 
+// Formats single-byte number into M.mm string.
+// dst is expected to be at least 5 bytes long
+void formatRevision(char *dst, uint8_t rev) {
+  dst[0] = '0' + (rev >> 4);
+  dst[1] = '.';
+  dst[2] = '0' + ((rev & 0x0f) / 10);
+  dst[3] = '0' + ((rev & 0x0f) % 10);
+  dst[4] = '\0';
+}
+
+// Finds sceCdApplySCmd and initializes static version menu values.
+// The version menu is rarely opened, so this is done on the first menu open instead of when patching OSDSYS
+static void initVersionInfoValues(int isProtokernel) {
+  if (!versionInfoOSD)
+    return;
+
+  // Find sceCdApplySCmd address
+  uint8_t *ptr;
+  if (isProtokernel)
+    ptr = findPatternWithMask(versionInfoOSD, 0x100000, (uint8_t *)patternCdApplySCmd_Proto, (uint8_t *)patternCdApplySCmd_Proto_mask,
+                              sizeof(patternCdApplySCmd_Proto));
+  else
+    ptr = findPatternWithMask(versionInfoOSD, 0x100000, (uint8_t *)patternCdApplySCmd, (uint8_t *)patternCdApplySCmd_mask, sizeof(patternCdApplySCmd));
+  if (ptr) {
+    uint32_t fnptr = (uint32_t)ptr;
+    while ((_lw(fnptr) & 0xffff0000) != 0x27bd0000)
+      fnptr -= 4;
+
+    sceCdApplySCmd = (void *)fnptr;
+  }
+
+  // ROM version
+  if (settings.romver[0] == '\0') {
+    romverValue[0] = '-';  // Put placeholer value
+    romverValue[1] = '\0'; // Put placeholer value
+  } else if (isProtokernel)
+    strncpy(romverValue, settings.romver, 15); // Protokernels don't support control characters so it might not fit
+  else
+    memcpy(&romverValue[6], settings.romver, 14);
+
+  // EE Revision
+  formatRevision(eeRevision, GetCop0(15));
+
+  versionInfoOSD = NULL;
+}
+
 // This function will be called every time the version menu opens
 void versionInfoInitHandler() {
   // Execute the original init function
   versionInfoInit();
+  initVersionInfoValues(0);
 
   // Extend the string table used by the version menu drawing function.
   // It picks up the entries automatically and stops once it gets a NULL pointer (0)
@@ -111,22 +166,12 @@ void versionInfoInitHandler() {
   }
 };
 
-// Formats single-byte number into M.mm string.
-// dst is expected to be at least 5 bytes long
-void formatRevision(char *dst, uint8_t rev) {
-  dst[0] = '0' + (rev >> 4);
-  dst[1] = '.';
-  dst[2] = '0' + ((rev & 0x0f) / 10);
-  dst[3] = '0' + ((rev & 0x0f) % 10);
-  dst[4] = '\0';
-}
-
 // Extends version menu with custom entries by overriding the function called every time the version menu opens
-void patchVersionInfo(uint8_t *osd) {
+int patchVersionInfo(uint8_t *osd) {
   // Find the function that inits version menu entries
-  uint8_t *ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternVersionInit, (uint8_t *)patternVersionInit_mask, sizeof(patternVersionInit));
+  uint8_t *ptr = findPatchSite(PATCH_VERSION_INFO, osd);
   if (!ptr)
-    return;
+    return -1;
 
   // First pattern word is nop, advance ptr to point to the function call
   ptr += 4;
@@ -143,7 +188,7 @@ void patchVersionInfo(uint8_t *osd) {
   uint8_t *tableptr = findPatternWithMask((uint8_t *)versionInfoInit, 0x200, (uint8_t *)patternVersionStringTable,
                                           (uint8_t *)patternVersionStringTable_mask, sizeof(patternVersionStringTable));
   if (!tableptr)
-    return;
+    return -1;
 
   // Assemble the table address
   tmp = (_lw((uint32_t)tableptr) & 0xFFFF) << 16;
@@ -153,7 +198,7 @@ void patchVersionInfo(uint8_t *osd) {
     // Make sure the address is in the valid address space
     verinfoStringTableAddr = tmp;
   else
-    return;
+    return -1;
 
   // Replace versionInfoInit with the custom function
   tmp = 0x0c000000;
@@ -169,27 +214,9 @@ void patchVersionInfo(uint8_t *osd) {
     sceGsGetGParam = (void *)tmp;
   }
 
-  // Find sceCdApplySCmd address
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternCdApplySCmd, (uint8_t *)patternCdApplySCmd_mask, sizeof(patternCdApplySCmd));
-  if (ptr) {
-    uint32_t fnptr = (uint32_t)ptr;
-    while ((_lw(fnptr) & 0xffff0000) != 0x27bd0000)
-      fnptr -= 4;
-
-    sceCdApplySCmd = (void *)fnptr;
-  }
-
-  // Initialize static values
-  // ROM version
-  if (settings.romver[0] != '\0') {
-    memcpy(&romverValue[6], settings.romver, 14);
-  } else {
-    romverValue[0] = '-';  // Put placeholer value
-    romverValue[1] = '\0'; // Put placeholer value
-  }
-
-  // EE Revision
-  formatRevision(eeRevision, GetCop0(15));
+  // sceCdApplySCmd lookup and static values are initialized when the version menu opens for the first time
+  versionInfoOSD = osd;
+  return 0;
 }
 
 char *getVideoMode() {
@@ -220,6 +247,10 @@ char *getVideoMode() {
 }
 
 char *getGSRevision() {
+  if (gsRevision[0] != '\0')
+    // Read the revision only once
+    return gsRevision;
+
   uint8_t rev = (*GS_REG_CSR >> 16) & 0xFF;
   if (rev) {
     formatRevision(gsRevision, rev);
@@ -328,19 +359,19 @@ void gsPutDispEnv(sceGsDispEnv *disp) {
 
 // Overrides SetGsCrt and sceGsPutDispEnv functions to support 480p and 1080i output modes
 // ALWAYS call restoreGSVideoMode before launching apps
-void patchGSVideoMode(uint8_t *osd, GSVideoMode outputMode) {
+int patchGSVideoMode(uint8_t *osd, GSVideoMode outputMode) {
   if (outputMode < GS_MODE_DTV_480P)
-    return; // Do not apply patch for PAL/NTSC modes
+    return PATCH_NOT_NEEDED; // Do not apply patch for PAL/NTSC modes
 
   // Find sceGsPutDispEnv address
-  uint8_t *ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternGsPutDispEnv, (uint8_t *)patternGsPutDispEnv_mask, sizeof(patternGsPutDispEnv));
+  uint8_t *ptr = findPatchSite(PATCH_GS_VIDEO_MODE, osd);
   if (!ptr)
-    return;
+    return -1;
 
   // Get the address of the original SetGsCrt handler and translate it to kernel mode address range used by syscalls (kseg0)
   origSetGsCrt = (void *)(((uint32_t)GetSyscallHandler(0x2) & 0x0fffffff) | 0x80000000);
   if (!origSetGsCrt)
-    return;
+    return -1;
 
   // Replace call to sceGsPutDispEnv with the custom function
   uint32_t tmp = 0x0c000000;
@@ -359,6 +390,8 @@ void patchGSVideoMode(uint8_t *osd, GSVideoMode outputMode) {
     break;
   default:
   }
+
+  return 0;
 }
 
 // Restores SetGsCrt.
@@ -395,6 +428,45 @@ uint32_t entryPropsAddr = 0;
 // Path buffer
 char pathBuf[100];
 
+// App indexes for mc0 and mc1
+static appIndexEntry *appIndex[2] = {NULL, NULL};
+static int appIndexCount[2] = {0, 0};
+
+// Loads app indexes from both memory cards
+// Must be called before launching OSDSYS
+void loadAppIndex() {
+  char indexPath[] = APP_INDEX_PATH;
+  appIndexHeader header;
+  int fd;
+
+  for (int i = 0; i < 2; i++) {
+    // Free the index loaded before the settings reload
+    free(appIndex[i]);
+    appIndex[i] = NULL;
+    appIndexCount[i] = 0;
+
+    indexPath[2] = '0' + i;
+    if ((fd = fioOpen(indexPath, FIO_O_RDONLY)) < 0)
+      continue;
+
+    if ((fioRead(fd, &header, sizeof(header)) == sizeof(header)) && (header.magic == APP_INDEX_MAGIC) && (header.count > 0) &&
+        (header.count <= APP_INDEX_MAX_ENTRIES) && (appIndex[i] = malloc(header.count * sizeof(appIndexEntry)))) {
+      if (fioRead(fd, appIndex[i], header.count * sizeof(appIndexEntry)) == header.count * sizeof(appIndexEntry))
+        appIndexCount[i] = header.count;
+    }
+    fioClose(fd);
+  }
+}
+
+// Returns 1 if the save directory on the memory card is listed in the app index
+static int isIndexedApp(int mcNumber, const char *dirName) {
+  for (int i = 0; i < appIndexCount[mcNumber]; i++) {
+    if (!strncmp(appIndex[mcNumber][i].dirName, dirName, APP_INDEX_NAME_LEN))
+      return 1;
+  }
+  return 0;
+}
+
 // This function is always executed first and called every time a submenu is opened
 void browserDirSubmenuInitViewCustom(uint8_t *entryProps, uint8_t fileSubmenuType) {
   // Store the address for browserGetMcDirSizeCustom
@@ -406,12 +478,14 @@ void browserDirSubmenuInitViewCustom(uint8_t *entryProps, uint8_t fileSubmenuTyp
   }
 
   // Get memory card number by reading address relative to $gp
-  int mcNumber;
+  int mcNumber = 0;
+#ifdef _EE
   asm volatile("addu $t0, $gp, %1\n\t" // Add the offset to the gp register
                "lw %0, 0($t0)"         // Load the word at the offset
                : "=r"(mcNumber)
                : "r"((int32_t)selectedMCOffset) // Cast the type to avoid GCC using lhu instead of lh
                : "$t0");
+#endif
 
   // Translate the memory card number
   // The memory card number OSDSYS uses equals 2 for mc0 and 6 for mc1 (3 for mc1 on protokernels).
@@ -437,7 +511,7 @@ void browserDirSubmenuInitViewCustom(uint8_t *entryProps, uint8_t fileSubmenuTyp
     strcat(pathBuf, "/title.cfg");
     pathBuf[2] = mcNumber + '0';
 
-    if (*(entryProps - 0x2) == 0xAA)
+    if ((*(entryProps - 0x2) == 0xAA) || isIndexedApp(mcNumber, stroffset + 1))
       // If icon is an app, launch the app
       launchItem(pathBuf);
     // Else, the app will be launched by the browserGetMcDirSizeCustom function
@@ -476,16 +550,15 @@ int browserGetMcDirSizeCustom() {
 }
 
 // Browser application launch patch
-void patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel) {
+int patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel) {
   // Protokernel browser code starts at ~0x700000
   uint32_t osdOffset = (isProtokernel) ? (PROTOKERNEL_MENU_OFFSET + 0x100000) : 0;
 
   // Find the target function
-  uint8_t *ptr = findPatternWithMask(osd + osdOffset, 0x100000, (uint8_t *)patternBrowserFileMenuInit, (uint8_t *)patternBrowserFileMenuInit_mask,
-                                     sizeof(patternBrowserFileMenuInit));
+  uint8_t *ptr = findPatchSite(isProtokernel ? PATCH_BROWSER_LAUNCHER_PROTO : PATCH_BROWSER_LAUNCHER, osd);
 
   if (!ptr || ((_lw((uint32_t)ptr + 4 * 4) & 0xfc000000) != 0x0c000000))
-    return;
+    return -1;
   ptr += 4 * 4;
 
   // Get the original function call and save the address
@@ -495,7 +568,7 @@ void patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel) {
   uint8_t *ptr2 = findPatternWithMask((uint8_t *)browserDirSubmenuInitView, 0x500, (uint8_t *)patternBrowserSelectedMC,
                                       (uint8_t *)patternBrowserSelectedMC_mask, sizeof(patternBrowserSelectedMC));
   if (!ptr2)
-    return;
+    return -1;
   // Store memory card offset
   selectedMCOffset = _lw((uint32_t)ptr2) & 0xffff;
 
@@ -503,7 +576,7 @@ void patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel) {
   ptr2 = findPatternWithMask(osd + osdOffset, 0x100000, (uint8_t *)patternBrowserGetMcDirSize, (uint8_t *)patternBrowserGetMcDirSize_mask,
                              sizeof(patternBrowserGetMcDirSize));
   if (!ptr2)
-    return;
+    return -1;
   // Get the original function call and save the address
   browserGetMcDirSize = (void *)((_lw((uint32_t)ptr2) & 0x03ffffff) << 2);
 
@@ -546,6 +619,8 @@ void patchBrowserApplicationLaunch(uint8_t *osd, int isProtokernel) {
   // Replace original functions
   _sw((0x0c000000 | ((uint32_t)browserDirSubmenuInitViewCustom >> 2)), (uint32_t)ptr); // jal browserDirSubmenuInitViewCustom
   _sw((0x0c000000 | ((uint32_t)browserGetMcDirSizeCustom >> 2)), (uint32_t)ptr2);      // jal browserGetMcDirSizeCustom
+
+  return 0;
 }
 
 //
@@ -561,6 +636,7 @@ static char *(*getDVDPlayerVersion)(char *label, char *value, char *submenu) = N
 char *versionInfoInitHandlerProtokernel(char *label, char *value, char *submenu) {
   // Execute the original function
   char *res = getDVDPlayerVersion(label, value, submenu);
+  initVersionInfoValues(1);
 
   // Extend the string table used by the version menu drawing function.
   // It picks up the entries automatically and stops once it reads an empty string
@@ -604,12 +680,11 @@ char *versionInfoInitHandlerProtokernel(char *label, char *value, char *submenu)
 // static values into the pre-defined locations (except for DVD Player version)
 // Thankfully, the drawing function is dynamic.
 // Extends version menu with custom entries by overriding the function called every time the version menu opens
-void patchVersionInfoProtokernel(uint8_t *osd) {
+int patchVersionInfoProtokernel(uint8_t *osd) {
   // Find the function that inits version menu entries
-  uint8_t *ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternVersionInit_Proto, (uint8_t *)patternVersionInit_Proto_mask,
-                                     sizeof(patternVersionInit_Proto));
+  uint8_t *ptr = findPatchSite(PATCH_VERSION_INFO_PROTO, osd);
   if (!ptr)
-    return;
+    return -1;
 
   // Advance ptr to point to the function call
   ptr += 8;
@@ -625,59 +700,38 @@ void patchVersionInfoProtokernel(uint8_t *osd) {
   tmp |= ((uint32_t)versionInfoInitHandlerProtokernel >> 2);
   _sw(tmp, (uint32_t)ptr); // jal versionInfoInitHandlerProtokernel
 
-  // Find sceCdApplySCmd address
-  ptr = findPatternWithMask(osd, 0x100000, (uint8_t *)patternCdApplySCmd_Proto, (uint8_t *)patternCdApplySCmd_Proto_mask,
-                            sizeof(patternCdApplySCmd_Proto));
-  if (ptr) {
-    uint32_t fnptr = (uint32_t)ptr;
-    while ((_lw(fnptr) & 0xffff0000) != 0x27bd0000)
-      fnptr -= 4;
-
-    sceCdApplySCmd = (void *)fnptr;
-  }
-
-  // Initialize static values
-  // ROM version. Protokernels don't support control characters so it might not fit.
-  if (settings.romver[0] != '\0') {
-    strncpy(romverValue, settings.romver, 15);
-  } else {
-    romverValue[0] = '-';  // Put placeholer value
-    romverValue[1] = '\0'; // Put placeholer value
-  }
-
-  // EE Revision
-  formatRevision(eeRevision, GetCop0(15));
+  // sceCdApplySCmd lookup and static values are initialized when the version menu opens for the first time
+  versionInfoOSD = osd;
+  return 0;
 }
 
 // Overrides SetGsCrt and sceGsPutDispEnv functions to support 480p and 1080i output modes
 // ALWAYS call restoreGSVideoMode before launching apps
-uint32_t osdOffset = 0x300000;
-void patchGSVideoModeProtokernel(uint8_t *osd, GSVideoMode outputMode) {
+int patchGSVideoModeProtokernel(uint8_t *osd, GSVideoMode outputMode) {
   if (outputMode < GS_MODE_DTV_480P)
-    return; // Do not apply patch for PAL/NTSC modes
+    return PATCH_NOT_NEEDED; // Do not apply patch for PAL/NTSC modes
 
   // Get the address of the original SetGsCrt handler and translate it to kernel mode address range used by syscalls (kseg0)
   origSetGsCrt = (void *)(((uint32_t)GetSyscallHandler(0x2) & 0x0fffffff) | 0x80000000);
   if (!origSetGsCrt)
-    return;
+    return -1;
 
   // Find sceGsPutDispEnv address
   // There are three occurrences of sceGsPutDispEnv at base addresses
   // 0x500000, 0x600000 and 0x700000. OSDSYS is loaded at 0x200000
-  while (osdOffset < 0x600000) {
-    uint8_t *ptr = findPatternWithMask(osd + osdOffset, 0x100000, (uint8_t *)patternGsPutDispEnv, (uint8_t *)patternGsPutDispEnv_mask,
-                                       sizeof(patternGsPutDispEnv));
+  uint8_t *ptr = findPatchSite(PATCH_GS_VIDEO_MODE_PROTO, osd);
+  for (uint32_t osdOffset = 0x300000; osdOffset < 0x600000; osdOffset += 0x100000) {
+    if (osdOffset > 0x300000)
+      ptr = findPatchPattern(PATCH_GS_VIDEO_MODE_PROTO, osd + osdOffset, 0x100000);
     if (!ptr) {
       origSetGsCrt = NULL;
-      return;
+      return -1;
     }
 
     // Replace call to sceGsPutDispEnv with the custom function
     uint32_t tmp = 0x0c000000;
     tmp |= ((uint32_t)gsPutDispEnv >> 2);
     _sw(tmp, (uint32_t)ptr); // jal gsPutDispEnv
-
-    osdOffset += 0x100000;
   }
 
   // Replace SetGsCrt with custom handler
@@ -692,4 +746,6 @@ void patchGSVideoModeProtokernel(uint8_t *osd, GSVideoMode outputMode) {
     break;
   default:
   }
+
+  return 0;
 }
@@ -0,0 +1,60 @@
+// Pattern search functions
+// Doesn't depend on PS2SDK so it can also be built for the host
+#include "pattern_search.h"
+#include <stddef.h>
+
+// Searches for byte pattern in memory
+uint8_t *findPatternWithMask(uint8_t *buf, uint32_t bufsize, uint8_t *bytes, uint8_t *mask, uint32_t len) {
+  uint32_t i, j;
+
+  if (!len || (bufsize <= len))
+    return NULL;
+
+  if (!(((uintptr_t)buf | (uintptr_t)bytes | (uintptr_t)mask | len) & 0x3)) {
+    // All patterns are MIPS instruction words, so the search can be done a word at a time.
+    // The first word is compared before checking the rest of the pattern
+    uint32_t *wbuf = (uint32_t *)buf;
+    uint32_t *wbytes = (uint32_t *)bytes;
+    uint32_t *wmask = (uint32_t *)mask;
+    uint32_t wlen = len >> 2;
+    uint32_t wcount = (bufsize - len) >> 2;
+    uint32_t first = wbytes[0], firstMask = wmask[0];
+
+    for (i = 0; i < wcount; i++) {
+      if ((wbuf[i] & firstMask) != first)
+        continue;
+      for (j = 1; j < wlen; j++) {
+        if ((wbuf[i + j] & wmask[j]) != wbytes[j])
+          break;
+      }
+      if (j == wlen)
+        return (uint8_t *)&wbuf[i];
+    }
+    return NULL;
+  }
+
+  for (i = 0; i < bufsize - len; i++) {
+    for (j = 0; j < len; j++) {
+      if ((buf[i + j] & mask[j]) != bytes[j])
+        break;
+    }
+    if (j == len)
+      return &buf[i];
+  }
+  return NULL;
+}
+
+// Searches for string in memory
+char *findString(const char *string, char *buf, uint32_t bufsize) {
+  uint32_t i;
+  const char *s, *p;
+
+  for (i = 0; i < bufsize; i++) {
+    s = string;
+    for (p = buf + i; *s && *s == *p; s++, p++)
+      ;
+    if (!*s)
+      return (buf + i);
+  }
+  return NULL;
+}
@@ -1,6 +1,8 @@
 #include "settings.h"
 #include "defaults.h"
 #include "gs.h"
+#include "handoff.h"
+#include "stats.h"
 #include <stdlib.h>
 #include <string.h>
 #define NEWLIB_PORT_AWARE
@@ -11,6 +13,29 @@ PatcherSettings settings;
 // Defined in common/defaults.h
 char cnfPath[] = CONF_PATH;
 char launcherPath[] = LAUNCHER_PATH;
+char statsPath[] = STATS_PATH;
+
+// Menu item string pool, menuItemName entries point into it.
+// Every name is followed by the item paths and arguments stored as handoff strings and an empty string
+static char *menuItemPool = NULL;
+static int poolHasItemStrings = 0;
+
+// Parent folder reference from parent_OSDSYS_ITEM_ entries
+typedef struct {
+  int item;   // Item index in the config file
+  int parent; // Parent folder index in the config file
+} folderRef;
+
+// Path or argument from path?_OSDSYS_ITEM_ and arg_OSDSYS_ITEM_ entries
+typedef struct {
+  char *value; // Points into the CNF buffer
+  int item;    // Item index in the config file
+  char type;   // HandoffStringType
+} itemStringRef;
+
+void applyLaunchStats(void);
+char *packMenuItems(char *pCNF, itemStringRef *refs, int refCount);
+void resolveMenuFolders(folderRef *refs, int refCount);
 
 // getCNFString is the main CNF parser called for each CNF variable in a CNF file.
 // Input and output data is handled via its pointer parameters.
@@ -88,7 +113,7 @@ int loadConfig(void) {
   size_t cnfSize = fioLseek(fd, 0, FIO_SEEK_END);
   fioLseek(fd, 0, FIO_SEEK_SET);
 
-  char *pCNF = (char *)malloc(cnfSize);
+  char *pCNF = (char *)malloc(cnfSize + 1);
 
   char *cnfPos = pCNF;
   if (cnfPos == NULL) {
@@ -103,6 +128,16 @@ int loadConfig(void) {
   char *name, *value;
   char valueBuf[4];
   int i, j;
+  // Allocated on the heap since loadConfig can run on the OSDSYS thread stack when reloading the config
+  folderRef *folderRefs = malloc(CUSTOM_ITEMS * sizeof(folderRef));
+  int folderRefCount = 0;
+  if (!folderRefs) {
+    free(pCNF);
+    return -1;
+  }
+  itemStringRef *itemStrings = NULL;
+  int itemStringCount = 0;
+  char *idxPtr;
   while (getCNFString(&cnfPos, &name, &value)) {
     if (!strcmp(name, "OSDSYS_menu_x")) {
       settings.menuX = atoi(value);
@@ -136,6 +171,10 @@ int loadConfig(void) {
       settings.cursorAcceleration = atoi(value);
       continue;
     }
+    if (!strcmp(name, "OSDSYS_scroll_duration")) {
+      settings.scrollDuration = atoi(value);
+      continue;
+    }
     if (!strcmp(name, "OSDSYS_left_cursor")) {
       strncpy(settings.leftCursor, value, (sizeof(settings.leftCursor) / sizeof(char)) - 1);
       continue;
@@ -182,12 +221,38 @@ int loadConfig(void) {
         continue;
 
       // Process only non-empty values
+      // Names point into the CNF buffer until packMenuItems copies them to the string pool
       j = atoi(&name[17]);
-      strncpy(settings.menuItemName[settings.menuItemCount], value, NAME_LEN - 1);
+      if (strlen(value) >= NAME_LEN)
+        value[NAME_LEN - 1] = '\0';
+      settings.menuItemName[settings.menuItemCount] = value;
       settings.menuItemIdx[settings.menuItemCount] = j;
       settings.menuItemCount++;
       continue;
     }
+    if (!strncmp(name, "parent_OSDSYS_ITEM_", 19) && (strlen(value) > 0)) {
+      if (folderRefCount == CUSTOM_ITEMS)
+        continue;
+
+      folderRefs[folderRefCount].item = atoi(&name[19]);
+      folderRefs[folderRefCount].parent = atoi(value);
+      folderRefCount++;
+      continue;
+    }
+    if ((!strncmp(name, "path", 4) || !strncmp(name, "arg", 3)) && (idxPtr = strstr(name, "_OSDSYS_ITEM_")) && (strlen(value) > 0)) {
+      // Keep item paths and arguments so the launcher doesn't have to parse the config file again
+      if (!(itemStringCount % 32)) {
+        itemStringRef *refs = realloc(itemStrings, (itemStringCount + 32) * sizeof(itemStringRef));
+        if (!refs)
+          continue;
+        itemStrings = refs;
+      }
+      itemStrings[itemStringCount].value = value;
+      itemStrings[itemStringCount].item = atoi(&idxPtr[13]);
+      itemStrings[itemStringCount].type = (name[0] == 'p') ? HANDOFF_PATH : HANDOFF_ARG;
+      itemStringCount++;
+      continue;
+    }
     if (!strcmp(name, "path_LAUNCHER_ELF")) {
       if (strlen(value) < 4 || strncmp(value, "mc", 2))
         continue; // Accept only memory card paths
@@ -258,6 +323,28 @@ int loadConfig(void) {
         settings.patcherFlags &= ~(FLAG_BROWSER_LAUNCHER);
       continue;
     }
+    if (!strcmp(name, "OSDSYS_sort_items")) {
+      settings.patcherFlags &= ~(FLAG_SORT_BY_FREQUENCY | FLAG_SORT_BY_RECENCY);
+      if (!strcmp(value, "frequency"))
+        settings.patcherFlags |= FLAG_SORT_BY_FREQUENCY;
+      else if (!strcmp(value, "recency"))
+        settings.patcherFlags |= FLAG_SORT_BY_RECENCY;
+      continue;
+    }
+    if (!strcmp(name, "OSDSYS_reload_item")) {
+      if (atoi(value))
+        settings.patcherFlags |= FLAG_RELOAD_ITEM;
+      else
+        settings.patcherFlags &= ~(FLAG_RELOAD_ITEM);
+      continue;
+    }
+    if (!strcmp(name, "OSDSYS_select_last_item")) {
+      if (atoi(value))
+        settings.patcherFlags |= FLAG_SELECT_LAST_ITEM;
+      else
+        settings.patcherFlags &= ~(FLAG_SELECT_LAST_ITEM);
+      continue;
+    }
     if (!strcmp(name, "cdrom_skip_ps2logo")) {
       if (atoi(value))
         settings.patcherFlags |= FLAG_SKIP_PS2_LOGO;
@@ -279,14 +366,222 @@ int loadConfig(void) {
         settings.patcherFlags &= ~(FLAG_USE_DKWDRV);
       continue;
     }
+    if (!strcmp(name, "launcher_full_wipe")) {
+      if (atoi(value))
+        settings.patcherFlags |= FLAG_LOADER_FULL_WIPE;
+      else
+        settings.patcherFlags &= ~(FLAG_LOADER_FULL_WIPE);
+      continue;
+    }
   }
 
-  if (pCNF != NULL)
-    free(pCNF);
+  // Copy menu item names, paths and arguments to the string pool
+  menuItemPool = packMenuItems(pCNF, itemStrings, itemStringCount);
+  free(itemStrings);
+
+  if (settings.patcherFlags & (FLAG_SORT_BY_FREQUENCY | FLAG_SORT_BY_RECENCY | FLAG_SELECT_LAST_ITEM))
+    applyLaunchStats();
+
+  // Resolve folders after the items were sorted
+  resolveMenuFolders(folderRefs, folderRefCount);
+  free(folderRefs);
 
   return 0;
 }
 
+// Reorders menu items and selects the initial item using the launch statistics file
+void applyLaunchStats(void) {
+  statsPath[2] = cnfPath[2];
+  int fd = fioOpen(statsPath, FIO_O_RDONLY);
+  if (fd < 0)
+    return;
+
+  int recordCount = fioLseek(fd, 0, FIO_SEEK_END) / sizeof(launchStatsRecord);
+  fioLseek(fd, 0, FIO_SEEK_SET);
+
+  // Per-item launch count and last launch time
+  uint32_t *launchCount = calloc(settings.menuItemCount, sizeof(uint32_t));
+  uint32_t *lastLaunch = calloc(settings.menuItemCount, sizeof(uint32_t));
+  launchStatsRecord *records = malloc(recordCount * sizeof(launchStatsRecord));
+  if (!launchCount || !lastLaunch || !records || (fioRead(fd, records, recordCount * sizeof(launchStatsRecord)) < 0))
+    goto out;
+
+  int i, j;
+  for (i = 0; i < recordCount; i++) {
+    for (j = 0; j < settings.menuItemCount; j++) {
+      if (settings.menuItemIdx[j] != records[i].itemIdx)
+        continue;
+
+      launchCount[j] += records[i].launchCount;
+      if (records[i].timestamp > lastLaunch[j])
+        lastLaunch[j] = records[i].timestamp;
+      break;
+    }
+  }
+
+  if (settings.patcherFlags & (FLAG_SORT_BY_FREQUENCY | FLAG_SORT_BY_RECENCY)) {
+    uint32_t *primaryKey = launchCount;
+    uint32_t *secondaryKey = lastLaunch;
+    if (settings.patcherFlags & FLAG_SORT_BY_RECENCY) {
+      primaryKey = lastLaunch;
+      secondaryKey = launchCount;
+    }
+
+    // Insertion sort keeps items without launches in the config file order
+    uint8_t order[CUSTOM_ITEMS];
+    int cur;
+    for (i = 0; i < settings.menuItemCount; i++) {
+      cur = i;
+      for (j = i; j > 0; j--) {
+        int prev = order[j - 1];
+        if ((primaryKey[cur] < primaryKey[prev]) || ((primaryKey[cur] == primaryKey[prev]) && (secondaryKey[cur] <= secondaryKey[prev])))
+          break;
+        order[j] = prev;
+      }
+      order[j] = cur;
+    }
+
+    // Apply the new order
+    char **names = malloc(settings.menuItemCount * sizeof(char *));
+    int *idx = malloc(settings.menuItemCount * sizeof(int));
+    uint32_t *last = malloc(settings.menuItemCount * sizeof(uint32_t));
+    if (names && idx && last) {
+      memcpy(names, settings.menuItemName, settings.menuItemCount * sizeof(char *));
+      memcpy(idx, settings.menuItemIdx, settings.menuItemCount * sizeof(int));
+      memcpy(last, lastLaunch, settings.menuItemCount * sizeof(uint32_t));
+      for (i = 0; i < settings.menuItemCount; i++) {
+        settings.menuItemName[i] = names[order[i]];
+        settings.menuItemIdx[i] = idx[order[i]];
+        lastLaunch[i] = last[order[i]];
+      }
+    }
+    if (names)
+      free(names);
+    if (idx)
+      free(idx);
+    if (last)
+      free(last);
+  }
+
+  if (settings.patcherFlags & FLAG_SELECT_LAST_ITEM) {
+    j = -1;
+    for (i = 0; i < settings.menuItemCount; i++) {
+      if (lastLaunch[i] && ((j < 0) || (lastLaunch[i] > lastLaunch[j])))
+        j = i;
+    }
+    if (j >= 0)
+      settings.initialItem = j;
+  }
+
+out:
+  fioClose(fd);
+  if (launchCount)
+    free(launchCount);
+  if (lastLaunch)
+    free(lastLaunch);
+  if (records)
+    free(records);
+}
+
+// Returns item position for the config file index or -1 if the item doesn't exist
+static int findMenuItem(int idx) {
+  for (int i = 0; i < settings.menuItemCount; i++) {
+    if (settings.menuItemIdx[i] == idx)
+      return i;
+  }
+  return -1;
+}
+
+// Sets item parents from folder references.
+// Items with missing, invalid or circular parents are kept at the top level
+void resolveMenuFolders(folderRef *refs, int refCount) {
+  int i, item, parent, depth;
+
+  for (i = 0; i < refCount; i++) {
+    if ((item = findMenuItem(refs[i].item)) < 0)
+      continue;
+    if ((parent = findMenuItem(refs[i].parent)) < 0 || (parent == item))
+      continue;
+    if (settings.menuItemName[parent][0] != MENU_FOLDER_PREFIX)
+      continue;
+
+    settings.menuItemParent[item] = parent;
+  }
+
+  // Make sure every item can be reached from the top level
+  for (i = 0; i < settings.menuItemCount; i++) {
+    parent = settings.menuItemParent[i];
+    for (depth = 0; (parent >= 0) && (depth < settings.menuItemCount); depth++)
+      parent = settings.menuItemParent[parent];
+
+    if (parent >= 0)
+      settings.menuItemParent[i] = -1;
+  }
+}
+
+// Copies menu item names followed by their paths and arguments to the string pool and frees the CNF buffer.
+// Keeps the names in the CNF buffer if the pool can't be allocated.
+// Returns the string pool or NULL if there are no menu items
+char *packMenuItems(char *pCNF, itemStringRef *refs, int refCount) {
+  size_t size = 0;
+  int i, j;
+
+  poolHasItemStrings = 0;
+  if (!settings.menuItemCount) {
+    free(pCNF);
+    return NULL;
+  }
+
+  for (i = 0; i < settings.menuItemCount; i++) {
+    size += strlen(settings.menuItemName[i]) + 2; // Name and the empty string ending the item strings
+    for (j = 0; j < refCount; j++) {
+      if (refs[j].item == settings.menuItemIdx[i])
+        size += strlen(refs[j].value) + 2;
+    }
+  }
+
+  char *pool = malloc(size);
+  if (!pool)
+    return pCNF;
+
+  char *pos = pool;
+  for (i = 0; i < settings.menuItemCount; i++) {
+    char *name = pos;
+    pos = stpcpy(pos, settings.menuItemName[i]) + 1;
+    settings.menuItemName[i] = name;
+    for (j = 0; j < refCount; j++) {
+      if (refs[j].item != settings.menuItemIdx[i])
+        continue;
+      *pos++ = refs[j].type;
+      pos = stpcpy(pos, refs[j].value) + 1;
+    }
+    *pos++ = '\0';
+  }
+
+  free(pCNF);
+  poolHasItemStrings = 1;
+  return pool;
+}
+
+// Adds paths and arguments of the config file item captured by loadConfig to the handoff block.
+// Returns the number of item paths or a negative number on error
+int loadItemHandoff(int itemIdx, handoffHeader *handoff, uint32_t maxSize) {
+  int i;
+  if (!poolHasItemStrings || ((i = findMenuItem(itemIdx)) < 0))
+    return -1;
+
+  // Item strings follow the item name and end with an empty string
+  char *str = settings.menuItemName[i] + strlen(settings.menuItemName[i]) + 1;
+  int pathCount = 0;
+  for (; *str; str += strlen(str) + 1) {
+    if (handoffAddString(handoff, maxSize, str[0], &str[1]))
+      return -1;
+    if (str[0] == HANDOFF_PATH)
+      pathCount++;
+  }
+  return pathCount;
+}
+
 // Initializes static variables
 void initVariables() {
   // Init ROMVER
@@ -311,6 +606,7 @@ void initConfig(void) {
   settings.versionY = -1;
   settings.cursorMaxVelocity = 1000;
   settings.cursorAcceleration = 100;
+  settings.scrollDuration = 150;
   settings.leftCursor[0] = '\0';
   settings.rightCursor[0] = '\0';
   settings.menuDelimiterTop[0] = '\0';
@@ -324,13 +620,21 @@ void initConfig(void) {
   settings.colorUnselected[2] = 0x33;
   settings.colorUnselected[3] = 0x80;
   settings.displayedItems = 7;
+  if (menuItemPool) {
+    free(menuItemPool);
+    menuItemPool = NULL;
+  }
+  poolHasItemStrings = 0;
   for (int i = 0; i < CUSTOM_ITEMS; i++) {
-    settings.menuItemName[i][0] = '\0';
+    settings.menuItemName[i] = NULL;
     settings.menuItemIdx[i] = 0;
+    settings.menuItemParent[i] = -1;
   }
   settings.menuItemCount = 0;
+  settings.initialItem = -1;
   strcpy(settings.launcherPath, launcherPath);
   settings.dkwdrvPath[0] = '\0'; // Can be null
+  settings.ipconfigPath[0] = '\0';
   settings.romver[0] = '\0';
   initVariables();
 }
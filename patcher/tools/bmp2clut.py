@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+# Converts 24/32-bit BMP image into a C header with 8-bit indexed pixel data and 32-bit CLUT
+# suitable for uploading to GS as PSMT8 texture with CSM1 PSMCT32 CLUT
+import struct
+import sys
+
+CLUT_SIZE = 256
+KMEANS_ITERATIONS = 8
+
+
+def readBMP(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:2] != b"BM":
+        raise ValueError("not a BMP file")
+    offset = struct.unpack_from("<I", data, 10)[0]
+    width, height, _, bpp, compression = struct.unpack_from("<iiHHI", data, 18)
+    if bpp not in (24, 32) or compression not in (0, 3):
+        raise ValueError("only uncompressed 24/32-bit BMP files are supported")
+
+    bottomUp = height > 0
+    height = abs(height)
+    stride = ((width * bpp // 8) + 3) & ~3
+    pixels = []
+    for y in range(height):
+        row = offset + (height - 1 - y if bottomUp else y) * stride
+        for x in range(width):
+            b, g, r = data[row + x * bpp // 8 : row + x * bpp // 8 + 3]
+            pixels.append((r, g, b))
+    return width, height, pixels
+
+
+def medianCut(colors, count):
+    # colors is a list of (color, weight) tuples
+    boxes = [colors]
+    while len(boxes) < count:
+        # Split the box with the largest weighted range
+        best, bestRange, bestChannel = None, -1, 0
+        for i, box in enumerate(boxes):
+            if len(box) < 2:
+                continue
+            for ch in range(3):
+                values = [c[0][ch] for c in box]
+                r = (max(values) - min(values)) * sum(c[1] for c in box)
+                if r > bestRange:
+                    best, bestRange, bestChannel = i, r, ch
+        if best is None:
+            break
+        box = sorted(boxes.pop(best), key=lambda c: c[0][bestChannel])
+        half = sum(c[1] for c in box) / 2
+        acc = 0
+        for split in range(1, len(box)):
+            acc += box[split - 1][1]
+            if acc >= half:
+                break
+        boxes += [box[:split], box[split:]]
+
+    palette = []
+    for box in boxes:
+        w = sum(c[1] for c in box)
+        palette.append(tuple(round(sum(c[0][ch] * c[1] for c in box) / w) for ch in range(3)))
+    return palette
+
+
+def nearest(palette, color):
+    return min(range(len(palette)), key=lambda i: sum((palette[i][ch] - color[ch]) ** 2 for ch in range(3)))
+
+
+def quantize(pixels):
+    counts = {}
+    for p in pixels:
+        counts[p] = counts.get(p, 0) + 1
+    colors = list(counts.items())
+    if len(colors) <= CLUT_SIZE:
+        palette = [c[0] for c in colors]
+    else:
+        palette = medianCut(colors, CLUT_SIZE)
+        # Refine the palette with k-means
+        for _ in range(KMEANS_ITERATIONS):
+            sums = [[0, 0, 0, 0] for _ in palette]
+            for color, weight in colors:
+                s = sums[nearest(palette, color)]
+                for ch in range(3):
+                    s[ch] += color[ch] * weight
+                s[3] += weight
+            palette = [tuple(round(s[ch] / s[3]) for ch in range(3)) if s[3] else palette[i] for i, s in enumerate(sums)]
+
+    mapping = {color: nearest(palette, color) for color, _ in colors}
+    return palette, [mapping[p] for p in pixels]
+
+
+def csm1Index(i):
+    # CSM1 stores entries 8-15 and 16-23 of every 32-entry block swapped
+    return (i & ~0x18) | ((i & 0x08) << 1) | ((i & 0x10) >> 1)
+
+
+def main():
+    if len(sys.argv) != 4:
+        print("usage: %s <input.bmp> <output.h> <name>" % sys.argv[0])
+        sys.exit(1)
+
+    width, height, pixels = readBMP(sys.argv[1])
+    name = sys.argv[3]
+    palette, indices = quantize(pixels)
+    palette += [(0, 0, 0)] * (CLUT_SIZE - len(palette))
+
+    # Pad the width to 16 pixels so every row is a whole number of quadwords
+    texWidth = (width + 15) & ~15
+    data = []
+    for y in range(height):
+        data += indices[y * width : (y + 1) * width] + [0] * (texWidth - width)
+
+    clut = [0] * CLUT_SIZE
+    for i, (r, g, b) in enumerate(palette):
+        clut[csm1Index(i)] = r | g << 8 | b << 16
+
+    with open(sys.argv[2], "w") as f:
+        f.write("// File generated by bmp2clut.py from %s\n" % sys.argv[1].split("/")[-1])
+        f.write("#include \"init.h\"\n#include <stdint.h>\n\n")
+        f.write("uint32_t %sWidth = %d;\n" % (name, width))
+        f.write("uint32_t %sHeight = %d;\n" % (name, height))
+        f.write("uint32_t %sTexWidth = %d; // Texture width, padded to 16 pixels\n\n" % (name, texWidth))
+        f.write("// PSMCT32 CLUT in CSM1 order\n")
+        f.write("uint32_t BOOT_DATA __attribute__((aligned(16))) %sCLUT[] = {\n" % name)
+        for i in range(0, CLUT_SIZE, 8):
+            f.write("    " + " ".join("0x%08x," % c for c in clut[i : i + 8]) + "\n")
+        f.write("};\n\n")
+        f.write("// PSMT8 pixel data\n")
+        f.write("uint8_t BOOT_DATA __attribute__((aligned(16))) %s[] = {\n" % name)
+        for i in range(0, len(data), 16):
+            f.write("    " + " ".join("0x%02x," % c for c in data[i : i + 16]) + "\n")
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# Prints the patcher memory report from the linker map file.
+# Lists code, data, bss and boot-only (.boot) sizes per object file
+# and fails if the image ends above the resident memory limit
+import re
+import sys
+
+CATEGORIES = ("code", "data", "bss", "boot")
+
+
+def category(section):
+    if section == ".boot":
+        return "boot"
+    if section == ".text":
+        return "code"
+    if section in (".sbss", ".bss"):
+        return "bss"
+    return "data"
+
+
+def parseMap(path):
+    sizes = {}
+    symbols = {}
+    outSection = None
+    pending = None
+    inMap = False
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                inMap = True
+                continue
+            if not inMap:
+                continue
+
+            m = re.match(r"^\s+0x([0-9a-f]+)\s+(\w+) = ", line)
+            if m:
+                symbols[m.group(2)] = int(m.group(1), 16)
+                continue
+
+            m = re.match(r"^(\.\S+)", line)
+            if m:
+                outSection = m.group(1)
+                continue
+
+            # Input section names longer than 14 characters are wrapped onto the next line
+            m = re.match(r"^ (\.\S+)\s*$", line)
+            if m:
+                pending = m.group(1)
+                continue
+            m = re.match(r"^ (\.\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)$", line)
+            if m and (m.group(1) or pending):
+                obj = m.group(4).split("/")[-1]
+                size = int(m.group(3), 16)
+                if outSection and size:
+                    entry = sizes.setdefault(obj, dict.fromkeys(CATEGORIES, 0))
+                    entry[category(outSection)] += size
+            pending = None
+    return sizes, symbols
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: %s <map file> <resident limit>" % sys.argv[0])
+        return 1
+
+    sizes, symbols = parseMap(sys.argv[1])
+    limit = int(sys.argv[2], 0)
+    if "_end" not in symbols or "_ftext" not in symbols:
+        print("Failed to find image boundaries in %s" % sys.argv[1])
+        return 1
+
+    print("%-32s %8s %8s %8s %8s" % (("object",) + CATEGORIES))
+    totals = dict.fromkeys(CATEGORIES, 0)
+    for obj, entry in sorted(sizes.items(), key=lambda e: -sum(e[1].values())):
+        print("%-32s %8d %8d %8d %8d" % ((obj,) + tuple(entry[c] for c in CATEGORIES)))
+        for c in CATEGORIES:
+            totals[c] += entry[c]
+    print("%-32s %8d %8d %8d %8d\n" % (("total",) + tuple(totals[c] for c in CATEGORIES)))
+
+    start, end = symbols["_ftext"], symbols["_end"]
+    bootStart, bootEnd = symbols.get("_boot_start", 0), symbols.get("_boot_end", 0)
+    print("Image:    0x%06x-0x%06x (%d bytes)" % (start, end, end - start))
+    print("Boot:     0x%06x-0x%06x (%d bytes, reused by the heap once OSDSYS starts)" % (bootStart, bootEnd, bootEnd - bootStart))
+    print("Resident: %d bytes" % (end - start - (bootEnd - bootStart)))
+    print("Headroom: %d bytes until 0x%06x" % (limit - end, limit))
+    if end > limit:
+        print("ERROR: the image exceeds the resident memory limit by %d bytes" % (end - limit))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
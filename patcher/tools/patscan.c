@@ -0,0 +1,376 @@
+// Reports OSDSYS patch pattern matches for ROM dumps
+// Takes rom0:OSDSYS ELF files or unpacked raw OSDSYS images and searches for every patcher pattern
+// in the same range as the patch does, reporting match addresses, missing and ambiguous patterns
+// and the addresses derived by the patches.
+//
+// Build from the patcher directory with the host compiler:
+//  cc -O2 -Iinclude -o patscan tools/patscan.c src/pattern_search.c
+//
+// Usage: patscan [-p] [-b <base address>] [-e <entry point>] <file> [file...]
+// -p scans the image with the protokernel patches instead of the regular ones.
+// Raw images are loaded at the base address (0x200000 by default).
+// Search ranges are relative to the OSDSYS entry point: the ELF entry point, the base address for raw images or the -e value.
+// Compressed OSDSYS ELFs can't be unpacked on the host, so only the unpacker patterns will match
+#include "patches_common.h"
+#include "pattern_search.h"
+#include "patterns_common.h"
+#include "patterns_fmcb.h"
+#include "patterns_osdmenu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// EE RAM size
+#define RAM_SIZE 0x2000000
+// Maximum number of reported matches per pattern
+#define MAX_MATCHES 4
+
+// Kernels the patcher searches the pattern on
+#define KERNEL_REGULAR 1
+#define KERNEL_PROTO 2
+
+// Search range start
+typedef enum {
+  RANGE_ABSOLUTE, // EE address
+  RANGE_ENTRY,    // Offset from the OSDSYS entry point
+  RANGE_MATCH,    // Offset from the first match of the base pattern
+  RANGE_CALL,     // Target of the jal at the offset from the first match of the base pattern
+} rangeType;
+
+typedef struct {
+  const char *name;
+  const uint32_t *pattern;
+  const uint32_t *mask;
+  uint32_t size;
+  int kernel;
+  rangeType type;
+  uint32_t offset;
+  uint32_t length;   // Search range size
+  const char *base;  // Name of the base pattern for RANGE_MATCH and RANGE_CALL
+  int matches;       // Number of matches used by the patch or 0 if the patch checks every match
+} patternEntry;
+
+#define PATTERN(p, k, ...) {#p, p, p##_mask, sizeof(p), k, __VA_ARGS__}
+#define NAMED_PATTERN(n, p, m, k, ...) {n, p, m, sizeof(p), k, __VA_ARGS__}
+
+// Every pattern is searched in the same range as the patch searching for it
+static patternEntry patterns[] = {
+    // Common
+    PATTERN(patternExecPS2, KERNEL_REGULAR, RANGE_ABSOLUTE, 0x100000, 0x1000, NULL, 1),
+    PATTERN(patternOSDSYSDeinit, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternOSDSYSProtokernelInit, KERNEL_PROTO, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    // FMCB
+    PATTERN(patternMenuInfo, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 0),
+    PATTERN(patternOSDString, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternUserInputHandler, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternDrawMenuItem, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 2),
+    PATTERN(patternDrawButtonPanel_1, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternDrawButtonPanel_2, KERNEL_REGULAR, RANGE_MATCH, 0, 0x1000, "patternDrawButtonPanel_1", 1),
+    PATTERN(patternDrawButtonPanel_3, KERNEL_REGULAR, RANGE_MATCH, 0, 0x1000, "patternDrawButtonPanel_1", 1),
+    PATTERN(patternExecuteDisc, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternDetectDisc_1, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternDetectDisc_2, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternMenuLoop, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternVideoMode, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternHDDLoad, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    NAMED_PATTERN("patternMenuLoop_Proto", patternMenuLoop_Proto, patternMenuLoop_mask, KERNEL_PROTO, RANGE_ENTRY, PROTOKERNEL_MENU_OFFSET,
+                  0x100000, NULL, 1),
+    PATTERN(patternMenuInfo_Proto, KERNEL_PROTO, RANGE_ENTRY, PROTOKERNEL_MENU_OFFSET, 0x100000, NULL, 0),
+    NAMED_PATTERN("patternUserInputHandler (proto)", patternUserInputHandler, patternUserInputHandler_mask, KERNEL_PROTO, RANGE_ENTRY,
+                  PROTOKERNEL_MENU_OFFSET, 0x100000, NULL, 1),
+    PATTERN(patternDrawMenuItem_Proto, KERNEL_PROTO, RANGE_ENTRY, PROTOKERNEL_MENU_OFFSET, 0x100000, NULL, 2),
+    PATTERN(patternExecuteDiscProto, KERNEL_PROTO, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternDrawButtonPanel_2_Proto, KERNEL_PROTO, RANGE_ENTRY, PROTOKERNEL_MENU_OFFSET, 0x100000, NULL, 1),
+    PATTERN(patternDrawButtonPanel_3_Proto, KERNEL_PROTO, RANGE_MATCH, 0, 0x100, "patternDrawButtonPanel_2_Proto", 1),
+    // OSDMenu
+    PATTERN(patternVersionInit, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternVersionStringTable, KERNEL_REGULAR, RANGE_CALL, 4, 0x200, "patternVersionInit", 1),
+    PATTERN(patternGsGetGParam, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternGsPutDispEnv, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternCdApplySCmd, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternBrowserFileMenuInit, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternBrowserSelectedMC, KERNEL_REGULAR, RANGE_CALL, 4 * 4, 0x500, "patternBrowserFileMenuInit", 1),
+    PATTERN(patternBrowserGetMcDirSize, KERNEL_REGULAR, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternVersionInit_Proto, KERNEL_PROTO, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    PATTERN(patternCdApplySCmd_Proto, KERNEL_PROTO, RANGE_ENTRY, 0, 0x100000, NULL, 1),
+    // Protokernels have three copies of sceGsPutDispEnv and the patch replaces the call in each one
+    NAMED_PATTERN("patternGsPutDispEnv (0x300000)", patternGsPutDispEnv, patternGsPutDispEnv_mask, KERNEL_PROTO, RANGE_ENTRY, 0x300000, 0x100000,
+                  NULL, 1),
+    NAMED_PATTERN("patternGsPutDispEnv (0x400000)", patternGsPutDispEnv, patternGsPutDispEnv_mask, KERNEL_PROTO, RANGE_ENTRY, 0x400000, 0x100000,
+                  NULL, 1),
+    NAMED_PATTERN("patternGsPutDispEnv (0x500000)", patternGsPutDispEnv, patternGsPutDispEnv_mask, KERNEL_PROTO, RANGE_ENTRY, 0x500000, 0x100000,
+                  NULL, 1),
+    NAMED_PATTERN("patternBrowserFileMenuInit (proto)", patternBrowserFileMenuInit, patternBrowserFileMenuInit_mask, KERNEL_PROTO, RANGE_ENTRY,
+                  PROTOKERNEL_MENU_OFFSET + 0x100000, 0x100000, NULL, 1),
+    NAMED_PATTERN("patternBrowserSelectedMC (proto)", patternBrowserSelectedMC, patternBrowserSelectedMC_mask, KERNEL_PROTO, RANGE_CALL, 4 * 4, 0x500,
+                  "patternBrowserFileMenuInit (proto)", 1),
+    NAMED_PATTERN("patternBrowserGetMcDirSize (proto)", patternBrowserGetMcDirSize, patternBrowserGetMcDirSize_mask, KERNEL_PROTO, RANGE_ENTRY,
+                  PROTOKERNEL_MENU_OFFSET + 0x100000, 0x100000, NULL, 1),
+};
+
+#define PATTERN_COUNT (sizeof(patterns) / sizeof(patternEntry))
+
+// Image loaded into emulated EE RAM
+static uint8_t *ram;
+static uint32_t imageStart, imageEnd, imageEntry;
+
+// Returns the word at EE address or 0 if the address is outside of the loaded image
+static uint32_t readWord(uint32_t addr) {
+  addr &= (RAM_SIZE - 1);
+  if ((addr < imageStart) || (addr + 4 > imageEnd))
+    return 0;
+  return *(uint32_t *)&ram[addr & ~0x3];
+}
+
+// Returns the jal target address or 0 if the instruction is not jal
+static uint32_t jalTarget(uint32_t instr) {
+  if ((instr & 0xfc000000) != 0x0c000000)
+    return 0;
+  return (instr & 0x03ffffff) << 2;
+}
+
+// Loads ELF segments or raw image into RAM and sets the entry point. Returns 0 on success
+static int loadImage(uint8_t *data, uint32_t size, uint32_t base) {
+  memset(ram, 0, RAM_SIZE);
+  imageStart = RAM_SIZE;
+  imageEnd = 0;
+
+  if ((size < 0x34) || memcmp(data, "\177ELF", 4)) {
+    // Raw image
+    if (base + size > RAM_SIZE)
+      return -1;
+    memcpy(&ram[base], data, size);
+    imageStart = base;
+    imageEnd = base + size;
+    imageEntry = base;
+    return 0;
+  }
+
+  imageEntry = *(uint32_t *)&data[0x18] & (RAM_SIZE - 1);
+  uint32_t phoff = *(uint32_t *)&data[0x1c];
+  uint16_t phentsize = *(uint16_t *)&data[0x2a];
+  uint16_t phnum = *(uint16_t *)&data[0x2c];
+  for (int i = 0; i < phnum; i++) {
+    uint8_t *ph = &data[phoff + i * phentsize];
+    if ((phoff + (i + 1) * phentsize > size) || (*(uint32_t *)ph != 1)) // PT_LOAD
+      continue;
+
+    uint32_t offset = *(uint32_t *)&ph[0x04];
+    uint32_t vaddr = *(uint32_t *)&ph[0x08] & (RAM_SIZE - 1);
+    uint32_t filesz = *(uint32_t *)&ph[0x10];
+    uint32_t memsz = *(uint32_t *)&ph[0x14];
+    if ((offset + filesz > size) || (vaddr + memsz > RAM_SIZE))
+      return -1;
+
+    memcpy(&ram[vaddr], &data[offset], filesz);
+    if (vaddr < imageStart)
+      imageStart = vaddr;
+    if (vaddr + memsz > imageEnd)
+      imageEnd = vaddr + memsz;
+  }
+  return (imageEnd > imageStart) ? 0 : -1;
+}
+
+// Finds up to MAX_MATCHES matches in the range clamped to the image. Returns the total number of matches
+static int findAll(patternEntry *p, uint32_t start, uint32_t end, uint32_t *matches) {
+  uint8_t *ptr;
+  int count = 0;
+
+  if (start < imageStart)
+    start = imageStart;
+  if (end > imageEnd)
+    end = imageEnd;
+  while ((start < end) && (ptr = findPatternWithMask(&ram[start], end - start, (uint8_t *)p->pattern, (uint8_t *)p->mask, p->size))) {
+    if (count < MAX_MATCHES)
+      matches[count] = ptr - ram;
+    count++;
+    start = (ptr - ram) + 4;
+  }
+  return count;
+}
+
+static int getPattern(const char *name) {
+  for (int i = 0; i < PATTERN_COUNT; i++)
+    if (!strcmp(patterns[i].name, name))
+      return i;
+  return -1;
+}
+
+// Returns the search range start for the pattern or 0 if the base pattern or the function call is missing
+static uint32_t rangeStart(patternEntry *p, uint32_t *firstMatch) {
+  uint32_t addr;
+  switch (p->type) {
+  case RANGE_ABSOLUTE:
+    return p->offset;
+  case RANGE_ENTRY:
+    return imageEntry + p->offset;
+  case RANGE_MATCH:
+    addr = firstMatch[getPattern(p->base)];
+    return addr ? addr + p->offset : 0;
+  case RANGE_CALL:
+    addr = firstMatch[getPattern(p->base)];
+    return addr ? jalTarget(readWord(addr + p->offset)) : 0;
+  }
+  return 0;
+}
+
+// Reports the addresses derived by patchBrowserApplicationLaunch and the protokernel init injection site
+static void reportDerived(uint32_t *firstMatch, int kernel) {
+  uint32_t addr, target;
+
+  printf(" Derived addresses:\n");
+  if ((addr = firstMatch[getPattern("patternOSDSYSProtokernelInit")]))
+    printf("  Protokernel init injection site: 0x%08x\n", addr + 0x3c);
+
+  int isProtokernel = (kernel == KERNEL_PROTO);
+  if ((addr = firstMatch[getPattern(isProtokernel ? "patternBrowserSelectedMC (proto)" : "patternBrowserSelectedMC")]))
+    printf("  Selected memory card offset: 0x%04x\n", readWord(addr) & 0xffff);
+
+  if (!(addr = firstMatch[getPattern(isProtokernel ? "patternBrowserGetMcDirSize (proto)" : "patternBrowserGetMcDirSize")]))
+    return;
+  target = jalTarget(readWord(addr));
+  printf("  browserGetMcDirSize: 0x%08x (called from 0x%08x)\n", target, addr);
+  if (isProtokernel)
+    return;
+
+  // Trace the sceMcGetDir result buffer address the same way patchBrowserApplicationLaunch does
+  uint32_t limit = target + 0x400;
+  while ((target < limit) && !jalTarget(readWord(target)))
+    target += 4;
+  if (!(target = jalTarget(readWord(target)))) {
+    printf("  sceMcGetDir result buffer: failed to find the function call\n");
+    return;
+  }
+
+  uint32_t result = 0xc38;
+  for (limit = target + 0x400; (target < limit) && ((readWord(target) & 0x3c020000) != 0x3c020000); target += 4)
+    ;
+  if (target >= limit) {
+    printf("  sceMcGetDir result buffer: failed to find lui v0\n");
+    return;
+  }
+  result |= (readWord(target) & 0xffff) << 16;
+  for (; (target < limit) && ((readWord(target) & 0x24510000) != 0x24510000); target += 4)
+    ;
+  if (target >= limit) {
+    printf("  sceMcGetDir result buffer: failed to find addiu s1,v0\n");
+    return;
+  }
+  result += (int32_t)((int16_t)(readWord(target) & 0xffff));
+  printf("  sceMcGetDir result buffer: 0x%08x\n", result);
+}
+
+static int scanFile(const char *path, uint32_t base, uint32_t entry, int kernel) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "%s: failed to open\n", path);
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  uint8_t *data = malloc(size);
+  if (!data || (fread(data, 1, size, f) != size)) {
+    fprintf(stderr, "%s: failed to read\n", path);
+    fclose(f);
+    free(data);
+    return -1;
+  }
+  fclose(f);
+
+  int res = loadImage(data, size, base);
+  free(data);
+  if (res) {
+    fprintf(stderr, "%s: invalid image\n", path);
+    return -1;
+  }
+  if (entry)
+    imageEntry = entry;
+
+  printf("%s: 0x%08x-0x%08x, entry point 0x%08x, %s\n", path, imageStart, imageEnd, imageEntry,
+         (kernel == KERNEL_PROTO) ? "protokernel" : "regular kernel");
+
+  struct timespec startTime, endTime;
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+  // Patterns are listed after their base patterns, so the base match is always known
+  uint32_t matches[MAX_MATCHES];
+  uint32_t firstMatch[PATTERN_COUNT] = {0};
+  int scanned = 0, missing = 0, ambiguous = 0;
+  for (int i = 0; i < PATTERN_COUNT; i++) {
+    patternEntry *p = &patterns[i];
+    if (!(p->kernel & kernel))
+      continue;
+    scanned++;
+
+    printf("  %-36s ", p->name);
+    uint32_t start = rangeStart(p, firstMatch);
+    if (!start) {
+      missing++;
+      printf("MISSING (no %s)\n", p->base);
+      continue;
+    }
+
+    int count = findAll(p, start, start + p->length, matches);
+    firstMatch[i] = count ? matches[0] : 0;
+    if (!count) {
+      missing++;
+      printf("MISSING in 0x%08x-0x%08x\n", start, start + p->length);
+      continue;
+    }
+    if (p->matches && (count != p->matches)) {
+      if (count < p->matches)
+        missing++;
+      else
+        ambiguous++;
+      printf("%s (%d of %d):", (count < p->matches) ? "MISSING" : "AMBIGUOUS", count, p->matches);
+    }
+    for (int j = 0; j < count && j < MAX_MATCHES; j++)
+      printf(" 0x%08x", matches[j]);
+    printf((count > MAX_MATCHES) ? " ...\n" : "\n");
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+  reportDerived(firstMatch, kernel);
+  printf(" %d patterns, %d missing, %d ambiguous, scanned in %.2f ms\n\n", scanned, missing, ambiguous,
+         (endTime.tv_sec - startTime.tv_sec) * 1000.0 + (endTime.tv_nsec - startTime.tv_nsec) / 1000000.0);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t base = 0x200000;
+  uint32_t entry = 0;
+  int kernel = KERNEL_REGULAR;
+  int i = 1;
+
+  for (; i < argc; i++) {
+    if (!strcmp(argv[i], "-p"))
+      kernel = KERNEL_PROTO;
+    else if (!strcmp(argv[i], "-b") && (i + 1 < argc))
+      base = strtoul(argv[++i], NULL, 0) & (RAM_SIZE - 1) & ~0x3;
+    else if (!strcmp(argv[i], "-e") && (i + 1 < argc))
+      entry = strtoul(argv[++i], NULL, 0) & (RAM_SIZE - 1) & ~0x3;
+    else
+      break;
+  }
+  if (i >= argc) {
+    fprintf(stderr, "Usage: %s [-p] [-b <base address>] [-e <entry point>] <OSDSYS ELF or raw image> [file...]\n", argv[0]);
+    return 1;
+  }
+
+  if (!(ram = malloc(RAM_SIZE))) {
+    fprintf(stderr, "Failed to allocate memory\n");
+    return 1;
+  }
+
+  int res = 0;
+  for (; i < argc; i++)
+    if (scanFile(argv[i], base, entry, kernel))
+      res = 1;
+
+  free(ram);
+  return res;
+}
@@ -0,0 +1,131 @@
+// Decodes boot trace files (mc?:/SYS-CONF/OSDMENU.TRC) into per-phase timelines
+// Prints every block written by the patcher and the launcher with event times relative to the first event
+// in the block, the duration of every finished phase and the per-phase totals.
+//
+// Build from the patcher directory with the host compiler:
+//  cc -O2 -I../common -o tracedump tools/tracedump.c
+//
+// Usage: tracedump <file>
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+
+// Event timestamps count 256 EE cycles (294.912 MHz), which is exactly 125/144 us
+#define TICKS_TO_US(ticks) ((uint64_t)(ticks) * 125 / 144)
+
+static const char *phaseNames[] = {
+    [TRACE_PATCHER_MAIN] = "patcher_main", [TRACE_LOAD_CONFIG] = "load_config", [TRACE_SPLASH] = "splash",
+    [TRACE_PATCH_OSDSYS] = "patch_osdsys", [TRACE_LAUNCH_ITEM] = "launch_item", [TRACE_LAUNCHER_MAIN] = "launcher_main",
+    [TRACE_INIT_MODULES] = "init_modules", [TRACE_BDM_WAIT] = "bdm_wait",       [TRACE_DISC_READY] = "disc_ready",
+    [TRACE_LOAD_ELF] = "load_elf",
+};
+#define PHASE_COUNT (sizeof(phaseNames) / sizeof(phaseNames[0]))
+
+static const char *sourceNames[] = {"patcher", "launcher"};
+
+// Returns the phase name or NULL for unknown phases
+static const char *phaseName(uint8_t phase) {
+  if (phase >= PHASE_COUNT)
+    return NULL;
+  return phaseNames[phase];
+}
+
+// Formats time in milliseconds
+static char *formatTime(char *buf, uint64_t us) {
+  sprintf(buf, "%llu.%03llu ms", (unsigned long long)(us / 1000), (unsigned long long)(us % 1000));
+  return buf;
+}
+
+// Prints the block timeline and phase totals
+static void printBlock(int idx, traceBlockHeader *header, traceEvent *events) {
+  uint32_t beginTime[PHASE_COUNT];
+  uint64_t totalTime[PHASE_COUNT];
+  int isOpen[PHASE_COUNT];
+  int wasClosed[PHASE_COUNT];
+  char time[32];
+  memset(isOpen, 0, sizeof(isOpen));
+  memset(wasClosed, 0, sizeof(wasClosed));
+  memset(totalTime, 0, sizeof(totalTime));
+
+  const char *source = (header->source < 2) ? sourceNames[header->source] : "unknown";
+  printf("block %d: %s, %u events\n", idx, source, header->eventCount);
+
+  for (int i = 0; i < header->eventCount; i++) {
+    traceEvent *event = &events[i];
+    const char *name = phaseName(event->phase);
+    char unknown[16];
+    if (!name) {
+      snprintf(unknown, sizeof(unknown), "phase_%u", event->phase);
+      name = unknown;
+    }
+
+    // Timestamps are unsigned and wrap around, so the difference is correct as long as events are in order
+    printf("  %12s", formatTime(time, TICKS_TO_US(event->timestamp - events[0].timestamp)));
+
+    switch (event->type) {
+    case TRACE_EVENT_BEGIN:
+      printf("  begin %s (%u)\n", name, event->arg);
+      if (event->phase < PHASE_COUNT) {
+        beginTime[event->phase] = event->timestamp;
+        isOpen[event->phase] = 1;
+      }
+      break;
+    case TRACE_EVENT_END:
+      printf("  end   %s (%u)", name, event->arg);
+      if ((event->phase < PHASE_COUNT) && isOpen[event->phase]) {
+        uint64_t us = TICKS_TO_US(event->timestamp - beginTime[event->phase]);
+        printf(", took %s", formatTime(time, us));
+        totalTime[event->phase] += us;
+        isOpen[event->phase] = 0;
+        wasClosed[event->phase] = 1;
+      }
+      printf("\n");
+      break;
+    case TRACE_EVENT_MARK:
+      printf("  mark  %s (%u)\n", name, event->arg);
+      break;
+    default:
+      printf("  event %u %s (%u)\n", event->type, name, event->arg);
+    }
+  }
+
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    if (wasClosed[i])
+      printf("  total %-14s %s\n", phaseNames[i], formatTime(time, totalTime[i]));
+    if (isOpen[i])
+      printf("  total %-14s unfinished\n", phaseNames[i]);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+    return 1;
+  }
+
+  FILE *f = fopen(argv[1], "rb");
+  if (!f) {
+    fprintf(stderr, "Failed to open %s\n", argv[1]);
+    return 1;
+  }
+
+  traceBlockHeader header;
+  traceEvent events[TRACE_MAX_EVENTS];
+  int idx = 0, res = 0;
+  while (fread(&header, sizeof(header), 1, f) == 1) {
+    if ((header.magic != TRACE_MAGIC) || (header.eventCount > TRACE_MAX_EVENTS)) {
+      fprintf(stderr, "Invalid block header at offset %ld\n", ftell(f) - (long)sizeof(header));
+      res = 1;
+      break;
+    }
+    if (fread(events, sizeof(traceEvent), header.eventCount, f) != header.eventCount) {
+      fprintf(stderr, "Block %d is truncated\n", idx);
+      res = 1;
+      break;
+    }
+    printBlock(idx++, &header, events);
+  }
+
+  fclose(f);
+  return res;
+}
@@ -0,0 +1,12 @@
+// Host stand-in for the PS2SDK debug.h
+#ifndef _SHIM_DEBUG_H_
+#define _SHIM_DEBUG_H_
+
+#include <stdarg.h>
+
+void init_scr(void);
+void scr_setCursor(int enable);
+void scr_printf(const char *format, ...);
+void scr_vprintf(const char *format, va_list args);
+
+#endif
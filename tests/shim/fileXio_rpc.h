@@ -0,0 +1,13 @@
+// Host stand-in for the PS2SDK fileXio_rpc.h
+// Device paths are mapped to host files by shimHostPath()
+#ifndef _SHIM_FILEXIO_RPC_H_
+#define _SHIM_FILEXIO_RPC_H_
+
+int fileXioInit(void);
+void fileXioExit(void);
+int fileXioOpen(const char *source, int flags, ...);
+int fileXioClose(int fd);
+int fileXioRead(int fd, void *buf, int size);
+int fileXioLseek(int fd, int offset, int whence);
+
+#endif
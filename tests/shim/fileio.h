@@ -0,0 +1,25 @@
+// Host stand-in for the PS2SDK fileio.h
+// Device paths are mapped to host files by shimHostPath()
+#ifndef _SHIM_FILEIO_H_
+#define _SHIM_FILEIO_H_
+
+#define FIO_O_RDONLY 0x0001
+#define FIO_O_WRONLY 0x0002
+#define FIO_O_RDWR 0x0003
+#define FIO_O_APPEND 0x0100
+#define FIO_O_CREAT 0x0200
+#define FIO_O_TRUNC 0x0400
+
+#define FIO_SEEK_SET 0
+#define FIO_SEEK_CUR 1
+#define FIO_SEEK_END 2
+
+int fioOpen(const char *name, int mode);
+int fioClose(int fd);
+int fioRead(int fd, void *ptr, int size);
+int fioWrite(int fd, const void *ptr, int size);
+int fioLseek(int fd, int offset, int whence);
+int fioMkdir(const char *path);
+int fioRemove(const char *name);
+
+#endif
@@ -0,0 +1,40 @@
+// Host stand-in for the PS2SDK kernel.h
+// EE memory accessors work on the EE RAM mapped by eeRamInit()
+#ifndef _SHIM_KERNEL_H_
+#define _SHIM_KERNEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+
+static inline uint8_t _lb(uint32_t addr) { return *(volatile uint8_t *)(uintptr_t)addr; }
+static inline uint16_t _lh(uint32_t addr) { return *(volatile uint16_t *)(uintptr_t)addr; }
+static inline uint32_t _lw(uint32_t addr) { return *(volatile uint32_t *)(uintptr_t)addr; }
+static inline void _sb(uint8_t val, uint32_t addr) { *(volatile uint8_t *)(uintptr_t)addr = val; }
+static inline void _sh(uint16_t val, uint32_t addr) { *(volatile uint16_t *)(uintptr_t)addr = val; }
+static inline void _sw(uint32_t val, uint32_t addr) { *(volatile uint32_t *)(uintptr_t)addr = val; }
+
+void FlushCache(int operation);
+int ExecPS2(void *entry, void *gp, int argc, char **argv);
+int LoadExecPS2(const char *filename, int argc, char **argv);
+void Exit(int status);
+uint32_t GetCop0(int reg);
+void *GetSyscallHandler(int syscall);
+void SetSyscall(int syscall, void *handler);
+int DisableIntc(int cause);
+int GetThreadId(void);
+int ChangeThreadPriority(int thread_id, int priority);
+int CancelWakeupThread(int thread_id);
+int TerminateThread(int thread_id);
+int DeleteThread(int thread_id);
+void ResetEE(uint32_t init_bitfield);
+
+#endif
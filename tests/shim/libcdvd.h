@@ -0,0 +1,30 @@
+// Host stand-in for the PS2SDK libcdvd.h
+#ifndef _SHIM_LIBCDVD_H_
+#define _SHIM_LIBCDVD_H_
+
+#include <stdint.h>
+
+enum SCECdvdInitMode {
+  SCECdINIT = 0,
+  SCECdINoD,
+  SCECdEXIT = 5,
+};
+
+typedef struct {
+  uint8_t stat;
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t pad;
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+} sceCdCLOCK;
+
+// Converts a BCD value to binary
+#define btoi(b) ((b) / 16 * 10 + (b) % 16)
+
+int sceCdInit(int mode);
+int sceCdReadClock(sceCdCLOCK *clock);
+
+#endif
@@ -0,0 +1,17 @@
+// Host stand-in for the PS2SDK libmc.h
+#ifndef _SHIM_LIBMC_H_
+#define _SHIM_LIBMC_H_
+
+#define MC_TYPE_XMC 1
+
+#define sceMcTypeNoCard 0
+#define sceMcTypePS2 2
+
+#define MC_FORMATTED 1
+
+int mcInit(int type);
+int mcGetInfo(int port, int slot, int *type, int *free, int *format);
+int mcSync(int mode, int *cmd, int *result);
+int mcReset(void);
+
+#endif
@@ -0,0 +1,17 @@
+// Host stand-in for the PS2SDK loadfile.h
+#ifndef _SHIM_LOADFILE_H_
+#define _SHIM_LOADFILE_H_
+
+typedef struct {
+  int epc;
+  int gp;
+  int sp;
+  int dummy;
+} t_ExecData;
+
+int SifLoadFileInit(void);
+void SifLoadFileExit(void);
+int SifLoadElf(const char *path, t_ExecData *data);
+int SifLoadModule(const char *path, int arg_len, const char *args);
+
+#endif
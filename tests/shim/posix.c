@@ -0,0 +1,71 @@
+// Host wrappers for the POSIX functions used by the launcher.
+// Test programs are linked with -Wl,--wrap for open, fopen, write and mkdir, so device paths
+// (e.g. "mc0:/SYS-CONF/OSDMENU.APP") are redirected to the host directory set with shimSetRoot
+// and written bytes are counted. Tests that simulate time also wrap usleep
+#define _GNU_SOURCE
+#include "shim.h"
+#include "clock.h"
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int __real_open(const char *path, int flags, ...);
+FILE *__real_fopen(const char *path, const char *mode);
+ssize_t __real_write(int fd, const void *buf, size_t count);
+int __real_mkdir(const char *path, mode_t mode);
+
+int __wrap_open(const char *path, int flags, ...) {
+  if (!strchr(path, ':'))
+    return __real_open(path, flags, 0644);
+
+  if (shimOpenTicks)
+    shimAdvance(shimOpenTicks);
+
+  const char *hostPath = shimHostPath(path);
+  if (flags & O_CREAT)
+    shimCreateParents(hostPath);
+
+  int fd = __real_open(hostPath, flags, 0644);
+  if (fd < 0)
+    shimIO.failedOpens++;
+  else
+    shimIO.opens++;
+  return fd;
+}
+
+FILE *__wrap_fopen(const char *path, const char *mode) {
+  if (!strchr(path, ':'))
+    return __real_fopen(path, mode);
+
+  FILE *f = __real_fopen(shimHostPath(path), mode);
+  if (!f)
+    shimIO.failedOpens++;
+  else
+    shimIO.opens++;
+  return f;
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t count) {
+  ssize_t res = __real_write(fd, buf, count);
+  if (res > 0)
+    shimIO.bytesWritten += res;
+  return res;
+}
+
+int __wrap_mkdir(const char *path, mode_t mode) {
+  if (!strchr(path, ':'))
+    return __real_mkdir(path, mode);
+
+  const char *hostPath = shimHostPath(path);
+  shimCreateParents(hostPath);
+  return __real_mkdir(hostPath, mode);
+}
+
+// Advances the simulated time instead of sleeping
+int __wrap_usleep(unsigned int usec) {
+  shimAdvance((uint64_t)usec * CLOCK_TICKS_PER_MS / 1000);
+  return 0;
+}
@@ -0,0 +1,369 @@
+// Host implementations of the PS2SDK functions used by the tested code
+#define _GNU_SOURCE
+#include "shim.h"
+#include <debug.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fileXio_rpc.h>
+#include <fileio.h>
+#include <kernel.h>
+#include <libcdvd.h>
+#include <libmc.h>
+#include <loadfile.h>
+#include <malloc.h>
+#include <sifrpc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+shimIOStats shimIO;
+shimExecState shimExec;
+jmp_buf *shimExitJump = NULL;
+uint32_t shimCount = 0;
+uint32_t shimCountStep = 0;
+uint64_t shimTicks = 0;
+uint32_t shimOpenTicks = 0;
+void (*shimTimeHook)(void) = NULL;
+sceCdCLOCK shimCdClock;
+
+static char shimRoot[512] = "build/fs";
+
+//
+// EE RAM
+//
+
+void eeRamInit(void) {
+  static int mapped = 0;
+  if (mapped)
+    return;
+
+  // The tested code casts pointers to 32-bit EE addresses.
+  // Test binaries are linked below 4 GiB and all allocations are kept on the heap below it
+  mallopt(M_MMAP_MAX, 0);
+  void *ram = mmap((void *)EE_RAM_START, EE_RAM_END - EE_RAM_START, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                   -1, 0);
+  if (ram != (void *)EE_RAM_START) {
+    fprintf(stderr, "failed to map EE RAM at 0x%08x\n", EE_RAM_START);
+    exit(1);
+  }
+  mapped = 1;
+}
+
+void eeRamClear(uint32_t start, uint32_t end) { memset((void *)(uintptr_t)start, 0, end - start); }
+
+//
+// Host files
+//
+
+void shimCreateParents(const char *hostPath) {
+  char buf[1024];
+  strncpy(buf, hostPath, sizeof(buf) - 1);
+  buf[sizeof(buf) - 1] = '\0';
+  for (char *p = buf + 1; *p; p++) {
+    if (*p != '/')
+      continue;
+    *p = '\0';
+    mkdir(buf, 0755);
+    *p = '/';
+  }
+}
+
+void shimSetRoot(const char *root) {
+  char cmd[1100];
+  snprintf(shimRoot, sizeof(shimRoot), "%s", root);
+  snprintf(cmd, sizeof(cmd), "rm -rf '%s' && mkdir -p '%s'", shimRoot, shimRoot);
+  if (system(cmd)) {
+    fprintf(stderr, "failed to prepare %s\n", shimRoot);
+    exit(1);
+  }
+}
+
+// Maps "dev:/path" and "dev:path" to "<root>/dev/path"
+const char *shimHostPath(const char *path) {
+  static char hostPath[2][1024];
+  static int cur = 0;
+  char *buf = hostPath[cur];
+  cur ^= 1; // Allows using two paths at once
+
+  const char *sep = strchr(path, ':');
+  if (!sep) {
+    snprintf(buf, sizeof(hostPath[0]), "%s/%s", shimRoot, path);
+    return buf;
+  }
+
+  const char *rest = sep + 1;
+  while (*rest == '/')
+    rest++;
+  snprintf(buf, sizeof(hostPath[0]), "%s/%.*s/%s", shimRoot, (int)(sep - path), path, rest);
+  return buf;
+}
+
+void shimWriteFile(const char *path, const void *data, size_t size) {
+  const char *hostPath = shimHostPath(path);
+  shimCreateParents(hostPath);
+  FILE *f = fopen(hostPath, "wb");
+  if (!f || (fwrite(data, 1, size, f) != size)) {
+    fprintf(stderr, "failed to write %s\n", hostPath);
+    exit(1);
+  }
+  fclose(f);
+}
+
+int shimReadFile(const char *path, void *data, size_t size) {
+  FILE *f = fopen(shimHostPath(path), "rb");
+  if (!f)
+    return -1;
+  size_t res = fread(data, 1, size, f);
+  fseek(f, 0, SEEK_END);
+  int fileSize = ftell(f);
+  fclose(f);
+  return (res <= fileSize) ? fileSize : -1;
+}
+
+void shimResetIO(void) { memset(&shimIO, 0, sizeof(shimIO)); }
+
+//
+// fileio.h
+//
+
+int fioOpen(const char *name, int mode) {
+  int flags = 0;
+  switch (mode & FIO_O_RDWR) {
+  case FIO_O_WRONLY:
+    flags = O_WRONLY;
+    break;
+  case FIO_O_RDWR:
+    flags = O_RDWR;
+    break;
+  default:
+    flags = O_RDONLY;
+  }
+  if (mode & FIO_O_APPEND)
+    flags |= O_APPEND;
+  if (mode & FIO_O_CREAT)
+    flags |= O_CREAT;
+  if (mode & FIO_O_TRUNC)
+    flags |= O_TRUNC;
+
+  const char *hostPath = shimHostPath(name);
+  if (mode & FIO_O_CREAT)
+    shimCreateParents(hostPath);
+
+  int fd = open(hostPath, flags, 0644);
+  if (fd < 0) {
+    shimIO.failedOpens++;
+    return -ENOENT;
+  }
+  shimIO.opens++;
+  return fd;
+}
+
+int fioClose(int fd) { return close(fd); }
+
+int fioRead(int fd, void *ptr, int size) {
+  int res = read(fd, ptr, size);
+  if (res > 0)
+    shimIO.bytesRead += res;
+  return res;
+}
+
+int fioWrite(int fd, const void *ptr, int size) {
+  int res = write(fd, ptr, size);
+  if (res > 0)
+    shimIO.bytesWritten += res;
+  return res;
+}
+
+int fioLseek(int fd, int offset, int whence) { return lseek(fd, offset, whence); }
+
+int fioMkdir(const char *path) {
+  const char *hostPath = shimHostPath(path);
+  shimCreateParents(hostPath);
+  return mkdir(hostPath, 0755);
+}
+
+int fioRemove(const char *name) { return unlink(shimHostPath(name)); }
+
+//
+// fileXio_rpc.h
+//
+
+int fileXioInit(void) { return 0; }
+
+void fileXioExit(void) {}
+
+int fileXioOpen(const char *source, int flags, ...) {
+  int fd = open(shimHostPath(source), flags);
+  if (fd < 0)
+    shimIO.failedOpens++;
+  else
+    shimIO.opens++;
+  return fd;
+}
+
+int fileXioClose(int fd) { return close(fd); }
+
+int fileXioRead(int fd, void *buf, int size) {
+  int res = read(fd, buf, size);
+  if (res > 0)
+    shimIO.bytesRead += res;
+  return res;
+}
+
+int fileXioLseek(int fd, int offset, int whence) { return lseek(fd, offset, whence); }
+
+//
+// kernel.h and loadfile.h
+//
+
+void FlushCache(int operation) {}
+
+// Stores the arguments and leaves the tested code
+static void recordExec(void *entry, void *gp, int argc, char **argv) {
+  shimExec.calls++;
+  shimExec.entry = entry;
+  shimExec.gp = gp;
+  shimExec.argc = argc;
+  for (int i = 0; (i < argc) && (i < 8); i++)
+    snprintf(shimExec.argv[i], sizeof(shimExec.argv[i]), "%s", argv[i]);
+
+  if (shimExitJump)
+    longjmp(*shimExitJump, 1);
+}
+
+int ExecPS2(void *entry, void *gp, int argc, char **argv) {
+  recordExec(entry, gp, argc, argv);
+  fprintf(stderr, "unexpected ExecPS2\n");
+  abort();
+}
+
+int LoadExecPS2(const char *filename, int argc, char **argv) {
+  char *args[9] = {(char *)filename};
+  for (int i = 0; (i < argc) && (i < 8); i++)
+    args[i + 1] = argv[i];
+  recordExec(NULL, NULL, argc + 1, args);
+  fprintf(stderr, "unexpected LoadExecPS2\n");
+  abort();
+}
+
+void Exit(int status) {
+  if (shimExitJump)
+    longjmp(*shimExitJump, 2);
+  fprintf(stderr, "unexpected Exit(%d)\n", status);
+  abort();
+}
+
+uint32_t GetCop0(int reg) { return (reg == 15) ? 0x2e20 : 0; } // PRId for EE 2.0
+
+void *GetSyscallHandler(int syscall) { return NULL; }
+
+void SetSyscall(int syscall, void *handler) {}
+
+int DisableIntc(int cause) { return 1; }
+
+int GetThreadId(void) { return 1; }
+
+int ChangeThreadPriority(int thread_id, int priority) { return 0; }
+
+int CancelWakeupThread(int thread_id) { return 0; }
+
+int TerminateThread(int thread_id) { return 0; }
+
+int DeleteThread(int thread_id) { return 0; }
+
+void ResetEE(uint32_t init_bitfield) {}
+
+int shimLoadElfCalls = 0;
+uint32_t shimLoadElfEntry = 0;
+
+int SifLoadFileInit(void) { return 0; }
+
+void SifLoadFileExit(void) {}
+
+int SifLoadElf(const char *path, t_ExecData *data) {
+  shimLoadElfCalls++;
+  if (!shimLoadElfEntry)
+    return -1;
+  memset(data, 0, sizeof(*data));
+  data->epc = shimLoadElfEntry;
+  return 0;
+}
+
+int SifLoadModule(const char *path, int arg_len, const char *args) { return 0; }
+
+//
+// sifrpc.h
+//
+
+void SifInitRpc(int mode) {}
+
+void sceSifExitRpc(void) {}
+
+void init_scr(void) {}
+
+void scr_setCursor(int enable) {}
+
+void scr_printf(const char *format, ...) {}
+
+void scr_vprintf(const char *format, va_list args) {}
+
+//
+// libcdvd.h
+//
+
+int sceCdInit(int mode) { return 1; }
+
+int sceCdReadClock(sceCdCLOCK *clock) {
+  *clock = shimCdClock;
+  return 1;
+}
+
+//
+// libmc.h
+//
+
+int shimMcType[2] = {sceMcTypePS2, sceMcTypePS2};
+
+int mcInit(int type) { return 0; }
+
+int mcGetInfo(int port, int slot, int *type, int *free, int *format) {
+  if (type)
+    *type = shimMcType[port & 1];
+  if (format)
+    *format = (shimMcType[port & 1] == sceMcTypePS2) ? MC_FORMATTED : 0;
+  return 0;
+}
+
+int mcSync(int mode, int *cmd, int *result) {
+  if (result)
+    *result = 0;
+  return 1;
+}
+
+int mcReset(void) { return 0; }
+
+//
+// clock.h
+//
+
+uint32_t readCount(void) {
+  uint32_t count = shimCount;
+  shimCount += shimCountStep;
+  return count;
+}
+
+void shimAdvance(uint64_t ticks) {
+  shimCount += ticks;
+  shimTicks += ticks;
+  if (shimTimeHook)
+    shimTimeHook();
+}
+
+void shimResetTime(void) {
+  shimTicks = 0;
+  shimOpenTicks = 0;
+  shimTimeHook = NULL;
+}
@@ -0,0 +1,15 @@
+// Host stand-in for the PS2SDK ps2sdkapi.h
+#ifndef _SHIM_PS2SDKAPI_H_
+#define _SHIM_PS2SDKAPI_H_
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// libc configuration macros
+#define DISABLE_PATCHED_FUNCTIONS()
+#define DISABLE_EXTRA_TIMERS_FUNCTIONS()
+#define PS2_DISABLE_AUTOSTART_PTHREAD()
+
+#endif
@@ -0,0 +1,76 @@
+// Test-side control of the host PS2SDK stand-ins
+#ifndef _SHIM_H_
+#define _SHIM_H_
+
+#include <libcdvd.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// EE RAM mapped at its PS2 address. Starts above the host NULL guard
+#define EE_RAM_START 0x00010000
+#define EE_RAM_END 0x02000000
+
+// Maps EE RAM. Must be called before touching any EE address
+void eeRamInit(void);
+// Clears EE RAM in the given range
+void eeRamClear(uint32_t start, uint32_t end);
+
+// Sets the host directory backing the device paths (e.g. "mc0:/SYS-CONF" maps to "<root>/mc0/SYS-CONF").
+// Removes all files previously created in it
+void shimSetRoot(const char *root);
+// Returns the host path for the device path
+const char *shimHostPath(const char *path);
+// Creates all parent directories of the host path
+void shimCreateParents(const char *hostPath);
+// Creates the file with the given contents, creating the parent directories as needed
+void shimWriteFile(const char *path, const void *data, size_t size);
+// Reads up to size bytes of the file into data. Returns the file size or -1 if the file doesn't exist
+int shimReadFile(const char *path, void *data, size_t size);
+
+// Counters for the file operations since the last shimResetIO call
+typedef struct {
+  int opens;        // Successful fioOpen and fileXioOpen calls
+  int failedOpens;  // fioOpen and fileXioOpen calls on missing files
+  int bytesRead;    // Bytes returned by fioRead and fileXioRead
+  int bytesWritten; // Bytes written by fioWrite and write
+} shimIOStats;
+extern shimIOStats shimIO;
+void shimResetIO(void);
+
+// Arguments of the last ExecPS2/LoadExecPS2 call
+typedef struct {
+  int calls;
+  void *entry;
+  void *gp;
+  int argc;
+  char argv[8][256];
+} shimExecState;
+extern shimExecState shimExec;
+
+// Number of SifLoadElf calls. SifLoadElf fails unless shimLoadElfEntry is set
+extern int shimLoadElfCalls;
+// Entry point returned by SifLoadElf
+extern uint32_t shimLoadElfEntry;
+
+// ExecPS2, LoadExecPS2 and Exit never return. If shimExitJump is set, they jump to it
+extern jmp_buf *shimExitJump;
+
+// Value returned by readCount and added to the counter after every read
+extern uint32_t shimCount;
+extern uint32_t shimCountStep;
+
+// Real-time clock value returned by sceCdReadClock, in BCD
+extern sceCdCLOCK shimCdClock;
+
+// Memory card types reported by mcGetInfo for mc0 and mc1
+extern int shimMcType[2];
+
+// Simulated time for the launcher tests. usleep (if wrapped) and every open advance shimCount instead of waiting
+extern uint64_t shimTicks;         // Total ticks added by shimAdvance since the last shimResetTime call
+extern uint32_t shimOpenTicks;     // Ticks added by every open call
+extern void (*shimTimeHook)(void); // Called every time the simulated time advances
+void shimAdvance(uint64_t ticks);
+void shimResetTime(void);
+
+#endif
@@ -0,0 +1,8 @@
+// Host stand-in for the PS2SDK sifrpc.h
+#ifndef _SHIM_SIFRPC_H_
+#define _SHIM_SIFRPC_H_
+
+void SifInitRpc(int mode);
+void sceSifExitRpc(void);
+
+#endif
@@ -0,0 +1,89 @@
+// Stand-ins for the launcher functions that print to the screen, reset the IOP or leave the launcher
+#include "stubs_launcher.h"
+#include "init.h"
+#include "loader.h"
+#include "shim/shim.h"
+#include <fcntl.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+char stubMessage[256];
+int stubRebootCount = 0;
+int stubLaunchPathsCount = 0;
+char stubLaunchedPath[256];
+
+void stubsReset(void) {
+  stubMessage[0] = stubLaunchedPath[0] = '\0';
+  stubRebootCount = stubLaunchPathsCount = 0;
+}
+
+void msg(const char *str, ...) {
+  va_list args;
+  va_start(args, str);
+  vsnprintf(stubMessage, sizeof(stubMessage), str, args);
+  va_end(args);
+}
+
+// Leaves the tested code like LoadExecPS2 does
+void rebootPS2() {
+  stubRebootCount++;
+  if (shimExitJump)
+    longjmp(*shimExitJump, 1);
+}
+
+int initModules(DeviceType device) { return 0; }
+
+DeviceType guessDeviceType(char *path) {
+  if (!strncmp(path, "mc", 2))
+    return Device_MemoryCard;
+  return Device_None;
+}
+
+char *normalizePath(char *path, DeviceType type) { return path; }
+
+int tryFile(char *filepath) {
+  int fd = open(filepath, O_RDONLY);
+  if (fd < 0)
+    return fd;
+  close(fd);
+  return 0;
+}
+
+// Records the path instead of loading the ELF
+int LoadELFFromFile(int argc, char *argv[]) {
+  snprintf(stubLaunchedPath, sizeof(stubLaunchedPath), "%s", argv[0]);
+  return 0;
+}
+
+// Records the first path instead of loading the ELF
+int launchPaths(int argc, char *argv[], linkedStr *paths) {
+  stubLaunchPathsCount++;
+  snprintf(stubLaunchedPath, sizeof(stubLaunchedPath), "%s", paths ? paths->str : "");
+  return -1;
+}
+
+linkedStr *addStr(linkedStr *lstr, char *str) {
+  linkedStr *newLstr = calloc(1, sizeof(linkedStr));
+  newLstr->str = strdup(str);
+  if (!lstr)
+    return newLstr;
+
+  linkedStr *tLstr = lstr;
+  while (tLstr->next)
+    tLstr = tLstr->next;
+  tLstr->next = newLstr;
+  return lstr;
+}
+
+void freeLinkedStr(linkedStr *lstr) {
+  while (lstr) {
+    linkedStr *next = lstr->next;
+    free(lstr->str);
+    free(lstr);
+    lstr = next;
+  }
+}
@@ -0,0 +1,15 @@
+// Stand-ins for the launcher functions that print to the screen, reset the IOP or leave the launcher
+#ifndef _STUBS_LAUNCHER_H_
+#define _STUBS_LAUNCHER_H_
+
+// Last message passed to msg
+extern char stubMessage[256];
+// Number of rebootPS2 and launchPaths calls
+extern int stubRebootCount;
+extern int stubLaunchPathsCount;
+// First path passed to the last launchPaths call or argv[0] of the last LoadELFFromFile call
+extern char stubLaunchedPath[256];
+
+void stubsReset(void);
+
+#endif
@@ -0,0 +1,11 @@
+// Stand-ins for the patcher functions that reset the IOP and the GS, used by the tests running loader.c
+#include "gs.h"
+#include "init.h"
+
+int initModules(void) { return 0; }
+
+void resetModules() {}
+
+void reclaimBootMemory(void) {}
+
+int gsInit(GSVideoMode vmode) { return 0; }
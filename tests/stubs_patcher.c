@@ -0,0 +1,29 @@
+// Stand-ins for the patcher functions that leave the patcher or reset the IOP
+#include "stubs_patcher.h"
+#include "init.h"
+#include "loader.h"
+#include <stdio.h>
+
+char stubLaunchedItem[64];
+int stubLaunchCount = 0;
+int stubDiscLaunchCount = 0;
+int stubReloadCount = 0;
+
+void stubsReset(void) {
+  stubLaunchedItem[0] = '\0';
+  stubLaunchCount = stubDiscLaunchCount = stubReloadCount = 0;
+}
+
+// Records the item instead of starting the launcher
+void launchItem(char *item) {
+  snprintf(stubLaunchedItem, sizeof(stubLaunchedItem), "%s", item);
+  stubLaunchCount++;
+}
+
+void launchDisc() { stubDiscLaunchCount++; }
+
+void reloadOSDSYS() { stubReloadCount++; }
+
+void resetModules() {}
+
+void reclaimBootMemory(void) {}
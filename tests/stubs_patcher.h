@@ -0,0 +1,14 @@
+// Stand-ins for the patcher functions that leave the patcher or reset the IOP
+#ifndef _STUBS_PATCHER_H_
+#define _STUBS_PATCHER_H_
+
+// Last item passed to launchItem
+extern char stubLaunchedItem[64];
+// Number of launchItem, launchDisc and reloadOSDSYS calls
+extern int stubLaunchCount;
+extern int stubDiscLaunchCount;
+extern int stubReloadCount;
+
+void stubsReset(void);
+
+#endif
@@ -0,0 +1,55 @@
+// Minimal assertion helpers for the host tests.
+// Every test is a separate program that returns a non-zero status if any check fails
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                                                                                                  \
+  do {                                                                                                                                               \
+    if (!(cond)) {                                                                                                                                   \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                                                                       \
+      testFailures++;                                                                                                                                \
+    }                                                                                                                                                \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                                                                   \
+  do {                                                                                                                                               \
+    long long _a = (long long)(actual), _e = (long long)(expected);                                                                                  \
+    if (_a != _e) {                                                                                                                                  \
+      fprintf(stderr, "%s:%d: %s == 0x%llx, expected 0x%llx\n", __FILE__, __LINE__, #actual, _a, _e);                                                \
+      testFailures++;                                                                                                                                \
+    }                                                                                                                                                \
+  } while (0)
+
+#define CHECK_STR(actual, expected)                                                                                                                  \
+  do {                                                                                                                                               \
+    const char *_a = (actual), *_e = (expected);                                                                                                     \
+    if (!_a || strcmp(_a, _e)) {                                                                                                                     \
+      fprintf(stderr, "%s:%d: %s == \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, _a ? _a : "(null)", _e);                               \
+      testFailures++;                                                                                                                                \
+    }                                                                                                                                                \
+  } while (0)
+
+// Returns the monotonic host time in microseconds
+static inline uint64_t testTimeUs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Prints the result and returns the exit status
+static inline int testReport(const char *name) {
+  if (testFailures)
+    printf("%s: %d check(s) failed\n", name, testFailures);
+  else
+    printf("%s: OK\n", name);
+  return testFailures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,157 @@
+// Scroll menu animation tests.
+// Runs the animations on simulated 50 Hz and 60 Hz frame timelines and checks that
+// both reach the same values at the same time regardless of the refresh rate
+#include "animation.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "test.h"
+
+#define CNF_FILE "mc0:/SYS-CONF/OSDMENU.CNF"
+
+#define FRAME_50HZ (ANIM_TICKS_PER_MS * 1000 / 50)
+#define FRAME_60HZ (ANIM_TICKS_PER_MS * 1000 / 60)
+#define SCROLL_MS 150
+#define SCROLL_DISTANCE 160
+
+// Scroll value sampled every 100 ms, which is a whole number of frames at both rates
+#define SAMPLE_MS 100
+#define SAMPLES 5
+
+typedef struct {
+  int samples[SAMPLES]; // Value at every sample time
+  int doneMs;           // Time the target is reached
+  int monotonic;        // The value never moves away from the target
+} timeline;
+
+// Scrolls from 0 to SCROLL_DISTANCE, drawing a frame every frameTicks starting at the given Count value
+static timeline runScroll(uint32_t frameTicks, uint32_t startCount) {
+  animEasing anim;
+  timeline t = {.doneMs = -1, .monotonic = 1};
+  int prev = 0;
+
+  shimCount = startCount;
+  animInit(SCROLL_MS);
+  animJump(&anim, 0);
+  animSetTarget(&anim, SCROLL_DISTANCE);
+  for (uint64_t elapsed = frameTicks; elapsed <= (uint64_t)SAMPLE_MS * SAMPLES * ANIM_TICKS_PER_MS; elapsed += frameTicks) {
+    shimCount += frameTicks;
+    int value = animUpdate(&anim, animFrameTime());
+    if (value < prev || value > SCROLL_DISTANCE)
+      t.monotonic = 0;
+    prev = value;
+    if (value == SCROLL_DISTANCE && t.doneMs < 0)
+      t.doneMs = elapsed / ANIM_TICKS_PER_MS;
+    if (elapsed % ((uint64_t)SAMPLE_MS * ANIM_TICKS_PER_MS) == 0)
+      t.samples[elapsed / ((uint64_t)SAMPLE_MS * ANIM_TICKS_PER_MS) - 1] = value;
+  }
+  return t;
+}
+
+static void testScrollTimeline(void) {
+  timeline pal = runScroll(FRAME_50HZ, 0);
+  timeline ntsc = runScroll(FRAME_60HZ, 0);
+
+  CHECK(pal.monotonic);
+  CHECK(ntsc.monotonic);
+  for (int i = 0; i < SAMPLES; i++)
+    CHECK_EQ(pal.samples[i], ntsc.samples[i]);
+  // Half way through the ease-out curve the menu has covered most of the distance
+  CHECK(ntsc.samples[0] > SCROLL_DISTANCE * 3 / 4);
+  CHECK(ntsc.samples[0] < SCROLL_DISTANCE);
+
+  // The target is reached within one frame after the duration
+  CHECK(pal.doneMs >= SCROLL_MS);
+  CHECK(pal.doneMs <= SCROLL_MS + 20);
+  CHECK(ntsc.doneMs >= SCROLL_MS);
+  CHECK(ntsc.doneMs <= SCROLL_MS + 17);
+  printf("  scroll done after %d ms at 50 Hz, %d ms at 60 Hz\n", pal.doneMs, ntsc.doneMs);
+
+  // Count wrapping around during the animation doesn't change the timeline
+  timeline wrapped = runScroll(FRAME_60HZ, 0xffffffff - 2 * FRAME_60HZ);
+  for (int i = 0; i < SAMPLES; i++)
+    CHECK_EQ(wrapped.samples[i], ntsc.samples[i]);
+  CHECK_EQ(wrapped.doneMs, ntsc.doneMs);
+}
+
+static void testRetarget(void) {
+  animEasing anim;
+
+  shimCount = 0;
+  animInit(SCROLL_MS);
+  animJump(&anim, 0);
+  CHECK_EQ(anim.value, 0);
+
+  // Changing the target mid-animation continues from the current value
+  animSetTarget(&anim, 160);
+  int value = animUpdate(&anim, 50 * ANIM_TICKS_PER_MS);
+  CHECK(value > 0);
+  CHECK(value < 160);
+  animSetTarget(&anim, 0);
+  CHECK_EQ(animUpdate(&anim, 0), value);
+  CHECK(animUpdate(&anim, FRAME_60HZ) < value);
+
+  // Setting the same target doesn't restart the animation
+  animUpdate(&anim, 100 * ANIM_TICKS_PER_MS);
+  animSetTarget(&anim, 0);
+  CHECK(animUpdate(&anim, 0) < value);
+  CHECK_EQ(animUpdate(&anim, 50 * ANIM_TICKS_PER_MS), 0);
+}
+
+// Runs the cursor step accumulator for the given time and returns the number of steps
+static int runCursor(uint32_t frameTicks, int ms) {
+  uint32_t accumulator = 0;
+  int steps = 0;
+
+  shimCount = 0;
+  animInit(SCROLL_MS);
+  for (uint64_t elapsed = frameTicks; elapsed <= (uint64_t)ms * ANIM_TICKS_PER_MS; elapsed += frameTicks) {
+    shimCount += frameTicks;
+    steps += animSteps(&accumulator, animFrameTime());
+  }
+  return steps;
+}
+
+static void testCursorSteps(void) {
+  // The cursor moves 60 steps per second at any refresh rate
+  CHECK_EQ(runCursor(FRAME_60HZ, 1000), 60);
+  CHECK_EQ(runCursor(FRAME_50HZ, 1000), 60);
+  CHECK_EQ(runCursor(FRAME_60HZ / 2, 1000), 60);
+
+  // Long frames (e.g. while OSDSYS loads something) count as a single step
+  uint32_t accumulator = 0;
+  shimCount = 0;
+  animInit(SCROLL_MS);
+  shimCount += 1000 * ANIM_TICKS_PER_MS;
+  CHECK_EQ(animSteps(&accumulator, animFrameTime()), 1);
+}
+
+static void testDurationSetting(void) {
+  static const char cnf[] = "OSDSYS_scroll_menu = 1\r\n"
+                            "OSDSYS_scroll_duration = 300\r\n";
+
+  shimSetRoot("build/fs/animation");
+  shimWriteFile(CNF_FILE, cnf, sizeof(cnf) - 1);
+  initConfig();
+  CHECK_EQ(settings.scrollDuration, SCROLL_MS);
+  CHECK_EQ(loadConfig(), 0);
+  CHECK_EQ(settings.scrollDuration, 300);
+
+  // The configured duration scales the timeline
+  animEasing anim;
+  shimCount = 0;
+  animInit(settings.scrollDuration);
+  animJump(&anim, 0);
+  animSetTarget(&anim, SCROLL_DISTANCE);
+  CHECK(animUpdate(&anim, SCROLL_MS * ANIM_TICKS_PER_MS) < SCROLL_DISTANCE * 9 / 10);
+  CHECK(animUpdate(&anim, 100 * ANIM_TICKS_PER_MS) < SCROLL_DISTANCE);
+  CHECK_EQ(animUpdate(&anim, 50 * ANIM_TICKS_PER_MS), SCROLL_DISTANCE);
+}
+
+int main(void) {
+  eeRamInit();
+  testScrollTimeline();
+  testRetarget();
+  testCursorSteps();
+  testDurationSetting();
+  return testReport("test_animation");
+}
@@ -0,0 +1,149 @@
+// Memory card browser app index tests.
+// Checks that the launcher updates only the launched directory in the index and drops
+// stale entries when the patched browser launches a directory that no longer contains title.cfg
+#include "app_index.h"
+#include "apps.h"
+#include "handlers.h"
+#include "shim/shim.h"
+#include "stubs_launcher.h"
+#include "test.h"
+#include <setjmp.h>
+
+#define INDEX_MC0 "mc0:/SYS-CONF/OSDMENU.APP"
+#define INDEX_MC1 "mc1:/SYS-CONF/OSDMENU.APP"
+
+static struct {
+  appIndexHeader header;
+  appIndexEntry entries[APP_INDEX_MAX_ENTRIES + 1];
+} appIndex;
+
+// Reads the index and returns the number of entries or -1 if the file doesn't exist
+static int readIndex(const char *path) {
+  memset(&appIndex, 0, sizeof(appIndex));
+  int size = shimReadFile(path, &appIndex, sizeof(appIndex));
+  if (size < 0)
+    return -1;
+  CHECK_EQ(appIndex.header.magic, APP_INDEX_MAGIC);
+  CHECK_EQ(size, sizeof(appIndexHeader) + appIndex.header.count * sizeof(appIndexEntry));
+  return appIndex.header.count;
+}
+
+static void writeIndex(const char *path, int count, const char *prefix) {
+  appIndex.header.magic = APP_INDEX_MAGIC;
+  appIndex.header.count = count;
+  memset(appIndex.entries, 0, sizeof(appIndex.entries));
+  for (int i = 0; i < count; i++)
+    snprintf(appIndex.entries[i].dirName, APP_INDEX_NAME_LEN, "%s%02d", prefix, i);
+  shimWriteFile(path, &appIndex, sizeof(appIndexHeader) + count * sizeof(appIndexEntry));
+}
+
+static void testIncrementalUpdate(void) {
+  shimSetRoot("build/fs/app_index");
+
+  // Other save directories on the card are never scanned
+  for (int i = 0; i < 40; i++) {
+    char path[64];
+    snprintf(path, sizeof(path), "mc0:/SAVE%02d/icon.sys", i);
+    shimWriteFile(path, "", 0);
+  }
+
+  // The first launch creates the index
+  shimResetIO();
+  CHECK_EQ(updateAppIndex("mc0:/APP_A/title.cfg", 1), 1);
+  CHECK_EQ(readIndex(INDEX_MC0), 1);
+  CHECK_STR(appIndex.entries[0].dirName, "APP_A");
+  CHECK(shimIO.opens + shimIO.failedOpens <= 2);
+
+  // Listed directories don't rewrite the index
+  CHECK_EQ(updateAppIndex("mc0:/APP_B/title.cfg", 1), 1);
+  CHECK_EQ(updateAppIndex("mc0:/APP_C/title.cfg", 1), 1);
+  shimResetIO();
+  CHECK_EQ(updateAppIndex("mc0:/APP_B/title.cfg", 1), 0);
+  CHECK_EQ(shimIO.opens, 1);
+  CHECK_EQ(readIndex(INDEX_MC0), 3);
+  CHECK_STR(appIndex.entries[1].dirName, "APP_B");
+
+  // Every memory card has its own index
+  CHECK_EQ(updateAppIndex("mc1:/APP_A/title.cfg", 1), 1);
+  CHECK_EQ(readIndex(INDEX_MC1), 1);
+  CHECK_EQ(readIndex(INDEX_MC0), 3);
+
+  // Stale entries are removed, the rest keep their order
+  CHECK_EQ(updateAppIndex("mc0:/APP_B/title.cfg", 0), 1);
+  CHECK_EQ(readIndex(INDEX_MC0), 2);
+  CHECK_STR(appIndex.entries[0].dirName, "APP_A");
+  CHECK_STR(appIndex.entries[1].dirName, "APP_C");
+  CHECK_EQ(updateAppIndex("mc0:/APP_B/title.cfg", 0), 0);
+  // Prefixes of listed names don't match
+  CHECK_EQ(updateAppIndex("mc0:/APP/title.cfg", 0), 0);
+  CHECK_EQ(readIndex(INDEX_MC0), 2);
+
+  // Unrelated paths are ignored
+  shimResetIO();
+  CHECK_EQ(updateAppIndex("mc0:/APP_D/TITLE.CNF", 1), 0);
+  CHECK_EQ(updateAppIndex("mc0:/APP_D/SUB/title.cfg", 1), 0);
+  CHECK_EQ(updateAppIndex("mc0:/title.cfg", 1), 0);
+  CHECK_EQ(updateAppIndex("mass:/APP_D/title.cfg", 1), 0);
+  CHECK_EQ(updateAppIndex("mc0:/ABCDEFGHIJKLMNOPQRSTUVWXYZ012345/title.cfg", 1), 0);
+  CHECK_EQ(shimIO.opens + shimIO.failedOpens, 0);
+}
+
+static void testFullIndex(void) {
+  shimSetRoot("build/fs/app_index");
+  writeIndex(INDEX_MC0, APP_INDEX_MAX_ENTRIES, "APP");
+
+  // The oldest entry makes room for the new one
+  CHECK_EQ(updateAppIndex("mc0:/NEW/title.cfg", 1), 1);
+  CHECK_EQ(readIndex(INDEX_MC0), APP_INDEX_MAX_ENTRIES);
+  CHECK_STR(appIndex.entries[0].dirName, "APP01");
+  CHECK_STR(appIndex.entries[APP_INDEX_MAX_ENTRIES - 1].dirName, "NEW");
+
+  // Invalid indexes are replaced
+  shimWriteFile(INDEX_MC0, "garbage", 7);
+  CHECK_EQ(updateAppIndex("mc0:/APP_A/title.cfg", 0), 0);
+  CHECK_EQ(updateAppIndex("mc0:/APP_A/title.cfg", 1), 1);
+  CHECK_EQ(readIndex(INDEX_MC0), 1);
+}
+
+// Runs quickboot until it leaves the launcher. Returns 1 if the launcher has rebooted
+static int quickboot(const char *cfgPath) {
+  char path[64];
+  jmp_buf exitJump;
+  snprintf(path, sizeof(path), "%s", cfgPath);
+  stubsReset();
+  shimExitJump = &exitJump;
+  if (!setjmp(exitJump))
+    handleQuickboot(path);
+  shimExitJump = NULL;
+  return stubRebootCount;
+}
+
+static void testQuickboot(void) {
+  shimSetRoot("build/fs/app_index");
+  shimWriteFile("mc0:/APP_A/title.cfg", "boot=APP.ELF\n", 13);
+
+  // Launching an app adds it to the index
+  CHECK_EQ(quickboot("mc0:/APP_A/title.cfg"), 0);
+  CHECK_STR(stubLaunchedPath, "mc0:/APP_A/APP.ELF");
+  CHECK_EQ(readIndex(INDEX_MC0), 1);
+
+  // The indexed directory is no longer an app. The entry is dropped
+  // and the launcher goes back to OSDSYS so the browser lists the directory
+  shimWriteFile("mc0:/APP_B/icon.sys", "", 0);
+  writeIndex(INDEX_MC0, 0, "");
+  CHECK_EQ(updateAppIndex("mc0:/APP_B/title.cfg", 1), 1);
+  CHECK_EQ(quickboot("mc0:/APP_B/title.cfg"), 1);
+  CHECK_EQ(stubLaunchPathsCount, 0);
+  CHECK_EQ(readIndex(INDEX_MC0), 0);
+
+  // Unlisted directories without title.cfg fail as usual
+  CHECK_EQ(quickboot("mc0:/APP_B/title.cfg"), 0);
+  CHECK(strstr(stubMessage, "Failed to open") != NULL);
+}
+
+int main(void) {
+  testIncrementalUpdate();
+  testFullIndex();
+  testQuickboot();
+  return testReport("test_app_index");
+}
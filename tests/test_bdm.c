@@ -0,0 +1,127 @@
+// BDM device polling simulator.
+// Runs handleBDM with simulated time: usleep and every open advance the Count register instead of waiting,
+// and devices come up at scripted times. Checks that polling stops once no new device has come up for
+// BDM_SETTLE_TIME, continues until BDM_TIMEOUT without any devices and that the time spent opening files
+// counts towards both
+#include "clock.h"
+#include "handlers.h"
+#include "shim/shim.h"
+#include "stubs_launcher.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define BDM_TIMEOUT_MS 20000
+#define BDM_SETTLE_MS 5000
+#define MS(n) ((uint64_t)(n) * CLOCK_TICKS_PER_MS)
+
+typedef struct {
+  uint32_t appearsAt; // Time the mountpoint comes up, in milliseconds
+  int hasFile;        // Device contains the ELF
+} simDevice;
+
+static simDevice *devices;
+static int deviceCount;
+static int mountedCount;
+
+// Mounts devices once the simulated time reaches their appearance time
+static void mountDevices(void) {
+  char path[32];
+  while ((mountedCount < deviceCount) && (shimTicks >= MS(devices[mountedCount].appearsAt))) {
+    snprintf(path, sizeof(path), "mass%d:/%s", mountedCount, devices[mountedCount].hasFile ? "APP.ELF" : "OTHER.ELF");
+    shimWriteFile(path, "", 0);
+    mountedCount++;
+  }
+}
+
+// Runs handleBDM with the given devices. Returns the handler result and stores the simulated run time
+static int simulate(simDevice *devs, int count, uint32_t openMs, uint32_t startCount, uint64_t *runTime) {
+  char path[] = "mass?:/APP.ELF";
+  char *argv[] = {path, NULL};
+
+  shimSetRoot("build/fs/bdm");
+  stubsReset();
+  shimResetTime();
+  devices = devs;
+  deviceCount = count;
+  mountedCount = 0;
+  shimCount = startCount;
+  shimOpenTicks = MS(openMs);
+  shimTimeHook = mountDevices;
+  mountDevices();
+
+  int res = handleBDM(Device_USB, 1, argv);
+  *runTime = shimTicks / CLOCK_TICKS_PER_MS;
+  shimResetTime();
+  return res;
+}
+
+static void testLateDevice(void) {
+  // The first device doesn't have the file and the second one comes up 2.5 s later
+  simDevice devs[] = {{300, 0}, {2800, 1}};
+  uint64_t runTime;
+  CHECK_EQ(simulate(devs, 2, 0, 0, &runTime), 0);
+  CHECK_STR(stubLaunchedPath, "mass1:/APP.ELF");
+  CHECK(runTime >= 2800);
+  CHECK(runTime <= 2800 + 500); // One polling interval at most
+  printf("  late device found after %llu ms\n", (unsigned long long)runTime);
+}
+
+static void testNoFile(void) {
+  // Polling stops once the device set has been stable for BDM_SETTLE_TIME,
+  // even though the Count register wraps around every ~14.5 s
+  simDevice devs[] = {{0, 0}, {100, 0}};
+  uint64_t runTime;
+  CHECK(simulate(devs, 2, 0, 0xf0000000, &runTime) < 0);
+  CHECK(stubLaunchedPath[0] == '\0');
+  CHECK(runTime >= 100 + BDM_SETTLE_MS);
+  CHECK(runTime <= 100 + BDM_SETTLE_MS + 500); // One polling interval at most
+  printf("  missing file reported after %llu ms\n", (unsigned long long)runTime);
+
+  // Every new device restarts the settle time
+  simDevice late[] = {{0, 0}, {4000, 0}, {8500, 0}};
+  CHECK(simulate(late, 3, 0, 0, &runTime) < 0);
+  CHECK(runTime >= 8500 + BDM_SETTLE_MS);
+  CHECK(runTime <= 8500 + BDM_SETTLE_MS + 500);
+
+  // Devices coming up near the end don't extend polling past BDM_TIMEOUT
+  simDevice last[] = {{0, 0}, {4000, 0}, {8500, 0}, {12000, 0}, {16500, 0}};
+  CHECK(simulate(last, 5, 0, 0, &runTime) < 0);
+  CHECK(runTime >= BDM_TIMEOUT_MS);
+  CHECK(runTime <= BDM_TIMEOUT_MS + 1);
+
+  // No devices at all, slow devices get the full timeout to come up
+  CHECK(simulate(NULL, 0, 0, 0, &runTime) < 0);
+  CHECK(runTime >= BDM_TIMEOUT_MS);
+  CHECK(runTime <= BDM_TIMEOUT_MS + 1);
+  printf("  missing device reported after %llu ms\n", (unsigned long long)runTime);
+}
+
+static void testSlowOpens(void) {
+  // Every open takes 250 ms, so a polling pass over two devices takes 750 ms.
+  // The settle time must include that time and not only the polling delays
+  simDevice devs[] = {{0, 0}, {0, 0}};
+  uint64_t runTime;
+  CHECK(simulate(devs, 2, 250, 0, &runTime) < 0);
+  CHECK(runTime >= BDM_SETTLE_MS);
+  CHECK(runTime <= BDM_SETTLE_MS + 750 + 750);
+  printf("  slow device settled after %llu ms\n", (unsigned long long)runTime);
+
+  // A slow device coming up before the other one has settled is still found
+  simDevice late[] = {{0, 0}, {4000, 1}};
+  CHECK_EQ(simulate(late, 2, 250, 0, &runTime), 0);
+  CHECK_STR(stubLaunchedPath, "mass1:/APP.ELF");
+  CHECK(runTime < BDM_SETTLE_MS);
+
+  // The only device coming up late is found before BDM_TIMEOUT
+  simDevice only[] = {{12000, 1}};
+  CHECK_EQ(simulate(only, 1, 250, 0, &runTime), 0);
+  CHECK_STR(stubLaunchedPath, "mass0:/APP.ELF");
+  CHECK(runTime < BDM_TIMEOUT_MS);
+}
+
+int main(void) {
+  testLateDevice();
+  testNoFile();
+  testSlowOpens();
+  return testReport("test_bdm");
+}
@@ -0,0 +1,289 @@
+// Splash image converter tests.
+// Converts generated BMP files and the real splash screen with bmp2clut.py, expands the indexed pixel data
+// through the CSM1 CLUT the same way the GS does and compares the result with the source image
+#include "shim/shim.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define CLUT_SIZE 256
+#define MAX_PIXELS (256 * 80)
+
+#define SPLASH_BMP "../patcher/res/splash.bmp"
+#define SPLASH_HEADER "../patcher/include/splash_bmp.h"
+
+typedef struct {
+  int width;
+  int height;
+  int texWidth;
+  uint32_t clut[CLUT_SIZE];
+  uint8_t data[MAX_PIXELS * 2];
+  int dataSize;
+} convertedImage;
+
+// Returns the source color for the pixel as 0x00BBGGRR
+typedef uint32_t (*pixelFunc)(int x, int y);
+
+// Writes a 24 or 32-bit BMP file. Negative height stores the rows top-down
+static void writeBMP(const char *path, int width, int height, int bpp, pixelFunc pixel) {
+  static uint8_t bmp[54 + MAX_PIXELS * 4 + 64 * 4];
+  int rows = abs(height);
+  int stride = ((width * bpp / 8) + 3) & ~3;
+  int size = 54 + stride * rows;
+  memset(bmp, 0, sizeof(bmp));
+
+  memcpy(bmp, "BM", 2);
+  *(uint32_t *)&bmp[2] = size;
+  *(uint32_t *)&bmp[10] = 54;
+  *(uint32_t *)&bmp[14] = 40;
+  *(int32_t *)&bmp[18] = width;
+  *(int32_t *)&bmp[22] = height;
+  *(uint16_t *)&bmp[26] = 1;
+  *(uint16_t *)&bmp[28] = bpp;
+  for (int y = 0; y < rows; y++) {
+    uint8_t *row = &bmp[54 + ((height > 0) ? rows - 1 - y : y) * stride];
+    for (int x = 0; x < width; x++) {
+      uint32_t color = pixel(x, y);
+      uint8_t *p = &row[x * bpp / 8];
+      p[0] = color >> 16; // B
+      p[1] = color >> 8;  // G
+      p[2] = color;       // R
+    }
+  }
+  shimWriteFile(path, bmp, size);
+}
+
+// Runs bmp2clut.py. Returns the exit status
+static int convertNamed(const char *bmpPath, const char *headerPath, const char *name) {
+  char cmd[2048];
+  snprintf(cmd, sizeof(cmd), "%s '%s' '%s' %s > /dev/null 2>&1", BMP2CLUT, shimHostPath(bmpPath), shimHostPath(headerPath), name);
+  return system(cmd);
+}
+#define convert(bmpPath, headerPath) convertNamed(bmpPath, headerPath, "image")
+
+// Parses hex values following the marker into values. Returns the number of values
+static int parseArray(const char *header, const char *marker, void *values, int valueSize, int maxCount) {
+  const char *p = strstr(header, marker);
+  if (!p)
+    return -1;
+  p += strlen(marker);
+
+  int count = 0;
+  char *end;
+  while (count < maxCount) {
+    while (*p == ' ' || *p == '\n' || *p == ',')
+      p++;
+    if (*p == '}')
+      break;
+    unsigned long value = strtoul(p, &end, 16);
+    if (end == p)
+      return -1;
+    if (valueSize == 4)
+      ((uint32_t *)values)[count] = value;
+    else
+      ((uint8_t *)values)[count] = value;
+    count++;
+    p = end;
+  }
+  return count;
+}
+
+// Parses the generated header. Returns 0 on success
+static int parseHeader(const char *headerPath, convertedImage *image) {
+  static char header[MAX_PIXELS * 16];
+  memset(header, 0, sizeof(header));
+  if (shimReadFile(headerPath, header, sizeof(header) - 1) < 0)
+    return -1;
+
+  const char *p;
+  if (!(p = strstr(header, "imageWidth = ")) || (sscanf(p, "imageWidth = %d", &image->width) != 1))
+    return -1;
+  if (!(p = strstr(header, "imageHeight = ")) || (sscanf(p, "imageHeight = %d", &image->height) != 1))
+    return -1;
+  if (!(p = strstr(header, "imageTexWidth = ")) || (sscanf(p, "imageTexWidth = %d", &image->texWidth) != 1))
+    return -1;
+  if (parseArray(header, "imageCLUT[] = {", image->clut, 4, CLUT_SIZE) != CLUT_SIZE)
+    return -1;
+  image->dataSize = parseArray(header, "image[] = {", image->data, 1, sizeof(image->data));
+  return (image->dataSize < 0) ? -1 : 0;
+}
+
+// Returns the CLUT entry the GS uses for the index in CSM1 mode
+static uint32_t lookupCLUT(const convertedImage *image, uint8_t index) {
+  // Entries 8-15 and 16-23 of every 32-entry block are swapped
+  return image->clut[(index & ~0x18) | ((index & 0x08) << 1) | ((index & 0x10) >> 1)];
+}
+
+typedef struct {
+  int maxError;      // Largest per-channel difference
+  double meanError;  // Mean per-channel difference
+  int paddingErrors; // Non-zero padding pixels
+} roundTripResult;
+
+// Converts the BMP file and compares the expanded result with the source pixels. Returns 0 on success
+static int checkConversion(const char *bmpPath, const char *headerPath, int width, int height, pixelFunc pixel, roundTripResult *result) {
+  static convertedImage image;
+
+  memset(result, 0, sizeof(*result));
+  if (convert(bmpPath, headerPath) || parseHeader(headerPath, &image))
+    return -1;
+
+  height = abs(height);
+  CHECK_EQ(image.width, width);
+  CHECK_EQ(image.height, height);
+  CHECK_EQ(image.texWidth, (width + 15) & ~15);
+  CHECK_EQ(image.dataSize, image.texWidth * height);
+  if ((image.width != width) || (image.height != height) || (image.dataSize != image.texWidth * height))
+    return -1;
+
+  long long totalError = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < image.texWidth; x++) {
+      uint8_t index = image.data[y * image.texWidth + x];
+      if (x >= width) {
+        result->paddingErrors += (index != 0);
+        continue;
+      }
+
+      uint32_t expected = pixel(x, y);
+      uint32_t actual = lookupCLUT(&image, index);
+      CHECK_EQ(actual >> 24, 0); // Alpha is left for the GS to ignore
+      for (int ch = 0; ch < 24; ch += 8) {
+        int error = abs((int)((expected >> ch) & 0xff) - (int)((actual >> ch) & 0xff));
+        totalError += error;
+        if (error > result->maxError)
+          result->maxError = error;
+      }
+    }
+  }
+  result->meanError = (double)totalError / (width * height * 3);
+  return 0;
+}
+
+// Writes the image to a BMP file and checks the conversion. Returns 0 on success
+static int roundTrip(const char *name, int width, int height, int bpp, pixelFunc pixel, roundTripResult *result) {
+  char bmpPath[64], headerPath[64];
+  snprintf(bmpPath, sizeof(bmpPath), "host:/%s.bmp", name);
+  snprintf(headerPath, sizeof(headerPath), "host:/%s.h", name);
+
+  writeBMP(bmpPath, width, height, bpp, pixel);
+  return checkConversion(bmpPath, headerPath, width, height, pixel, result);
+}
+
+// 200 distinct colors
+static uint32_t fewColors(int x, int y) { return ((x * 7 + y * 40) % 200) * 0x010203 & 0xffffff; }
+
+// 512 distinct colors in an 8x8x8 color cube
+static uint32_t colorCube(int x, int y) {
+  int i = y * 32 + x;
+  return ((i & 7) * 36) | (((i >> 3) & 7) * 36) << 8 | (((i >> 6) & 7) * 36) << 16;
+}
+
+static void testExactPalette(void) {
+  shimSetRoot("build/fs/bmp2clut");
+  roundTripResult res;
+
+  // Images with up to 256 colors are stored without loss.
+  // The width isn't a multiple of 4 or 16 to check BMP row and texture padding
+  CHECK_EQ(roundTrip("bottom_up_24", 37, 9, 24, fewColors, &res), 0);
+  CHECK_EQ(res.maxError, 0);
+  CHECK_EQ(res.paddingErrors, 0);
+
+  CHECK_EQ(roundTrip("top_down_32", 19, -11, 32, fewColors, &res), 0);
+  CHECK_EQ(res.maxError, 0);
+  CHECK_EQ(res.paddingErrors, 0);
+}
+
+static void testQuantization(void) {
+  shimSetRoot("build/fs/bmp2clut");
+  roundTripResult res;
+
+  // 512 colors are reduced to 256 with a bounded error
+  CHECK_EQ(roundTrip("color_cube", 32, 16, 24, colorCube, &res), 0);
+  CHECK(res.maxError <= 36);
+  CHECK(res.meanError < 8.0);
+  CHECK_EQ(res.paddingErrors, 0);
+  printf("  512 colors: max error %d/255, mean error %.2f/255\n", res.maxError, res.meanError);
+}
+
+// Real splash screen pixels as 0x00BBGGRR
+static uint32_t splashPixels[MAX_PIXELS];
+static int splashWidth;
+static uint32_t splashPixel(int x, int y) { return splashPixels[y * splashWidth + x]; }
+
+// Reads the whole host file. Returns the file size or -1
+static long readHostFile(const char *path, void *data, size_t size) {
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return -1;
+  long read = fread(data, 1, size, f);
+  fclose(f);
+  return read;
+}
+
+static void testSplash(void) {
+  static uint8_t bmp[54 + MAX_PIXELS * 4];
+  static char expected[MAX_PIXELS * 16], actual[MAX_PIXELS * 16];
+  roundTripResult res;
+
+  shimSetRoot("build/fs/bmp2clut");
+  long size = readHostFile(SPLASH_BMP, bmp, sizeof(bmp));
+  CHECK(size > 54);
+  if (size <= 54)
+    return;
+
+  // The splash is stored as a bottom-up 24-bit BMP
+  uint32_t offset = *(uint32_t *)&bmp[10];
+  int width = *(int32_t *)&bmp[18], height = *(int32_t *)&bmp[22];
+  CHECK_EQ(*(uint16_t *)&bmp[28], 24);
+  CHECK(height > 0);
+  CHECK(width * height <= MAX_PIXELS);
+  if ((height <= 0) || (width * height > MAX_PIXELS))
+    return;
+
+  int stride = ((width * 3) + 3) & ~3;
+  splashWidth = width;
+  for (int y = 0; y < height; y++) {
+    uint8_t *row = &bmp[offset + (height - 1 - y) * stride];
+    for (int x = 0; x < width; x++)
+      splashPixels[y * width + x] = row[x * 3 + 2] | row[x * 3 + 1] << 8 | row[x * 3] << 16;
+  }
+
+  // The splash has more than 256 colors, quantization error stays low
+  shimWriteFile("host:/splash.bmp", bmp, size);
+  CHECK_EQ(checkConversion("host:/splash.bmp", "host:/splash_image.h", width, height, splashPixel, &res), 0);
+  CHECK(res.maxError <= 16);
+  CHECK(res.meanError < 1.0);
+  CHECK_EQ(res.paddingErrors, 0);
+  printf("  splash %dx%d: max error %d/255, mean error %.2f/255\n", width, height, res.maxError, res.meanError);
+
+  // The header in the patcher is the converter output for the splash
+  CHECK_EQ(convertNamed("host:/splash.bmp", "host:/splash_bmp.h", "splash"), 0);
+  memset(expected, 0, sizeof(expected));
+  memset(actual, 0, sizeof(actual));
+  CHECK(readHostFile(SPLASH_HEADER, expected, sizeof(expected) - 1) > 0);
+  CHECK(shimReadFile("host:/splash_bmp.h", actual, sizeof(actual) - 1) > 0);
+  CHECK(!strcmp(expected, actual));
+}
+
+static void testUnsupported(void) {
+  shimSetRoot("build/fs/bmp2clut");
+
+  // Indexed BMP files are rejected
+  writeBMP("host:/indexed.bmp", 4, 4, 24, fewColors);
+  uint8_t bmp[54 + 64];
+  int size = shimReadFile("host:/indexed.bmp", bmp, sizeof(bmp));
+  *(uint16_t *)&bmp[28] = 8;
+  shimWriteFile("host:/indexed.bmp", bmp, size);
+  CHECK(convert("host:/indexed.bmp", "host:/indexed.h") != 0);
+
+  shimWriteFile("host:/garbage.bmp", "garbage", 7);
+  CHECK(convert("host:/garbage.bmp", "host:/garbage.h") != 0);
+}
+
+int main(void) {
+  testExactPalette();
+  testQuantization();
+  testSplash();
+  testUnsupported();
+  return testReport("test_bmp2clut");
+}
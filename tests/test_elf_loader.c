@@ -0,0 +1,261 @@
+// ELF loader tests.
+// Runs the loader on generated ELF files with EE RAM filled with a marker byte. Checks that segments are read
+// to their target addresses, .bss tails and gaps are cleared, and that only the memory ranges passed with
+// -wipe are cleared outside of the segments. Reports the bytes cleared for common program header layouts
+// compared to clearing the whole user memory
+#include "shim/shim.h"
+#include "test.h"
+#include <errno.h>
+
+#define ELF_PATH "mass:/APP.ELF"
+#define USER_MEM_START 0x00100000
+#define USER_MEM_END 0x02000000
+#define MARKER 0xAA
+#define PT_MIPS_REGINFO 0x70000000
+
+// Loader entry point, built with -Dmain=loaderMain
+int loaderMain(int argc, char *argv[]);
+
+typedef struct {
+  uint32_t vaddr;
+  uint32_t filesz;
+  uint32_t memsz;
+  uint32_t type; // PT_LOAD if 0
+} segment;
+
+// Writes the ELF with the given segments. Segment data is filled with the segment index + 1
+static void writeELF(const segment *segs, int count, uint32_t entry, int truncate) {
+  static uint8_t elf[0x10000];
+  uint32_t offset = 0x34 + count * 0x20;
+  memset(elf, 0, sizeof(elf));
+
+  memcpy(elf, "\177ELF\1\1\1", 7);
+  *(uint16_t *)&elf[0x10] = 2;    // ET_EXEC
+  *(uint16_t *)&elf[0x12] = 8;    // EM_MIPS
+  *(uint32_t *)&elf[0x18] = entry;
+  *(uint32_t *)&elf[0x1c] = 0x34; // Program headers
+  *(uint16_t *)&elf[0x2a] = 0x20;
+  *(uint16_t *)&elf[0x2c] = count;
+  for (int i = 0; i < count; i++) {
+    uint32_t *ph = (uint32_t *)&elf[0x34 + i * 0x20];
+    ph[0] = segs[i].type ? segs[i].type : 1; // PT_LOAD
+    ph[1] = offset;
+    ph[2] = ph[3] = segs[i].vaddr;
+    ph[4] = segs[i].filesz;
+    ph[5] = segs[i].memsz;
+    memset(&elf[offset], i + 1, segs[i].filesz);
+    offset += segs[i].filesz;
+  }
+  shimWriteFile(ELF_PATH, elf, offset - truncate);
+}
+
+// Returns 1 if every byte in [start, end) equals the value
+static int isFilled(uint32_t start, uint32_t end, uint8_t value) {
+  for (uint32_t addr = start; addr < end; addr++)
+    if (*(uint8_t *)(uintptr_t)addr != value)
+      return 0;
+  return 1;
+}
+
+// Runs the loader with EE RAM filled with the marker. Returns 0 if the ELF was started
+static int runLoader(int argc, char *argv[]) {
+  jmp_buf exitJump;
+  memset((void *)USER_MEM_START, MARKER, USER_MEM_END - USER_MEM_START);
+  memset(&shimExec, 0, sizeof(shimExec));
+  shimLoadElfCalls = 0;
+
+  int res;
+  shimExitJump = &exitJump;
+  if (!setjmp(exitJump))
+    res = loaderMain(argc, argv);
+  else
+    res = 0;
+  shimExitJump = NULL;
+  return res;
+}
+
+// Segments out of address order, an unaligned segment and a .bss tail
+static const segment segs[] = {
+    {0x00200000, 0x1234, 0x3000},
+    {0x0017ff08, 0x0100, 0x0100},
+};
+
+static void testPlacement(void) {
+  shimSetRoot("build/fs/elf_loader");
+  writeELF(segs, 2, 0x00200008, 0);
+
+  char path[] = ELF_PATH;
+  char arg[] = "-arg";
+  char *argv[] = {path, arg};
+  shimResetIO();
+  CHECK_EQ(runLoader(2, argv), 0);
+  CHECK_EQ(shimLoadElfCalls, 0);
+  CHECK_EQ((uint32_t)(uintptr_t)shimExec.entry, 0x00200008);
+  CHECK_EQ(shimExec.argc, 2);
+  CHECK_STR(shimExec.argv[0], ELF_PATH);
+  CHECK_STR(shimExec.argv[1], "-arg");
+
+  // Segments are read straight from the file
+  CHECK_EQ(shimIO.bytesRead, 0x34 + 2 * 0x20 + 0x1234 + 0x100);
+  CHECK(isFilled(0x00200000, 0x00201234, 1));
+  CHECK(isFilled(0x0017ff08, 0x00180008, 2));
+
+  // .bss tails and the rest of user memory are cleared
+  CHECK(isFilled(0x00201234, 0x00203000, 0));
+  CHECK(isFilled(USER_MEM_START, 0x0017ff08, 0));
+  CHECK(isFilled(0x00180008, 0x00200000, 0));
+  CHECK(isFilled(0x00203000, USER_MEM_END, 0));
+}
+
+static void testFallback(void) {
+  shimSetRoot("build/fs/elf_loader");
+  char path[] = ELF_PATH;
+  char *argv[] = {path};
+
+  // Segments overlapping the loader are loaded by SifLoadElf after clearing the whole user memory
+  segment low[] = {{0x00080000, 0x100, 0x100}};
+  writeELF(low, 1, 0x00080000, 0);
+  CHECK_EQ(runLoader(1, argv), -ENOENT);
+  CHECK_EQ(shimLoadElfCalls, 1);
+  CHECK(isFilled(USER_MEM_START, USER_MEM_END, 0));
+
+  // Truncated segment data
+  writeELF(segs, 2, 0x00200000, 0x10);
+  CHECK_EQ(runLoader(1, argv), -ENOENT);
+  CHECK_EQ(shimLoadElfCalls, 1);
+  CHECK(isFilled(USER_MEM_START, USER_MEM_END, 0));
+
+  // Not an ELF file
+  shimWriteFile(ELF_PATH, "garbage", 7);
+  CHECK_EQ(runLoader(1, argv), -ENOENT);
+  CHECK_EQ(shimLoadElfCalls, 1);
+
+  // PFS paths always use SifLoadElf
+  char pfsPath[] = "hdd0:+OPL:pfs:/APP.ELF";
+  argv[0] = pfsPath;
+  shimResetIO();
+  CHECK_EQ(runLoader(1, argv), -ENOENT);
+  CHECK_EQ(shimLoadElfCalls, 1);
+  CHECK_EQ(shimIO.opens + shimIO.failedOpens, 0);
+}
+
+static void testWipeRange(void) {
+  shimSetRoot("build/fs/elf_loader");
+  writeELF(segs, 2, 0x00200000, 0);
+  char path[] = ELF_PATH;
+  char *argv[] = {NULL, path};
+
+  // Invalid ranges clear the whole user memory
+  static const char *invalid[] = {"-wipe=zz", "-wipe=80000:1f00000", "-wipe=1f00000:180000", "-wipe=180000:3000000"};
+  for (int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    char arg[32];
+    snprintf(arg, sizeof(arg), "%s", invalid[i]);
+    argv[0] = arg;
+    CHECK_EQ(runLoader(2, argv), 0);
+    CHECK_EQ(shimExec.argc, 1);
+    CHECK(isFilled(0x00180008, 0x00200000, 0));
+    CHECK(isFilled(0x00203000, USER_MEM_END, 0));
+  }
+
+  // The launcher has used memory up to 0x180000 and from 0x1f00000
+  char wipe[] = "-wipe=180000:1f00000";
+  argv[0] = wipe;
+  CHECK_EQ(runLoader(2, argv), 0);
+
+  // The argument is not passed to the ELF
+  CHECK_EQ(shimExec.argc, 1);
+  CHECK_STR(shimExec.argv[0], ELF_PATH);
+
+  // Only the dirty ranges and the .bss tail are cleared, the segments are left intact
+  CHECK(isFilled(USER_MEM_START, 0x0017ff08, 0));
+  CHECK(isFilled(0x0017ff08, 0x00180008, 2));
+  CHECK(isFilled(0x00180008, 0x00200000, MARKER));
+  CHECK(isFilled(0x00200000, 0x00201234, 1));
+  CHECK(isFilled(0x00201234, 0x00203000, 0));
+  CHECK(isFilled(0x00203000, 0x01f00000, MARKER));
+  CHECK(isFilled(0x01f00000, USER_MEM_END, 0));
+}
+
+// Returns the number of zero bytes in user memory. Segment data is never zero, so this is the number of cleared bytes
+static uint32_t countCleared(void) {
+  uint32_t count = 0;
+  for (uint32_t addr = USER_MEM_START; addr < USER_MEM_END; addr++)
+    if (!*(uint8_t *)(uintptr_t)addr)
+      count++;
+  return count;
+}
+
+// Returns the index of the loadable segment containing the address or -1
+static int findSegment(const segment *segs, int count, uint32_t addr) {
+  for (int i = 0; i < count; i++)
+    if (!segs[i].type && (addr >= segs[i].vaddr) && (addr < segs[i].vaddr + segs[i].memsz))
+      return i;
+  return -1;
+}
+
+// Loads the ELF with and without the launcher memory ranges and checks every byte of user memory
+static void checkLayout(const char *name, const segment *segs, int count) {
+  char path[] = ELF_PATH;
+  char wipe[] = "-wipe=180000:1f00000";
+  char *argv[] = {wipe, path};
+  int entry = 0;
+  while (segs[entry].type)
+    entry++;
+
+  shimSetRoot("build/fs/elf_loader");
+  writeELF(segs, count, segs[entry].vaddr, 0);
+
+  // Full wipe: everything outside of the file-backed parts is cleared
+  CHECK_EQ(runLoader(1, &argv[1]), 0);
+  CHECK_EQ(shimLoadElfCalls, 0);
+  uint32_t fullCleared = countCleared();
+
+  CHECK_EQ(runLoader(2, argv), 0);
+  CHECK_EQ(shimLoadElfCalls, 0);
+  CHECK_EQ(shimExec.argc, 1);
+  uint32_t cleared = countCleared();
+
+  int errors = 0;
+  for (uint32_t addr = USER_MEM_START; addr < USER_MEM_END; addr++) {
+    uint8_t value = *(uint8_t *)(uintptr_t)addr;
+    int i = findSegment(segs, count, addr);
+    uint8_t expected;
+    if (i >= 0)
+      expected = (addr < segs[i].vaddr + segs[i].filesz) ? i + 1 : 0;
+    else
+      expected = ((addr < 0x00180000) || (addr >= 0x01f00000)) ? 0 : MARKER;
+    if (value != expected)
+      errors++;
+  }
+  CHECK_EQ(errors, 0);
+  CHECK(cleared < fullCleared);
+
+  printf("  %-24s %6u KiB cleared, %6u KiB with a full wipe\n", name, cleared / 1024, fullCleared / 1024);
+}
+
+static void testLayouts(void) {
+  // ps2sdk homebrew: .reginfo and a single segment with a large .bss
+  segment homebrew[] = {{0x00100000, 0x18, 0x18, PT_MIPS_REGINFO}, {0x00100000, 0x8000, 0x60000}};
+  checkLayout("ps2sdk homebrew", homebrew, 2);
+
+  // Separate code and data segments with .bss following the data
+  segment split[] = {{0x00100000, 0x6000, 0x6000}, {0x00180000, 0x2000, 0x40000}};
+  checkLayout("code and data segments", split, 2);
+
+  // .bss in a segment without file data
+  segment bss[] = {{0x00100000, 0x4000, 0x4000}, {0x00104000, 0x1000, 0x1000}, {0x00300000, 0, 0x100000}};
+  checkLayout("separate .bss segment", bss, 3);
+
+  // Unpacker stub near the end of user memory, within the launcher stack range, and the unpacked image at the start
+  segment packed[] = {{0x01f80000, 0x3000, 0x8000}, {0x00100000, 0x8000, 0x8000}};
+  checkLayout("packed ELF", packed, 2);
+}
+
+int main(void) {
+  eeRamInit();
+  testPlacement();
+  testFallback();
+  testWipeRange();
+  testLayouts();
+  return testReport("test_elf_loader");
+}
@@ -0,0 +1,152 @@
+// Memory card file resolution tests.
+// Splits the launcher, DKWDRV and IPCONFIG.DAT across both memory cards, resolves their paths the way
+// the patcher does on boot and checks the launcher arguments and the number of failed opens
+#include "loader.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "test.h"
+
+#define CNF_FILE "mc1:/SYS-CONF/OSDMENU.CNF"
+#define IPCONFIG "SYS-CONF/IPCONFIG.DAT"
+
+// The config file is on mc1. mc? paths start from it
+static const char cnf[] = "path_LAUNCHER_ELF = mc?:/BOOT/launcher.elf\r\n"
+                          "path_DKWDRV_ELF = mc?:/BOOT/DKWDRV.ELF\r\n"
+                          "cdrom_use_dkwdrv = 1\r\n"
+                          "name_OSDSYS_ITEM_1 = Item\r\n"
+                          "path1_OSDSYS_ITEM_1 = mass:/ITEM.ELF\r\n";
+
+// Loads the config file and resolves the paths the way main does.
+// Returns the probeLauncher result
+static int boot(void) {
+  initConfig();
+  settings.mcSlot = 1;
+  CHECK_EQ(loadConfig(), 0);
+  CHECK_EQ(settings.mcSlot, 1);
+
+  shimResetIO();
+  int res = probeLauncher();
+  if (!res)
+    resolveFilePaths();
+  return res;
+}
+
+// Launches the item and returns the launcher argument count
+static int launch(const char *item) {
+  jmp_buf exitJump;
+  char buf[32];
+
+  snprintf(buf, sizeof(buf), "%s", item);
+  memset(&shimExec, 0, sizeof(shimExec));
+  shimExitJump = &exitJump;
+  if (!setjmp(exitJump)) {
+    launchItem(buf);
+    CHECK(0); // launchItem never returns
+  }
+  shimExitJump = NULL;
+  return shimExec.argc;
+}
+
+// Returns the launcher argument with the given prefix or NULL
+static const char *findArgument(const char *prefix) {
+  for (int i = 2; i < shimExec.argc; i++)
+    if (!strncmp(shimExec.argv[i], prefix, strlen(prefix)))
+      return shimExec.argv[i];
+  return NULL;
+}
+
+static void testSplitCards(void) {
+  shimSetRoot("build/fs/file_paths");
+  shimWriteFile(CNF_FILE, cnf, sizeof(cnf) - 1);
+  // The launcher is on the config card, DKWDRV is on the other one
+  shimWriteFile("mc1:/BOOT/launcher.elf", "L", 1);
+  shimWriteFile("mc0:/BOOT/DKWDRV.ELF", "D", 1);
+  shimWriteFile("mc1:/" IPCONFIG, "10.0.0.2", 8);
+
+  CHECK_EQ(boot(), 0);
+  CHECK_STR(settings.launcherPath, "mc1:/BOOT/launcher.elf");
+  CHECK_STR(settings.dkwdrvPath, "mc0:/BOOT/DKWDRV.ELF");
+  CHECK_STR(settings.ipconfigPath, "mc1:/" IPCONFIG);
+  // DKWDRV isn't on mc1 and IPCONFIG.DAT isn't on mc0, which is the default path card
+  CHECK_EQ(shimIO.opens, 3);
+  CHECK_EQ(shimIO.failedOpens, 2);
+
+  // FMCB items get both paths
+  shimLoadElfEntry = 0x100000;
+  CHECK_EQ(launch("fmcb1:1"), 4);
+  CHECK_STR(shimExec.argv[0], "mc1:/BOOT/launcher.elf");
+  CHECK_STR(shimExec.argv[1], "fmcb1:1");
+  CHECK_STR(findArgument("-ipconfig="), "-ipconfig=mc1:/" IPCONFIG);
+  CHECK_STR(findArgument("-dkwdrv="), "-dkwdrv=mc0:/BOOT/DKWDRV.ELF");
+
+  // The disc only needs DKWDRV
+  CHECK_EQ(launch("cdrom"), 3);
+  CHECK_STR(shimExec.argv[1], "cdrom");
+  CHECK(findArgument("-ipconfig=") == NULL);
+  CHECK_STR(findArgument("-dkwdrv="), "-dkwdrv=mc0:/BOOT/DKWDRV.ELF");
+  shimLoadElfEntry = 0;
+}
+
+static void testLauncherFallback(void) {
+  shimSetRoot("build/fs/file_paths");
+  shimWriteFile(CNF_FILE, cnf, sizeof(cnf) - 1);
+  // The launcher is only on the other card, DKWDRV and IPCONFIG.DAT are missing
+  shimWriteFile("mc0:/BOOT/launcher.elf", "L", 1);
+
+  CHECK_EQ(boot(), 0);
+  CHECK_STR(settings.launcherPath, "mc0:/BOOT/launcher.elf");
+  CHECK_STR(settings.ipconfigPath, "");
+  // Missing files are tried once on each card
+  CHECK_EQ(shimIO.opens, 1);
+  CHECK_EQ(shimIO.failedOpens, 1 + 2 + 2);
+
+  // The launcher reports the missing DKWDRV, IPCONFIG.DAT isn't passed at all
+  shimLoadElfEntry = 0x100000;
+  CHECK_EQ(launch("fmcb1:1"), 3);
+  CHECK_STR(shimExec.argv[0], "mc0:/BOOT/launcher.elf");
+  CHECK(findArgument("-ipconfig=") == NULL);
+  CHECK_STR(findArgument("-dkwdrv="), "-dkwdrv=mc1:/BOOT/DKWDRV.ELF");
+  shimLoadElfEntry = 0;
+}
+
+static void testMissingLauncher(void) {
+  shimSetRoot("build/fs/file_paths");
+  shimWriteFile(CNF_FILE, cnf, sizeof(cnf) - 1);
+
+  // The patcher exits if the launcher isn't on either card
+  CHECK(boot() < 0);
+  CHECK_EQ(shimIO.opens, 0);
+  CHECK_EQ(shimIO.failedOpens, 2);
+}
+
+static void testFullWipe(void) {
+  char fullWipe[sizeof(cnf) + 32];
+  int len = snprintf(fullWipe, sizeof(fullWipe), "launcher_full_wipe = 1\r\n%s", cnf);
+
+  shimSetRoot("build/fs/file_paths");
+  shimWriteFile(CNF_FILE, fullWipe, len);
+  shimWriteFile("mc1:/BOOT/launcher.elf", "L", 1);
+  shimWriteFile("mc0:/BOOT/DKWDRV.ELF", "D", 1);
+
+  CHECK_EQ(boot(), 0);
+  CHECK(settings.patcherFlags & FLAG_LOADER_FULL_WIPE);
+
+  // The launcher expects the argument right after the item
+  shimLoadElfEntry = 0x100000;
+  CHECK_EQ(launch("fmcb1:1"), 4);
+  CHECK_STR(shimExec.argv[1], "fmcb1:1");
+  CHECK_STR(shimExec.argv[2], "-fullwipe");
+  CHECK_EQ(launch("cdrom"), 4);
+  CHECK_STR(shimExec.argv[1], "cdrom");
+  CHECK_STR(shimExec.argv[2], "-fullwipe");
+  shimLoadElfEntry = 0;
+}
+
+int main(void) {
+  eeRamInit();
+  testSplitCards();
+  testLauncherFallback();
+  testMissingLauncher();
+  testFullWipe();
+  return testReport("test_file_paths");
+}
@@ -0,0 +1,159 @@
+// Visual game ID tests.
+// Checks the encoded game ID data and compares the strip built for the GS transfer with the sprites
+// drawn by the previous gsKit implementation
+#include "game_id.h"
+#include "gs.h"
+#include "test.h"
+
+#define STRIP_WIDTH (GAMEID_MAX_DATA * 16)
+
+// Colors drawn by the gsKit implementation (GS_SETREG_RGBA)
+#define RGBA(r, g, b) ((uint32_t)(r) | (uint32_t)(g) << 8 | (uint32_t)(b) << 16)
+#define COLOR_SEPARATOR RGBA(0xFF, 0x00, 0xFF)
+#define COLOR_ONE RGBA(0x00, 0xFF, 0xFF)
+#define COLOR_ZERO RGBA(0xFF, 0xFF, 0x00)
+
+// The strip is only built, never sent to the GS
+int gsInit(GSVideoMode vmode) { return 0; }
+
+// Draws the data the way the gsKit implementation did: a 1x2 sprite for the separator and the bit of every cell
+static void drawReference(const uint8_t *data, int dataLen, uint32_t *pixels) {
+  int width = dataLen * 16;
+  for (int i = 0; i < dataLen; i++) {
+    for (int j = 7; j >= 0; j--) {
+      int x = i * 16 + ((7 - j) * 2);
+      for (int y = 0; y < GAMEID_STRIP_HEIGHT; y++) {
+        pixels[y * width + x] = COLOR_SEPARATOR;
+        pixels[y * width + x + 1] = (data[i] >> j) & 1 ? COLOR_ONE : COLOR_ZERO;
+      }
+    }
+  }
+}
+
+// Decodes the first strip row back into bytes. Returns the number of bytes or -1 if the strip is invalid
+static int decodeStrip(const uint32_t *pixels, int width, uint8_t *data) {
+  for (int x = 0; x < width; x += 2) {
+    if (pixels[x] != COLOR_SEPARATOR)
+      return -1;
+    if ((pixels[x + 1] != COLOR_ONE) && (pixels[x + 1] != COLOR_ZERO))
+      return -1;
+    if (!(x % 16))
+      data[x / 16] = 0;
+    data[x / 16] |= (pixels[x + 1] == COLOR_ONE) << (7 - (x % 16) / 2);
+  }
+  return width / 16;
+}
+
+// Encodes the game ID and checks the data layout
+static int checkEncoding(const char *gameID, const char *expectedID, uint8_t *data) {
+  int len = encodeGameID(gameID, data);
+  int idLen = strlen(expectedID);
+  CHECK_EQ(len, 7 + idLen);
+  CHECK(len <= GAMEID_MAX_DATA);
+  CHECK_EQ(data[0], 0xA5); // Detect word
+  CHECK_EQ(data[1], 0x00); // Address offset
+  CHECK_EQ(data[3], idLen);
+  CHECK(!memcmp(&data[4], expectedID, idLen));
+  CHECK_EQ(data[4 + idLen], 0x00);
+  CHECK_EQ(data[5 + idLen], 0xD5); // End word
+  CHECK_EQ(data[6 + idLen], 0x00);
+
+  // Everything after the detect word, address offset and CRC sums up to zero with the CRC
+  uint8_t sum = data[2];
+  for (int i = 3; i < len; i++)
+    sum += data[i];
+  CHECK_EQ(sum, 0);
+  return len;
+}
+
+static void testEncoding(void) {
+  uint8_t data[GAMEID_MAX_DATA];
+  checkEncoding("SLUS_123.45", "SLUS_123.45", data);
+  CHECK_EQ(data[2], 0x4d);
+  checkEncoding("SCUS_9", "SCUS_9", data);
+  checkEncoding("", "", data);
+  // IDs are limited to 11 characters
+  checkEncoding("SLES_123.45;1", "SLES_123.45", data);
+}
+
+static void testStrip(void) {
+  static const char *ids[] = {"SLUS_123.45", "SCES_500.00", "SCUS_9", "PBPX_955.03", ""};
+  uint8_t data[GAMEID_MAX_DATA], decoded[GAMEID_MAX_DATA];
+  uint32_t strip[STRIP_WIDTH * GAMEID_STRIP_HEIGHT + 1], reference[STRIP_WIDTH * GAMEID_STRIP_HEIGHT];
+
+  for (int i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+    int len = encodeGameID(ids[i], data);
+    int width = len * 16;
+    memset(strip, 0xCC, sizeof(strip));
+    memset(reference, 0, sizeof(reference));
+    buildStrip(data, len, strip);
+    drawReference(data, len, reference);
+
+    // Pixels match the gsKit sprites and nothing is written past the strip
+    CHECK(!memcmp(strip, reference, width * GAMEID_STRIP_HEIGHT * sizeof(uint32_t)));
+    CHECK_EQ(strip[width * GAMEID_STRIP_HEIGHT], 0xCCCCCCCC);
+
+    // The strip decodes back into the data on every row
+    for (int y = 0; y < GAMEID_STRIP_HEIGHT; y++) {
+      CHECK_EQ(decodeStrip(&strip[y * width], width, decoded), len);
+      CHECK(!memcmp(decoded, data, len));
+    }
+  }
+
+  // The longest strip fits the transfer size
+  int len = encodeGameID("SLUS_123.45", data);
+  CHECK_EQ(len, GAMEID_MAX_DATA);
+  // Every row is a whole number of quadwords
+  CHECK_EQ((len * 16) % 4, 0);
+}
+
+// gsKit screen size and display area position for the video mode
+typedef struct {
+  GSVideoMode mode;
+  int width;
+  int height;
+  int startX;
+  int startY;
+} gsKitMode;
+
+static void testPosition(void) {
+  static const gsKitMode modes[] = {
+      {GS_MODE_NTSC, 640, 448, 652, 26},
+      {GS_MODE_PAL, 640, 512, 680, 37},
+  };
+  static const int expectedY[] = {316, 364};
+  uint8_t data[GAMEID_MAX_DATA];
+  int x, y;
+
+  CHECK_EQ(GS_DISPLAY_X_NTSC, modes[0].startX);
+  CHECK_EQ(GS_DISPLAY_Y_NTSC, modes[0].startY);
+  CHECK_EQ(GS_DISPLAY_X_PAL, modes[1].startX);
+  CHECK_EQ(GS_DISPLAY_Y_PAL, modes[1].startY);
+
+  for (int i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    const gsKitMode *m = &modes[i];
+    for (int len = 7; len <= GAMEID_MAX_DATA; len += GAMEID_MAX_DATA - 7) {
+      getStripPosition(m->mode, len, &x, &y);
+      // Same position as the gsKit sprites
+      CHECK_EQ(x, (m->width / 2) - (len * 8));
+      CHECK_EQ(y, m->height - (((m->height / 8) * 2) + 20));
+      CHECK_EQ(y, expectedY[i]);
+      // The strip is centered and fits the screen
+      CHECK_EQ(x * 2 + len * 16, m->width);
+      CHECK(y + GAMEID_STRIP_HEIGHT <= m->height);
+    }
+  }
+
+  // Modes other than PAL use the NTSC position
+  int len = encodeGameID("SLUS_123.45", data);
+  getStripPosition(GS_MODE_DTV_480P, len, &x, &y);
+  CHECK_EQ(x, 176);
+  CHECK_EQ(y, expectedY[0]);
+}
+
+int main(void) {
+  testEncoding();
+  testStrip();
+  testPosition();
+  return testReport("test_game_id");
+}
@@ -0,0 +1,186 @@
+// Handoff block tests.
+// Checks block serialization and validation and that the patcher fills the block
+// from the item strings captured by loadConfig without reading OSDMENU.CNF again
+#include "handoff.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define CNF_FILE "mc0:/SYS-CONF/OSDMENU.CNF"
+
+static const char cnf[] = "OSDSYS_video_mode = AUTO\r\n"
+                          "name_OSDSYS_ITEM_1 = Open PS2 Loader\r\n"
+                          "path1_OSDSYS_ITEM_1 = mass:/OPL/OPNPS2LD.ELF\r\n"
+                          "path2_OSDSYS_ITEM_1 = mc?:/APPS/OPNPS2LD.ELF\r\n"
+                          "arg_OSDSYS_ITEM_1 = -gsm=fp2\r\n"
+                          "name_OSDSYS_ITEM_2 = Empty\r\n"
+                          "path1_OSDSYS_ITEM_2 = \r\n"
+                          "arg_OSDSYS_ITEM_3 = -titleid=SLUS_123.45\r\n"
+                          "name_OSDSYS_ITEM_3 = Arguments first\r\n"
+                          "path1_OSDSYS_ITEM_3 = mmce?:/APPS/GAME.ELF\r\n"
+                          "arg_OSDSYS_ITEM_3 = -v\r\n"
+                          "path_LAUNCHER_ELF = mc?:/BOOT/launcher.elf\r\n"
+                          "name_OSDSYS_ITEM_10 = Disc\r\n"
+                          "path1_OSDSYS_ITEM_10 = cdrom\r\n";
+
+// Block with room for the header and the string data
+static union {
+  handoffHeader header;
+  uint8_t data[HANDOFF_MAX_SIZE];
+} block;
+
+// Checks the next string of the given type
+static char *nextString(HandoffStringType type, char *prev, const char *expected) {
+  char *str = handoffNextString(&block.header, type, prev);
+  if (!expected) {
+    CHECK(str == NULL);
+    return NULL;
+  }
+  CHECK(str != NULL);
+  if (str)
+    CHECK_STR(str, expected);
+  return str;
+}
+
+static void testSerialization(void) {
+  handoffInit(&block.header, 7, 1, HANDOFF_FLAG_SKIP_PS2_LOGO | HANDOFF_FLAG_USE_DKWDRV);
+  CHECK_EQ(handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_DKWDRV, "mc1:/BOOT/DKWDRV.ELF"), 0);
+  CHECK_EQ(handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_PATH, "mass:/APP.ELF"), 0);
+  CHECK_EQ(handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_ARG, "-a"), 0);
+  CHECK_EQ(handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_PATH, "mc?:/APP.ELF"), 0);
+  CHECK_EQ(handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_ARG, ""), 0);
+
+  // The block stays invalid until it is sealed
+  CHECK(handoffValidate(&block.header, HANDOFF_MAX_SIZE) != 0);
+  handoffSeal(&block.header);
+  CHECK_EQ(handoffValidate(&block.header, HANDOFF_MAX_SIZE), 0);
+
+  // Exact string data layout
+  static const char expected[] = "Dmc1:/BOOT/DKWDRV.ELF\0Pmass:/APP.ELF\0A-a\0Pmc?:/APP.ELF\0A";
+  CHECK_EQ(block.header.size, sizeof(expected));
+  CHECK(!memcmp(&block.header + 1, expected, sizeof(expected)));
+  CHECK_EQ(block.header.itemIdx, 7);
+  CHECK_EQ(block.header.mcSlot, 1);
+  CHECK_EQ(block.header.flags, HANDOFF_FLAG_SKIP_PS2_LOGO | HANDOFF_FLAG_USE_DKWDRV);
+
+  // Strings are returned in order and by type
+  char *str = nextString(HANDOFF_PATH, NULL, "mass:/APP.ELF");
+  str = nextString(HANDOFF_PATH, str, "mc?:/APP.ELF");
+  nextString(HANDOFF_PATH, str, NULL);
+  str = nextString(HANDOFF_ARG, NULL, "-a");
+  str = nextString(HANDOFF_ARG, str, "");
+  nextString(HANDOFF_ARG, str, NULL);
+  nextString(HANDOFF_DKWDRV, NULL, "mc1:/BOOT/DKWDRV.ELF");
+}
+
+static void testValidation(void) {
+  handoffInit(&block.header, 1, 0, 0);
+  handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_PATH, "mass:/APP.ELF");
+  handoffSeal(&block.header);
+  CHECK_EQ(handoffValidate(&block.header, HANDOFF_MAX_SIZE), 0);
+
+  // Corrupted string data
+  uint8_t *data = (uint8_t *)(&block.header + 1);
+  data[3] ^= 0x20;
+  CHECK(handoffValidate(&block.header, HANDOFF_MAX_SIZE) != 0);
+  data[3] ^= 0x20;
+  CHECK_EQ(handoffValidate(&block.header, HANDOFF_MAX_SIZE), 0);
+
+  // Wrong magic and version
+  block.header.magic = 0;
+  CHECK(handoffValidate(&block.header, HANDOFF_MAX_SIZE) != 0);
+  block.header.magic = HANDOFF_MAGIC;
+  block.header.version = HANDOFF_VERSION + 1;
+  CHECK(handoffValidate(&block.header, HANDOFF_MAX_SIZE) != 0);
+  block.header.version = HANDOFF_VERSION;
+
+  // Size exceeding the block
+  CHECK(handoffValidate(&block.header, sizeof(handoffHeader) + block.header.size - 1) != 0);
+  uint16_t size = block.header.size;
+  block.header.size = HANDOFF_MAX_SIZE;
+  CHECK(handoffValidate(&block.header, HANDOFF_MAX_SIZE) != 0);
+  block.header.size = size;
+
+  // Strings that don't fit are rejected without changing the block
+  char longString[HANDOFF_MAX_SIZE];
+  memset(longString, 'a', sizeof(longString) - 1);
+  longString[sizeof(longString) - 1] = '\0';
+  CHECK(handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_ARG, longString) != 0);
+  CHECK_EQ(block.header.size, size);
+  int count = 0;
+  while (!handoffAddString(&block.header, HANDOFF_MAX_SIZE, HANDOFF_ARG, "-argument"))
+    count++;
+  CHECK(count > 0);
+  CHECK(sizeof(handoffHeader) + block.header.size <= HANDOFF_MAX_SIZE);
+  handoffSeal(&block.header);
+  CHECK_EQ(handoffValidate(&block.header, HANDOFF_MAX_SIZE), 0);
+}
+
+// Fills the block the same way the patcher does before launching the item
+static int fillBlock(int itemIdx) {
+  handoffInit(&block.header, itemIdx, settings.mcSlot, 0);
+  int res = loadItemHandoff(itemIdx, &block.header, HANDOFF_MAX_SIZE);
+  if (res > 0)
+    handoffSeal(&block.header);
+  return res;
+}
+
+static void testConfigCapture(void) {
+  shimSetRoot("build/fs/handoff");
+  shimWriteFile(CNF_FILE, cnf, sizeof(cnf) - 1);
+
+  initConfig();
+  CHECK_EQ(loadConfig(), 0);
+  CHECK_EQ(settings.menuItemCount, 4);
+  CHECK_STR(settings.menuItemName[0], "Open PS2 Loader");
+  CHECK_STR(settings.menuItemName[1], "Empty");
+  CHECK_STR(settings.menuItemName[3], "Disc");
+
+  // Launching items must not touch the memory card
+  shimResetIO();
+
+  CHECK_EQ(fillBlock(1), 2);
+  CHECK_EQ(handoffValidate(&block.header, HANDOFF_MAX_SIZE), 0);
+  char *str = nextString(HANDOFF_PATH, NULL, "mass:/OPL/OPNPS2LD.ELF");
+  str = nextString(HANDOFF_PATH, str, "mc?:/APPS/OPNPS2LD.ELF");
+  nextString(HANDOFF_PATH, str, NULL);
+  str = nextString(HANDOFF_ARG, NULL, "-gsm=fp2");
+  nextString(HANDOFF_ARG, str, NULL);
+
+  // Arguments keep the config file order even when they come before the item name
+  CHECK_EQ(fillBlock(3), 1);
+  str = nextString(HANDOFF_PATH, NULL, "mmce?:/APPS/GAME.ELF");
+  nextString(HANDOFF_PATH, str, NULL);
+  str = nextString(HANDOFF_ARG, NULL, "-titleid=SLUS_123.45");
+  str = nextString(HANDOFF_ARG, str, "-v");
+  nextString(HANDOFF_ARG, str, NULL);
+
+  CHECK_EQ(fillBlock(10), 1);
+  nextString(HANDOFF_PATH, NULL, "cdrom");
+
+  // Items without paths leave the block invalid
+  CHECK_EQ(fillBlock(2), 0);
+  CHECK(handoffValidate(&block.header, HANDOFF_MAX_SIZE) != 0);
+  // Missing items are reported as errors
+  CHECK(fillBlock(4) < 0);
+
+  // Blocks too small for the item strings are reported as errors
+  handoffInit(&block.header, 1, 0, 0);
+  CHECK(loadItemHandoff(1, &block.header, sizeof(handoffHeader) + 16) < 0);
+
+  CHECK_EQ(shimIO.opens, 0);
+  CHECK_EQ(shimIO.bytesRead, 0);
+
+  // Item strings are released with the rest of the config
+  initConfig();
+  CHECK(loadItemHandoff(1, &block.header, HANDOFF_MAX_SIZE) < 0);
+}
+
+int main(void) {
+  eeRamInit();
+  testSerialization();
+  testValidation();
+  testConfigCapture();
+  return testReport("test_handoff");
+}
@@ -0,0 +1,141 @@
+// History file tests.
+// Runs updateHistoryFile on file-backed memory cards and counts the bytes written. Checks that updating
+// an existing file only writes the changed entry and that missing or corrupt files are rewritten in full
+#include "history.h"
+#include "shim/shim.h"
+#include "test.h"
+#include <libmc.h>
+
+#define HISTORY_MC0 "mc0:/BADATA-SYSTEM/history"
+#define HISTORY_MC1 "mc1:/BADATA-SYSTEM/history"
+#define HISTORY_OLD_MC0 "mc0:/BADATA-SYSTEM/history.old"
+#define HISTORY_ENTRIES 21
+#define ICON_SYS_SIZE 1776
+
+typedef struct {
+  char titleID[16];
+  uint8_t launchCount;
+  uint8_t bitmask;
+  uint8_t shiftAmount;
+  uint8_t padding;
+  uint16_t timestamp;
+} historyEntry;
+
+// Icons written by createSystemDataDir
+unsigned char icon_J_sys[ICON_SYS_SIZE];
+unsigned char icon_C_sys[ICON_SYS_SIZE];
+unsigned char icon_A_sys[ICON_SYS_SIZE];
+
+static historyEntry history[HISTORY_ENTRIES + 1];
+
+// Reads the history file and returns the file size
+static int readHistory(const char *path) {
+  memset(history, 0, sizeof(history));
+  return shimReadFile(path, history, sizeof(history));
+}
+
+// Returns the slot containing the title ID or -1
+static int findTitle(const char *titleID) {
+  for (int i = 0; i < HISTORY_ENTRIES; i++)
+    if (!strcmp(history[i].titleID, titleID))
+      return i;
+  return -1;
+}
+
+static void setUp(void) {
+  shimSetRoot("build/fs/history");
+  shimWriteFile("rom0:ROMVER", "0220AC20060905", 14);
+  shimMcType[0] = shimMcType[1] = sceMcTypePS2;
+  shimCdClock = (sceCdCLOCK){.day = 0x01, .month = 0x05, .year = 0x25};
+}
+
+static void testNewFile(void) {
+  setUp();
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SLUS_123.45"), 0);
+
+  // Both cards get the system directory icon and the full history file
+  CHECK_EQ(shimIO.bytesWritten, 2 * (ICON_SYS_SIZE + sizeof(history[0]) * HISTORY_ENTRIES));
+  CHECK_EQ(readHistory(HISTORY_MC1), sizeof(history[0]) * HISTORY_ENTRIES);
+  CHECK_EQ(readHistory(HISTORY_MC0), sizeof(history[0]) * HISTORY_ENTRIES);
+  int slot = findTitle("SLUS_123.45");
+  CHECK(slot >= 0);
+  if (slot >= 0)
+    CHECK_EQ(history[slot].launchCount, 1);
+}
+
+static void testInPlaceUpdate(void) {
+  setUp();
+  CHECK_EQ(updateHistoryFile("SLUS_123.45"), 0);
+
+  // Existing titles only rewrite their entry
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SLUS_123.45"), 0);
+  CHECK_EQ(shimIO.bytesWritten, 2 * sizeof(history[0]));
+  CHECK_EQ(readHistory(HISTORY_MC0), sizeof(history[0]) * HISTORY_ENTRIES);
+  CHECK_EQ(history[findTitle("SLUS_123.45")].launchCount, 2);
+
+  // New titles only write the new entry
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SCES_543.21"), 0);
+  CHECK_EQ(shimIO.bytesWritten, 2 * sizeof(history[0]));
+  CHECK_EQ(readHistory(HISTORY_MC1), sizeof(history[0]) * HISTORY_ENTRIES);
+  CHECK(findTitle("SCES_543.21") >= 0);
+  CHECK_EQ(history[findTitle("SLUS_123.45")].launchCount, 2);
+
+  // Cards that aren't formatted PS2 memory cards are left alone
+  shimMcType[1] = sceMcTypeNoCard;
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SCES_543.21"), 0);
+  CHECK_EQ(shimIO.bytesWritten, sizeof(history[0]));
+}
+
+static void testFullFile(void) {
+  setUp();
+
+  // All slots are used, the least used entry is evicted into history.old
+  for (int i = 0; i < HISTORY_ENTRIES; i++) {
+    snprintf(history[i].titleID, sizeof(history[i].titleID), "SLPS_250.%02d", i);
+    history[i].launchCount = (i == 7) ? 1 : 5;
+    history[i].bitmask = 1;
+    history[i].timestamp = 1;
+  }
+  shimWriteFile(HISTORY_MC0, history, sizeof(history[0]) * HISTORY_ENTRIES);
+  shimMcType[1] = sceMcTypeNoCard;
+
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SLUS_123.45"), 0);
+  CHECK_EQ(shimIO.bytesWritten, 2 * sizeof(history[0]));
+  CHECK_EQ(readHistory(HISTORY_MC0), sizeof(history[0]) * HISTORY_ENTRIES);
+  CHECK_EQ(findTitle("SLUS_123.45"), 7);
+  CHECK_EQ(findTitle("SLPS_250.06"), 6);
+  CHECK_EQ(readHistory(HISTORY_OLD_MC0), sizeof(history[0]));
+  CHECK_STR(history[0].titleID, "SLPS_250.07");
+}
+
+static void testCorruptFile(void) {
+  setUp();
+  shimWriteFile("mc0:/BADATA-SYSTEM/icon.sys", icon_A_sys, ICON_SYS_SIZE);
+  shimWriteFile(HISTORY_MC0, "short", 5);
+  shimMcType[1] = sceMcTypeNoCard;
+
+  // Short files are replaced with a full file
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SLUS_123.45"), 0);
+  CHECK_EQ(shimIO.bytesWritten, sizeof(history[0]) * HISTORY_ENTRIES);
+  CHECK_EQ(readHistory(HISTORY_MC0), sizeof(history[0]) * HISTORY_ENTRIES);
+  CHECK(findTitle("SLUS_123.45") >= 0);
+
+  // Invalid title IDs are never written
+  shimResetIO();
+  CHECK_EQ(updateHistoryFile("SLUS"), 0);
+  CHECK_EQ(shimIO.bytesWritten, 0);
+}
+
+int main(void) {
+  testNewFile();
+  testInPlaceUpdate();
+  testFullFile();
+  testCorruptFile();
+  return testReport("test_history");
+}
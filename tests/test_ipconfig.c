@@ -0,0 +1,86 @@
+// IPCONFIG.DAT parser tests.
+// Checks padded, short, CRLF-terminated and malformed files and the SMAP address formatting
+#include "ipconfig.h"
+#include "test.h"
+#include <errno.h>
+
+// Parses the data and checks the result. NULL addresses must be all zeroes
+static void checkParse(const char *data, const char *ip, const char *netmask, const char *gateway) {
+  ipConfig config;
+  char buf[IP_ADDRESS_LEN];
+  const char *expected[] = {ip, netmask, gateway};
+  uint8_t *fields[] = {config.ip, config.netmask, config.gateway};
+
+  memset(&config, 0xff, sizeof(config));
+  CHECK_EQ(parseIPConfig(data, &config), 0);
+  for (int i = 0; i < 3; i++) {
+    CHECK(formatIPAddress(buf, sizeof(buf), fields[i]) > 0);
+    CHECK_STR(buf, expected[i] ? expected[i] : "0.0.0.0");
+  }
+}
+
+static void checkInvalid(const char *data) {
+  ipConfig config;
+  int res = parseIPConfig(data, &config);
+  if (res != -EINVAL)
+    fprintf(stderr, "  \"%s\" parsed\n", data);
+  CHECK_EQ(res, -EINVAL);
+}
+
+static void testValid(void) {
+  checkParse("192.168.0.10 255.255.255.0 192.168.0.1", "192.168.0.10", "255.255.255.0", "192.168.0.1");
+  // Zero-padded octets as written by some tools
+  checkParse("192.168.000.010 255.255.255.000 192.168.000.001", "192.168.0.10", "255.255.255.0", "192.168.0.1");
+  // Line endings, tabs and extra whitespace
+  checkParse("192.168.0.10 255.255.255.0 192.168.0.1\r\n", "192.168.0.10", "255.255.255.0", "192.168.0.1");
+  checkParse("  10.0.0.2\t255.0.0.0  \r\n 10.0.0.1\n", "10.0.0.2", "255.0.0.0", "10.0.0.1");
+  // Netmask and gateway are optional
+  checkParse("10.0.0.2", "10.0.0.2", NULL, NULL);
+  checkParse("10.0.0.2\r\n", "10.0.0.2", NULL, NULL);
+  checkParse("10.0.0.2 255.0.0.0", "10.0.0.2", "255.0.0.0", NULL);
+  // Anything after the gateway is ignored
+  checkParse("10.0.0.2 255.0.0.0 10.0.0.1 garbage", "10.0.0.2", "255.0.0.0", "10.0.0.1");
+  checkParse("255.255.255.255 0.0.0.0 1.2.3.4", "255.255.255.255", NULL, "1.2.3.4");
+}
+
+static void testInvalid(void) {
+  checkInvalid("");
+  checkInvalid(" \r\n");
+  checkInvalid("192.168.0");
+  checkInvalid("192.168.0.");
+  checkInvalid("192.168..10");
+  checkInvalid(".168.0.10");
+  checkInvalid("192.168.0.256");
+  checkInvalid("192.168.0.1000");
+  checkInvalid("192.168.0.0010");
+  checkInvalid("192.168.0.10.5");
+  checkInvalid("192.168.0.10x");
+  checkInvalid("192,168,0,10");
+  checkInvalid("-1.168.0.10");
+  checkInvalid("a.b.c.d");
+  // Invalid optional addresses are errors too
+  checkInvalid("192.168.0.10 255.255.255");
+  checkInvalid("192.168.0.10 255.255.255.0 192.168.0.300");
+}
+
+static void testFormat(void) {
+  static const uint8_t addr[4] = {192, 168, 100, 200};
+  char buf[IP_ADDRESS_LEN + 3];
+
+  // The longest address fits into IP_ADDRESS_LEN
+  CHECK_EQ(formatIPAddress(buf, IP_ADDRESS_LEN, addr), 15);
+  CHECK_STR(buf, "192.168.100.200");
+  CHECK_EQ(formatIPAddress(buf, 15, addr), -1);
+
+  // The SMAP module argument the way initSMAPArguments builds it
+  memcpy(buf, "ip=", 3);
+  CHECK_EQ(formatIPAddress(&buf[3], sizeof(buf) - 3, addr), 15);
+  CHECK_STR(buf, "ip=192.168.100.200");
+}
+
+int main(void) {
+  testValid();
+  testInvalid();
+  testFormat();
+  return testReport("test_ipconfig");
+}
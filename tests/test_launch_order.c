@@ -0,0 +1,148 @@
+// Menu item order tests.
+// Loads a config file next to a launch statistics file and checks the item order produced by sorting
+// by launch count and by last launch time, tie breaking and the preselected last launched item
+#include "settings.h"
+#include "shim/shim.h"
+#include "stats.h"
+#include "stubs_patcher.h"
+#include "test.h"
+
+#define CNF_FILE "mc1:/SYS-CONF/OSDMENU.CNF"
+#define STATS_FILE "mc1:/SYS-CONF/OSDMENU.STA"
+
+static const char items[] = "name_OSDSYS_ITEM_1 = One\r\n"
+                            "name_OSDSYS_ITEM_2 = Two\r\n"
+                            "name_OSDSYS_ITEM_3 = Three\r\n"
+                            "name_OSDSYS_ITEM_4 = Four\r\n"
+                            "name_OSDSYS_ITEM_5 = Five\r\n"
+                            "name_OSDSYS_ITEM_6 = Six\r\n";
+
+static uint32_t timestamp(int day, int minute) { return STATS_SET_TIMESTAMP(25, 5, day, 12, minute, 0); }
+
+// Writes the config file with the given options followed by the items and loads it
+static void loadWithOptions(const char *options, const launchStatsRecord *records, int recordCount) {
+  char cnf[512];
+  int len = snprintf(cnf, sizeof(cnf), "%s%s", options, items);
+
+  shimSetRoot("build/fs/launch_order");
+  shimWriteFile(CNF_FILE, cnf, len);
+  shimWriteFile(STATS_FILE, records, recordCount * sizeof(launchStatsRecord));
+  initConfig();
+  settings.mcSlot = 1;
+  CHECK_EQ(loadConfig(), 0);
+  CHECK_EQ(settings.menuItemCount, 6);
+}
+
+// Checks the item order. Names are separated with '|'
+static void checkOrder(const char *expected) {
+  char names[128] = "";
+  for (int i = 0; i < settings.menuItemCount; i++) {
+    if (i)
+      strcat(names, "|");
+    strcat(names, settings.menuItemName[i]);
+  }
+  CHECK_STR(names, expected);
+
+  // Config file indices follow the names
+  static const char *configOrder[] = {"One", "Two", "Three", "Four", "Five", "Six"};
+  for (int i = 0; i < settings.menuItemCount; i++)
+    CHECK_STR(settings.menuItemName[i], configOrder[settings.menuItemIdx[i] - 1]);
+}
+
+// Appended records for the same item are summed, compacted records count as several launches.
+// Items 4 and 6 were never launched, item 9 is not in the config file
+static const launchStatsRecord records[] = {
+    {.itemIdx = 2, .launchCount = 3, .timestamp = 0},
+    {.itemIdx = 5, .launchCount = 1, .timestamp = 0},
+    {.itemIdx = 3, .launchCount = 1, .timestamp = 0},
+    {.itemIdx = 9, .launchCount = 7, .timestamp = 0},
+    {.itemIdx = 5, .launchCount = 1, .timestamp = 0},
+    {.itemIdx = 1, .launchCount = 1, .timestamp = 0},
+};
+
+// Fills in the timestamps: item 2 on day 1, 5 on day 2 and 3, 3 on day 4, 9 on day 5 and 1 on day 6
+static void setTimestamps(launchStatsRecord *dst) {
+  static const int days[] = {1, 2, 4, 5, 3, 6};
+  memcpy(dst, records, sizeof(records));
+  for (int i = 0; i < 6; i++)
+    dst[i].timestamp = timestamp(days[i], 0);
+}
+
+static void testFrequency(void) {
+  launchStatsRecord stats[6];
+  setTimestamps(stats);
+
+  // Two: 3 launches, Five: 2, One and Three: 1 each with One launched later
+  loadWithOptions("OSDSYS_sort_items = frequency\r\n", stats, 6);
+  checkOrder("Two|Five|One|Three|Four|Six");
+  CHECK_EQ(settings.initialItem, -1);
+}
+
+static void testRecency(void) {
+  launchStatsRecord stats[6];
+  setTimestamps(stats);
+
+  // The newest timestamp of Five is from day 3
+  loadWithOptions("OSDSYS_sort_items = recency\r\n", stats, 6);
+  checkOrder("One|Three|Five|Two|Four|Six");
+  CHECK_EQ(settings.initialItem, -1);
+}
+
+static void testTies(void) {
+  // Equal launch times are ordered by launch count
+  launchStatsRecord stats[] = {
+      {.itemIdx = 4, .launchCount = 1, .timestamp = timestamp(1, 0)},
+      {.itemIdx = 6, .launchCount = 2, .timestamp = timestamp(1, 0)},
+      {.itemIdx = 2, .launchCount = 1, .timestamp = timestamp(1, 0)},
+  };
+  loadWithOptions("OSDSYS_sort_items = recency\r\n", stats, 3);
+  checkOrder("Six|Two|Four|One|Three|Five");
+
+  // Equal launch counts are ordered by launch time, items equal in both keep the config file order
+  stats[1].launchCount = 1;
+  stats[1].timestamp = timestamp(1, 1);
+  loadWithOptions("OSDSYS_sort_items = frequency\r\n", stats, 3);
+  checkOrder("Six|Two|Four|One|Three|Five");
+  stats[1].timestamp = timestamp(1, 0);
+  loadWithOptions("OSDSYS_sort_items = frequency\r\n", stats, 3);
+  checkOrder("Two|Four|Six|One|Three|Five");
+
+  // Nothing changes without launches
+  loadWithOptions("OSDSYS_sort_items = frequency\r\n", stats, 0);
+  checkOrder("One|Two|Three|Four|Five|Six");
+}
+
+static void testSelectLast(void) {
+  launchStatsRecord stats[6];
+  setTimestamps(stats);
+
+  // One is the last launched item
+  loadWithOptions("OSDSYS_select_last_item = 1\r\n", stats, 6);
+  checkOrder("One|Two|Three|Four|Five|Six");
+  CHECK_EQ(settings.initialItem, 0);
+
+  // The selection follows the item when the menu is sorted
+  loadWithOptions("OSDSYS_sort_items = frequency\r\nOSDSYS_select_last_item = 1\r\n", stats, 6);
+  checkOrder("Two|Five|One|Three|Four|Six");
+  CHECK_EQ(settings.initialItem, 2);
+
+  // The last launched item was removed from the config file: the newest existing item is selected
+  stats[5].itemIdx = 7;
+  loadWithOptions("OSDSYS_select_last_item = 1\r\n", stats, 6);
+  CHECK_EQ(settings.initialItem, 2); // Three, launched on day 4
+
+  // No launched item is left
+  for (int i = 0; i < 6; i++)
+    stats[i].itemIdx = 7 + i;
+  loadWithOptions("OSDSYS_select_last_item = 1\r\n", stats, 6);
+  CHECK_EQ(settings.initialItem, -1);
+}
+
+int main(void) {
+  eeRamInit();
+  testFrequency();
+  testRecency();
+  testTies();
+  testSelectLast();
+  return testReport("test_launch_order");
+}
@@ -0,0 +1,182 @@
+// Fallback path launch simulator.
+// Runs launchPaths against simulated devices where every IOP reset, driver load and file probe takes time,
+// and compares the time to launch with trying the paths one by one the way handlers did before the driver
+// union set. Checks that devices whose drivers fail to load are dropped from the set without losing the rest
+#include "handlers.h"
+#include "init.h"
+#include "test.h"
+#include <errno.h>
+#include <setjmp.h>
+#include <stdlib.h>
+
+// Simulated latencies in milliseconds
+#define IOP_RESET_MS 300
+#define DRIVER_LOAD_MS 50
+#define PROBE_MS 20
+
+// Simulated devices
+static DeviceType brokenDevices; // Devices whose drivers fail to load
+static const char *presentPath;  // Path of the only existing ELF
+
+// Simulation state
+static DeviceType loadedDevices;
+static DeviceType failedDevices;
+static uint32_t elapsedMs;
+static int iopResets;
+static int probes;
+static char launchedPath[64];
+static jmp_buf launchJump;
+
+// Models the real initModules: the IOP is only reset when the request isn't covered by the loaded drivers
+int initModules(DeviceType device) {
+  if ((loadedDevices & device) == device)
+    return 0;
+
+  iopResets++;
+  elapsedMs += IOP_RESET_MS;
+  loadedDevices = Device_None;
+  failedDevices = Device_None;
+  for (DeviceType d = Device_MemoryCard; d <= Device_CDROM; d <<= 1) {
+    if (!(device & d))
+      continue;
+    elapsedMs += DRIVER_LOAD_MS;
+    if (brokenDevices & d) {
+      failedDevices = d;
+      return -1;
+    }
+  }
+  loadedDevices = device;
+  return 0;
+}
+
+DeviceType getFailedDevices() { return failedDevices; }
+
+void rebootPS2() {}
+
+// Loads the drivers like the real handlers and leaves the launcher if the path exists
+static int probe(DeviceType device, char *path) {
+  if (initModules(device))
+    return -ENODEV;
+
+  probes++;
+  elapsedMs += PROBE_MS;
+  if (presentPath && !strcmp(path, presentPath)) {
+    snprintf(launchedPath, sizeof(launchedPath), "%s", path);
+    longjmp(launchJump, 1);
+  }
+  return -ENOENT;
+}
+
+int handleMC(int argc, char *argv[]) { return probe(Device_MemoryCard, argv[0]); }
+int handleMMCE(int argc, char *argv[]) { return probe(Device_MMCE, argv[0]); }
+int handleBDM(DeviceType device, int argc, char *argv[]) { return probe(device, argv[0]); }
+int handlePFS(int argc, char *argv[]) { return probe(Device_PFS, argv[0]); }
+int handleCDROM(int argc, char *argv[]) { return probe(Device_CDROM, argv[0]); }
+
+typedef struct {
+  uint32_t elapsedMs;
+  int iopResets;
+  int probes;
+} simResult;
+
+static void resetSimulation(DeviceType broken, const char *present) {
+  brokenDevices = broken;
+  presentPath = present;
+  loadedDevices = failedDevices = Device_None;
+  elapsedMs = 0;
+  iopResets = probes = 0;
+  launchedPath[0] = '\0';
+}
+
+// Runs launchPaths with the paths. Returns 0 if an ELF was launched
+static int simulate(const char **paths, int count, DeviceType broken, const char *present, simResult *result) {
+  linkedStr *lstr = NULL;
+  char *argv[] = {NULL, NULL};
+  int res = -1;
+
+  resetSimulation(broken, present);
+  for (int i = 0; i < count; i++)
+    lstr = addStr(lstr, (char *)paths[i]);
+
+  if (!setjmp(launchJump))
+    launchPaths(1, argv, lstr);
+  else
+    res = 0;
+
+  *result = (simResult){elapsedMs, iopResets, probes};
+  freeLinkedStr(lstr);
+  return res;
+}
+
+// Tries the paths one by one with each handler loading only its own drivers
+static int simulateSequential(const char **paths, int count, DeviceType broken, const char *present, simResult *result) {
+  char *argv[] = {NULL, NULL};
+  int res = -1;
+
+  resetSimulation(broken, present);
+  if (!setjmp(launchJump)) {
+    for (int i = 0; i < count; i++) {
+      argv[0] = (char *)paths[i];
+      launchPath(1, argv);
+    }
+  } else
+    res = 0;
+
+  *result = (simResult){elapsedMs, iopResets, probes};
+  return res;
+}
+
+static void testUnionSet(void) {
+  // The ELF is on the last path. All three devices are loaded with one IOP reset,
+  // mmceman is loaded together with mcman and mcserv
+  const char *paths[] = {"mmce0:/APPS/APP.ELF", "ata:/APPS/APP.ELF", "mc0:/APPS/APP.ELF"};
+  simResult res, seq;
+  CHECK_EQ(simulate(paths, 3, Device_None, paths[2], &res), 0);
+  CHECK_STR(launchedPath, paths[2]);
+  CHECK_EQ(res.iopResets, 1);
+  CHECK_EQ(res.probes, 3);
+
+  CHECK_EQ(simulateSequential(paths, 3, Device_None, paths[2], &seq), 0);
+  CHECK_EQ(seq.iopResets, 3);
+  CHECK(res.elapsedMs < seq.elapsedMs);
+  printf("  mmce -> ata -> mc: %u ms, %d IOP resets (one by one: %u ms, %d IOP resets)\n", res.elapsedMs, res.iopResets, seq.elapsedMs,
+         seq.iopResets);
+
+  // Conflicting BDM devices still reload drivers, but only once for the device outside of the set
+  const char *bdm[] = {"mass:/APP.ELF", "mx4sio:/APP.ELF", "mc1:/APP.ELF"};
+  CHECK_EQ(simulate(bdm, 3, Device_None, bdm[1], &res), 0);
+  CHECK_STR(launchedPath, bdm[1]);
+  CHECK_EQ(res.iopResets, 2);
+}
+
+static void testFailingDriver(void) {
+  // UDPBD can't load without IPCONFIG.DAT. The other devices are still loaded together,
+  // and USB takes the place of UDPBD in the set since they no longer conflict
+  const char *paths[] = {"udpbd:/APP.ELF", "mass:/APP.ELF", "mc0:/APP.ELF"};
+  simResult res, seq;
+  CHECK_EQ(simulate(paths, 3, Device_UDPBD, paths[2], &res), 0);
+  CHECK_STR(launchedPath, paths[2]);
+  CHECK_EQ(res.iopResets, 2);
+  CHECK_EQ(res.probes, 2);
+
+  CHECK_EQ(simulateSequential(paths, 3, Device_UDPBD, paths[2], &seq), 0);
+  CHECK(res.elapsedMs < seq.elapsedMs);
+  printf("  udpbd (failing) -> mass -> mc: %u ms, %d IOP resets (one by one: %u ms, %d IOP resets)\n", res.elapsedMs, res.iopResets,
+         seq.elapsedMs, seq.iopResets);
+
+  // Every path is still tried when nothing is found
+  CHECK(simulate(paths, 3, Device_UDPBD, NULL, &res) < 0);
+  CHECK_EQ(res.probes, 2);
+  CHECK_EQ(res.iopResets, 2);
+
+  // All drivers failing
+  CHECK(simulate(paths, 3, Device_UDPBD | Device_USB | Device_MemoryCard, NULL, &res) < 0);
+  CHECK_EQ(res.probes, 0);
+  CHECK_EQ(res.iopResets, 3);
+}
+
+int main(void) {
+  testUnionSet();
+  testFailingDriver();
+  return testReport("test_launch_paths");
+}
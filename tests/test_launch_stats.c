@@ -0,0 +1,132 @@
+// Launch statistics file tests.
+// Checks record appending, recovery from interrupted writes and compaction of the file
+// into one record per item in first-launch order
+#include "launch_stats.h"
+#include "shim/shim.h"
+#include "stats.h"
+#include "test.h"
+
+#define CNF_PATH "mc1:/SYS-CONF/OSDMENU.CNF"
+#define STATS_FILE "mc1:/SYS-CONF/OSDMENU.STA"
+
+static launchStatsRecord records[STATS_MAX_RECORDS + 2];
+
+// Sets the real-time clock to 2025-05-<day> 12:<minute>:00
+static void setClock(int day, int minute) {
+  shimCdClock.year = 0x25;
+  shimCdClock.month = 0x05;
+  shimCdClock.day = (day / 10) << 4 | (day % 10);
+  shimCdClock.hour = 0x12;
+  shimCdClock.minute = (minute / 10) << 4 | (minute % 10);
+  shimCdClock.second = 0;
+}
+
+static uint32_t timestamp(int day, int minute) { return STATS_SET_TIMESTAMP(25, 5, day, 12, minute, 0); }
+
+// Reads the statistics file and returns the file size
+static int readStats(void) {
+  memset(records, 0, sizeof(records));
+  return shimReadFile(STATS_FILE, records, sizeof(records));
+}
+
+static void writeStats(int count, int extraBytes) {
+  shimWriteFile(STATS_FILE, records, count * sizeof(launchStatsRecord) + extraBytes);
+}
+
+static void testAppend(void) {
+  shimSetRoot("build/fs/launch_stats");
+  setClock(1, 0);
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 3), 0);
+  setClock(1, 1);
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 7), 0);
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 3), 0);
+
+  CHECK_EQ(readStats(), 3 * sizeof(launchStatsRecord));
+  CHECK_EQ(records[0].itemIdx, 3);
+  CHECK_EQ(records[0].timestamp, timestamp(1, 0));
+  CHECK_EQ(records[1].itemIdx, 7);
+  CHECK_EQ(records[1].launchCount, 1);
+  CHECK_EQ(records[2].itemIdx, 3);
+  CHECK_EQ(records[2].timestamp, timestamp(1, 1));
+
+  // The file stays on the card containing the config file
+  CHECK(shimReadFile("mc0:/SYS-CONF/OSDMENU.STA", records, sizeof(records)) < 0);
+}
+
+static void testInterruptedWrite(void) {
+  shimSetRoot("build/fs/launch_stats");
+  readStats();
+  records[0] = (launchStatsRecord){.itemIdx = 1, .launchCount = 1, .timestamp = timestamp(1, 0)};
+  records[1] = (launchStatsRecord){.itemIdx = 2, .launchCount = 1, .timestamp = timestamp(1, 1)};
+  memset(&records[2], 0xAA, 3);
+  writeStats(2, 3);
+
+  // The incomplete record is overwritten
+  setClock(2, 0);
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 5), 0);
+  CHECK_EQ(readStats(), 3 * sizeof(launchStatsRecord));
+  CHECK_EQ(records[1].itemIdx, 2);
+  CHECK_EQ(records[2].itemIdx, 5);
+  CHECK_EQ(records[2].launchCount, 1);
+  CHECK_EQ(records[2].timestamp, timestamp(2, 0));
+}
+
+static void testCompaction(void) {
+  shimSetRoot("build/fs/launch_stats");
+
+  // Items 10-19 launched in turn, item 15 is launched first
+  records[0] = (launchStatsRecord){.itemIdx = 15, .launchCount = 1, .timestamp = timestamp(1, 0)};
+  for (int i = 1; i < STATS_MAX_RECORDS; i++)
+    records[i] = (launchStatsRecord){.itemIdx = 10 + (i % 10), .launchCount = 1, .timestamp = timestamp(1 + i / 60, i % 60)};
+  // Saturated counter
+  records[1].launchCount = 0xFFF0;
+  // Interrupted write after the full file
+  writeStats(STATS_MAX_RECORDS, 5);
+
+  setClock(20, 0);
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 42), 0);
+  CHECK_EQ(readStats(), 11 * sizeof(launchStatsRecord));
+
+  // One record per item in first-launch order, followed by the new record
+  static const int order[] = {15, 11, 12, 13, 14, 16, 17, 18, 19, 10, 42};
+  for (int i = 0; i < 11; i++)
+    CHECK_EQ(records[i].itemIdx, order[i]);
+  CHECK_EQ(records[0].launchCount, 52);
+  CHECK_EQ(records[1].launchCount, 0xFFFF);
+  CHECK_EQ(records[2].launchCount, 51);
+  CHECK_EQ(records[9].launchCount, 51);
+  CHECK_EQ(records[9].timestamp, timestamp(1 + 510 / 60, 510 % 60));
+  CHECK_EQ(records[8].timestamp, timestamp(1 + 509 / 60, 509 % 60));
+  CHECK_EQ(records[10].launchCount, 1);
+  CHECK_EQ(records[10].timestamp, timestamp(20, 0));
+
+  // New records are appended after the compacted ones
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 15), 0);
+  CHECK_EQ(readStats(), 12 * sizeof(launchStatsRecord));
+  CHECK_EQ(records[11].itemIdx, 15);
+}
+
+static void testTooManyItems(void) {
+  shimSetRoot("build/fs/launch_stats");
+
+  // Every record belongs to a different item, the oldest ones are dropped
+  for (int i = 0; i < STATS_MAX_RECORDS; i++)
+    records[i] = (launchStatsRecord){.itemIdx = i, .launchCount = 1, .timestamp = timestamp(1 + i / 60, i % 60)};
+  writeStats(STATS_MAX_RECORDS, 0);
+
+  setClock(20, 0);
+  CHECK_EQ(updateLaunchStats(CNF_PATH, 1000), 0);
+  int count = readStats() / sizeof(launchStatsRecord);
+  CHECK_EQ(count, STATS_MAX_RECORDS / 2);
+  CHECK_EQ(records[count - 1].itemIdx, 1000);
+  for (int i = 0; i < count - 1; i++)
+    CHECK(records[i].itemIdx > STATS_MAX_RECORDS / 2);
+}
+
+int main(void) {
+  testAppend();
+  testInterruptedWrite();
+  testCompaction();
+  testTooManyItems();
+  return testReport("test_launch_stats");
+}
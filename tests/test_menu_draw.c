@@ -0,0 +1,309 @@
+// Scroll menu drawing benchmark.
+// Patches a synthetic OSDSYS image with 250 menu items and draws the menu frame by frame the way OSDSYS does.
+// Checks that only the visible items reach DrawMenuItem with the same positions and alpha as the original
+// per-item math. The benchmark draws the same frames with the original implementation and checks that the patch
+// makes no more DrawMenuItem calls and takes no more time
+#include "animation.h"
+#include "patches_fmcb.h"
+#include "patterns_fmcb.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "test.h"
+
+// Patcher functions that are not declared in the headers
+const char *getStringPointer(const char **strings, uint32_t index);
+void drawMenuItemSelected(int X, int Y, uint32_t *color, int alpha, const char *string, int num);
+void drawMenuItemUnselected(int X, int Y, uint32_t *color, int alpha, const char *string, int num);
+
+#define OSD_BASE 0x200000
+#define OFF_OSD_STRING 0x1000
+#define OFF_INPUT_HANDLER 0x2000
+#define OFF_MENU_INFO 0x3010
+#define OFF_DRAW_MENU_ITEM 0x4000
+
+#define ITEM_COUNT CUSTOM_ITEMS
+#define MENU_X 430
+#define MENU_Y 110
+#define BENCH_FRAMES 10000
+#define BENCH_RUNS 7
+
+// Menu info struct fields
+#define ENTRY_COUNT (OSD_BASE + OFF_MENU_INFO + 8)
+#define CURRENT_ENTRY (OSD_BASE + OFF_MENU_INFO + 16)
+
+typedef struct {
+  int x, y, alpha;
+  const char *string;
+} drawCall;
+
+static drawCall calls[ITEM_COUNT * 4];
+static int callCount;
+
+// Stands in for the OSDSYS DrawMenuItem function.
+// The test is linked below 0x10000000, so the patch can read the address from the jal instruction.
+// Never inlined, so both benchmarked implementations pay for the same call
+__attribute__((noipa)) static void drawMenuItemStub(int X, int Y, uint32_t *color, int alpha, const char *string) {
+  if (callCount < (int)(sizeof(calls) / sizeof(calls[0])))
+    calls[callCount] = (drawCall){X, Y, alpha, string};
+  callCount++;
+}
+
+static void placePattern(uint32_t offset, const uint32_t *pattern, int words) {
+  for (int i = 0; i < words; i++)
+    _sw(pattern[i], OSD_BASE + offset + i * 4);
+}
+#define PLACE(offset, name) placePattern((offset), name, sizeof(name) / sizeof(uint32_t))
+
+static const char *builtinNames[2] = {"Browser", "System Configuration"};
+static const char *entryStrings[2 + ITEM_COUNT];
+
+// Returns the entry string the way the patched OSD string function does
+static const char *entryString(uint32_t entry) {
+  if (entry < 2)
+    return builtinNames[entry];
+  uint32_t *menu = (uint32_t *)(uintptr_t)_lw(OSD_BASE + OFF_MENU_INFO + 4);
+  return getStringPointer(NULL, menu[entry * 2]);
+}
+
+// Returns the entry number for the drawn string or -1 for cursors and delimiters
+static int entryNumber(const char *string) {
+  for (int i = 0; i < 2; i++)
+    if (string == builtinNames[i])
+      return i;
+  for (int i = 0; i < ITEM_COUNT; i++)
+    if (string == settings.menuItemName[i])
+      return i + 2;
+  return -1;
+}
+
+// Builds the image, loads 250 top-level items and applies the menu patches
+static void setupMenu(void) {
+  static char names[ITEM_COUNT][8];
+
+  memset((void *)OSD_BASE, 0, OFF_DRAW_MENU_ITEM + 0x100);
+  PLACE(OFF_OSD_STRING, patternOSDString);
+  PLACE(OFF_INPUT_HANDLER, patternUserInputHandler);
+  PLACE(OFF_MENU_INFO, patternMenuInfo);
+  _sw(OSD_BASE + OFF_MENU_INFO - 16, OSD_BASE + OFF_MENU_INFO + 4);
+  PLACE(OFF_DRAW_MENU_ITEM, patternDrawMenuItem);
+  PLACE(OFF_DRAW_MENU_ITEM + 48, patternDrawMenuItem);
+  _sw(0x0c000000 | ((uint32_t)(uintptr_t)drawMenuItemStub >> 2), OSD_BASE + OFF_DRAW_MENU_ITEM + 32);
+
+  memset(&settings, 0, sizeof(settings));
+  for (int i = 0; i < ITEM_COUNT; i++) {
+    snprintf(names[i], sizeof(names[i]), "Item%d", i);
+    settings.menuItemName[i] = names[i];
+    settings.menuItemIdx[i] = i + 1;
+    settings.menuItemParent[i] = -1;
+  }
+  settings.menuItemCount = ITEM_COUNT;
+  settings.initialItem = -1;
+  settings.patcherFlags = FLAG_SCROLL_MENU;
+  settings.menuX = MENU_X;
+  settings.menuY = MENU_Y;
+  settings.displayedItems = 7;
+  settings.cursorMaxVelocity = 1000;
+  settings.cursorAcceleration = 100;
+  settings.scrollDuration = 150;
+
+  CHECK_EQ(patchMenu((uint8_t *)OSD_BASE), 0);
+  CHECK_EQ(patchMenuDraw((uint8_t *)OSD_BASE), 0);
+  CHECK_EQ(_lw(ENTRY_COUNT), 2 + ITEM_COUNT);
+  for (int i = 0; i < 2 + ITEM_COUNT; i++)
+    entryStrings[i] = entryString(i);
+}
+
+// Draws one OSDSYS frame 1/60 s after the previous one.
+// The patched OSDSYS passes the entry number multiplied by 8 as the last argument
+static void drawFrame(void) {
+  uint32_t current = _lw(CURRENT_ENTRY), count = _lw(ENTRY_COUNT);
+
+  shimCount += ANIM_TICKS_PER_STEP;
+  callCount = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (i == current)
+      drawMenuItemSelected(MENU_X, MENU_Y + i * 20, NULL, 0x80, entryStrings[i], i << 3);
+    else
+      drawMenuItemUnselected(MENU_X, MENU_Y + i * 20, NULL, 0x80, entryStrings[i], i << 3);
+  }
+}
+
+// Original unselected item alpha
+static int referenceAlpha(int Y, int limit) {
+  int alpha = (Y < 0) ? 128 + (Y * (128 / limit)) : 128 - (Y * (128 / limit));
+  return (alpha < 0) ? 0 : alpha;
+}
+
+// Scroll position of the last checked frame
+static int frameOffsY;
+
+// Checks the frame against the original per-item math for the scroll position of the first drawn entry.
+// Returns the number of drawn entries
+static int checkFrame(void) {
+  int limit = (settings.displayedItems + 1) * 8;
+  uint32_t current = _lw(CURRENT_ENTRY), count = _lw(ENTRY_COUNT);
+  int drawn = 0, errors = 0, expected = 0;
+
+  for (int c = 0; c < callCount; c++) {
+    int entry = entryNumber(calls[c].string);
+    if (entry < 0)
+      continue;
+    if (!drawn) {
+      frameOffsY = entry * 16 - (calls[c].y - MENU_Y);
+      // Skip the invisible entries before the first drawn one
+      while (expected < (int)count && expected * 16 - frameOffsY <= -limit)
+        expected++;
+    }
+    drawn++;
+
+    // Every entry within the window is drawn in order, unselected entries have the original alpha
+    int Y = expected * 16 - frameOffsY;
+    if (entry != expected || Y >= limit || calls[c].x != MENU_X || calls[c].y != MENU_Y + Y)
+      errors++;
+    else if ((uint32_t)entry != current && calls[c].alpha != referenceAlpha(Y, limit))
+      errors++;
+    expected++;
+  }
+  // No visible entries are left out
+  if (expected < (int)count && expected * 16 - frameOffsY < limit)
+    errors++;
+  CHECK_EQ(errors, 0);
+  return drawn;
+}
+
+static void testCulling(void) {
+  int limit;
+  setupMenu();
+  limit = (settings.displayedItems + 1) * 8;
+
+  // The menu starts scrolled to the first entry
+  drawFrame();
+  CHECK_EQ(checkFrame(), (settings.displayedItems + 1) / 2);
+  CHECK_EQ(frameOffsY, 0);
+
+  // Scroll to the middle of the list and check every frame of the animation
+  int maxCalls = 0;
+  _sw(2 + ITEM_COUNT / 2, CURRENT_ENTRY);
+  for (int f = 0; f < 30; f++) {
+    drawFrame();
+    checkFrame();
+    if (callCount > maxCalls)
+      maxCalls = callCount;
+  }
+  // Visible entries, the cursors and the delimiters
+  CHECK(maxCalls <= settings.displayedItems + 5);
+
+  // The selected entry is centered after the animation
+  CHECK_EQ(checkFrame(), settings.displayedItems);
+  CHECK_EQ(frameOffsY, (2 + ITEM_COUNT / 2) * 16);
+  for (int c = 0; c < callCount; c++) {
+    if (calls[c].string == settings.menuDelimiterTop)
+      CHECK_EQ(calls[c].y, MENU_Y - limit);
+    if (calls[c].string == settings.menuDelimiterBottom)
+      CHECK_EQ(calls[c].y, MENU_Y + limit);
+  }
+
+  // The last entry
+  _sw(1 + ITEM_COUNT, CURRENT_ENTRY);
+  for (int f = 0; f < 30; f++)
+    drawFrame();
+  CHECK_EQ(checkFrame(), (settings.displayedItems + 1) / 2);
+  CHECK_EQ(frameOffsY, (1 + ITEM_COUNT) * 16);
+}
+
+//
+// Original implementation for the benchmark.
+// Per-item color copies, window bounds and alpha math, scrolling on the same 60 Hz timeline as the patch
+//
+static uint32_t refColorSelected[4], refColorUnselected[4];
+static int refOffsY, refDx, refVel = 1000, refAcc = 100;
+static animEasing refAnim;
+
+__attribute__((noipa)) static void refDrawMenuItemSelected(int X, int Y, uint32_t *color, int alpha, const char *string, int num) {
+  for (int i = 0; i < 4; i++)
+    refColorSelected[i] = settings.colorSelected[i];
+  if (alpha > 0x80)
+    alpha = 0x80;
+  Y = (num << 1) - refOffsY;
+  if ((Y < ((settings.displayedItems + 1) * 8)) && (Y > -((settings.displayedItems + 1) * 8))) {
+    refVel -= refAcc;
+    if (refVel < -settings.cursorMaxVelocity || refVel > settings.cursorMaxVelocity)
+      refAcc = -refAcc;
+    refDx += refVel;
+    drawMenuItemStub(settings.menuX, settings.menuY + Y, refColorSelected, alpha, string);
+    drawMenuItemStub(settings.menuX - 220 + (refDx >> 8), settings.menuY + Y, refColorSelected, alpha, settings.leftCursor);
+    drawMenuItemStub(settings.menuX + 220 - (refDx >> 8), settings.menuY + Y, refColorSelected, alpha, settings.rightCursor);
+  }
+  drawMenuItemStub(settings.menuX, settings.menuY - (settings.displayedItems * 8 + 8), refColorSelected, alpha, settings.menuDelimiterTop);
+  drawMenuItemStub(settings.menuX, settings.menuY + (settings.displayedItems * 8 + 8), refColorSelected, alpha, settings.menuDelimiterBottom);
+}
+
+__attribute__((noipa)) static void refDrawMenuItemUnselected(int X, int Y, uint32_t *color, int alpha, const char *string, int num) {
+  for (int i = 0; i < 4; i++)
+    refColorUnselected[i] = settings.colorUnselected[i];
+  if (num == 0) {
+    animSetTarget(&refAnim, _lw(CURRENT_ENTRY) << 4);
+    refOffsY = animUpdate(&refAnim, ANIM_TICKS_PER_STEP);
+  }
+  Y = (num << 1) - refOffsY;
+  if ((Y < ((settings.displayedItems + 1) * 8)) && (Y > -((settings.displayedItems + 1) * 8))) {
+    if (Y < 0)
+      alpha = 128 + (Y * (128 / ((settings.displayedItems + 1) * 8)));
+    else
+      alpha = 128 - (Y * (128 / ((settings.displayedItems + 1) * 8)));
+    if (alpha < 0)
+      alpha = 0;
+    drawMenuItemStub(settings.menuX, settings.menuY + Y, refColorUnselected, alpha, string);
+  }
+}
+
+static void refDrawFrame(void) {
+  uint32_t current = _lw(CURRENT_ENTRY), count = _lw(ENTRY_COUNT);
+
+  callCount = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (i == current)
+      refDrawMenuItemSelected(MENU_X, MENU_Y + i * 20, NULL, 0x80, entryStrings[i], i << 3);
+    else
+      refDrawMenuItemUnselected(MENU_X, MENU_Y + i * 20, NULL, 0x80, entryStrings[i], i << 3);
+  }
+}
+
+// Both implementations scroll through the whole list, moving the selection every 4 frames
+static uint64_t benchmark(void (*draw)(void), int *calls) {
+  uint64_t start = testTimeUs();
+  *calls = 0;
+  for (int f = 0; f < BENCH_FRAMES; f++) {
+    _sw(2 + (f / 4) % ITEM_COUNT, CURRENT_ENTRY);
+    draw();
+    *calls += callCount;
+  }
+  return testTimeUs() - start;
+}
+
+static void testBenchmark(void) {
+  uint64_t plannedTime = UINT64_MAX, originalTime = UINT64_MAX, t;
+  int planned, original;
+
+  setupMenu();
+  animJump(&refAnim, _lw(CURRENT_ENTRY) << 4);
+  // The fastest of several interleaved runs filters out the host noise
+  for (int r = 0; r < BENCH_RUNS; r++) {
+    if ((t = benchmark(refDrawFrame, &original)) < originalTime)
+      originalTime = t;
+    if ((t = benchmark(drawFrame, &planned)) < plannedTime)
+      plannedTime = t;
+  }
+  printf("  %d items, %d frames: %6llu us (%d draw calls), original %6llu us (%d draw calls)\n", ITEM_COUNT, BENCH_FRAMES,
+         (unsigned long long)plannedTime, planned, (unsigned long long)originalTime, original);
+
+  CHECK(planned <= original);
+  CHECK(plannedTime <= originalTime);
+}
+
+int main(void) {
+  eeRamInit();
+  testCulling();
+  testBenchmark();
+  return testReport("test_menu_draw");
+}
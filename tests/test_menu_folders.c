@@ -0,0 +1,182 @@
+// Menu folder navigation tests.
+// Loads a config file with nested folders, patches a synthetic OSDSYS menu and navigates it
+// through the patched input handler, checking the visible entries and the selection at every level
+#include "patches_fmcb.h"
+#include "patterns_fmcb.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "stubs_patcher.h"
+#include "test.h"
+
+// Patcher functions that are not declared in the headers
+const char *getStringPointer(const char **strings, uint32_t index);
+int handleMenuEntry(int selected);
+
+#define CNF_FILE "mc0:/SYS-CONF/OSDMENU.CNF"
+
+#define OSD_BASE 0x200000
+#define OFF_OSD_STRING 0x1000
+#define OFF_INPUT_HANDLER 0x2000
+#define OFF_MENU_INFO 0x3010
+
+// Menu info struct fields
+#define MENU_PTR (OSD_BASE + OFF_MENU_INFO + 4)
+#define ENTRY_COUNT (OSD_BASE + OFF_MENU_INFO + 8)
+#define CURRENT_ENTRY (OSD_BASE + OFF_MENU_INFO + 16)
+
+// Top level: Item A, >Games, >Empty, Orphan, >Cycle 1, Not in folder
+// >Games: Game 1, >Retro, Game 2
+// >Retro: Retro 1
+// >Cycle 1: >Cycle 2
+static const char cnf[] = "OSDSYS_reload_item = 1\r\n"
+                          "name_OSDSYS_ITEM_1 = Item A\r\n"
+                          "name_OSDSYS_ITEM_2 = >Games\r\n"
+                          "name_OSDSYS_ITEM_3 = Game 1\r\n"
+                          "parent_OSDSYS_ITEM_3 = 2\r\n"
+                          "name_OSDSYS_ITEM_4 = >Retro\r\n"
+                          "parent_OSDSYS_ITEM_4 = 2\r\n"
+                          "name_OSDSYS_ITEM_5 = Retro 1\r\n"
+                          "parent_OSDSYS_ITEM_5 = 4\r\n"
+                          "name_OSDSYS_ITEM_6 = Game 2\r\n"
+                          "parent_OSDSYS_ITEM_6 = 2\r\n"
+                          "name_OSDSYS_ITEM_7 = >Empty\r\n"
+                          // Missing parent
+                          "name_OSDSYS_ITEM_8 = Orphan\r\n"
+                          "parent_OSDSYS_ITEM_8 = 99\r\n"
+                          // Folders referencing each other
+                          "name_OSDSYS_ITEM_9 = >Cycle 1\r\n"
+                          "parent_OSDSYS_ITEM_9 = 10\r\n"
+                          "name_OSDSYS_ITEM_10 = >Cycle 2\r\n"
+                          "parent_OSDSYS_ITEM_10 = 9\r\n"
+                          // Parent that is not a folder
+                          "name_OSDSYS_ITEM_11 = Not in folder\r\n"
+                          "parent_OSDSYS_ITEM_11 = 1\r\n";
+
+#define TOP_LEVEL "Item A|>Games|>Empty|Orphan|>Cycle 1|Not in folder|Reload settings"
+
+static void placePattern(uint32_t offset, const uint32_t *pattern, int words) {
+  for (int i = 0; i < words; i++)
+    _sw(pattern[i], OSD_BASE + offset + i * 4);
+}
+#define PLACE(offset, name) placePattern((offset), name, sizeof(name) / sizeof(uint32_t))
+
+// Loads the config file and patches the menu with the given initial item
+static void setupMenu(int initialItem) {
+  memset((void *)OSD_BASE, 0, 0x4000);
+  PLACE(OFF_OSD_STRING, patternOSDString);
+  PLACE(OFF_INPUT_HANDLER, patternUserInputHandler);
+  PLACE(OFF_MENU_INFO, patternMenuInfo);
+  _sw(OSD_BASE + OFF_MENU_INFO - 16, OSD_BASE + OFF_MENU_INFO + 4);
+
+  shimSetRoot("build/fs/menu_folders");
+  shimWriteFile(CNF_FILE, cnf, sizeof(cnf) - 1);
+  initConfig();
+  CHECK_EQ(loadConfig(), 0);
+  settings.initialItem = initialItem;
+  CHECK_EQ(patchMenu((uint8_t *)OSD_BASE), 0);
+}
+
+// Returns the position of the item with the given name in settings
+static int itemPosition(const char *name) {
+  for (int i = 0; i < settings.menuItemCount; i++)
+    if (!strcmp(settings.menuItemName[i], name))
+      return i;
+  return -1;
+}
+
+// Checks the custom entries of the current level. Names are separated with '|'
+static void checkLevel(const char *expected, int selected) {
+  char names[512] = "";
+  uint32_t *menu = (uint32_t *)(uintptr_t)_lw(MENU_PTR);
+  uint32_t count = _lw(ENTRY_COUNT);
+
+  for (uint32_t i = 2; i < count; i++) {
+    if (i > 2)
+      strcat(names, "|");
+    strcat(names, getStringPointer(NULL, menu[i * 2]));
+  }
+  CHECK_STR(names, expected);
+  CHECK_EQ(_lw(CURRENT_ENTRY), selected);
+}
+
+// Selects the entry the way the patched input handler does and returns the handler result
+static int select(int entry) {
+  _sw(entry, CURRENT_ENTRY);
+  return handleMenuEntry(entry);
+}
+
+static void testNavigation(void) {
+  setupMenu(-1);
+
+  // Invalid parent references leave the items at the top level.
+  // The first folder of the cycle is moved to the top level, the second one stays in it
+  checkLevel(TOP_LEVEL, 0);
+
+  // Built-in entries are handled by OSDSYS
+  CHECK_EQ(select(0), 0);
+  CHECK_EQ(select(1), 1);
+  CHECK_EQ(stubLaunchCount, 0);
+
+  // Opening a folder selects the first item after ".."
+  stubsReset();
+  CHECK_EQ(select(3), 0);
+  checkLevel("..|Game 1|>Retro|Game 2", 3);
+  CHECK_EQ(select(4), 0);
+  checkLevel("..|Retro 1", 3);
+  CHECK_EQ(stubLaunchCount, 0);
+
+  // Items launch by their config file index
+  CHECK_EQ(select(3), 0);
+  CHECK_EQ(stubLaunchCount, 1);
+  CHECK_STR(stubLaunchedItem, "fmcb0:5");
+
+  // ".." goes back and selects the folder that was open
+  CHECK_EQ(select(2), 0);
+  checkLevel("..|Game 1|>Retro|Game 2", 4);
+  CHECK_EQ(select(2), 0);
+  checkLevel(TOP_LEVEL, 3);
+
+  // Empty folders only have ".."
+  CHECK_EQ(select(4), 0);
+  checkLevel("..", 2);
+  CHECK_EQ(select(2), 0);
+  checkLevel(TOP_LEVEL, 4);
+
+  // Entries past the end are ignored
+  CHECK_EQ(select(_lw(ENTRY_COUNT)), 0);
+  CHECK_EQ(stubLaunchCount, 1);
+
+  // The cycle is broken and both folders can be opened
+  CHECK_EQ(select(6), 0);
+  checkLevel("..|>Cycle 2", 3);
+  CHECK_EQ(select(3), 0);
+  checkLevel("..", 2);
+  CHECK_EQ(select(2), 0);
+  CHECK_EQ(select(2), 0);
+  checkLevel(TOP_LEVEL, 6);
+
+  // The reload entry is only on the top level
+  CHECK_EQ(select(_lw(ENTRY_COUNT) - 1), 0);
+  CHECK_EQ(stubReloadCount, 1);
+}
+
+static void testInitialItem(void) {
+  // The menu opens the folder containing the initial item and selects it
+  setupMenu(itemPosition("Retro 1"));
+  checkLevel("..|Retro 1", 3);
+  CHECK_EQ(select(2), 0);
+  checkLevel("..|Game 1|>Retro|Game 2", 4);
+
+  setupMenu(itemPosition("Game 2"));
+  checkLevel("..|Game 1|>Retro|Game 2", 5);
+
+  setupMenu(itemPosition("Orphan"));
+  checkLevel(TOP_LEVEL, 5);
+}
+
+int main(void) {
+  eeRamInit();
+  testNavigation();
+  testInitialItem();
+  return testReport("test_menu_folders");
+}
@@ -0,0 +1,499 @@
+// OSDSYS patch regression tests.
+// Builds synthetic OSDSYS images with every pattern at a known offset, applies the patches
+// and checks the exact instruction rewrites. Every patch is also timed on the full 1 MiB image
+#include "loader.h"
+#include "patches_common.h"
+#include "patches_fmcb.h"
+#include "patches_osdmenu.h"
+#include "patterns_common.h"
+#include "patterns_fmcb.h"
+#include "patterns_osdmenu.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "stubs_patcher.h"
+#include "test.h"
+#include <kernel.h>
+#include <setjmp.h>
+
+// Patcher functions that are not declared in the headers
+void patchExecuteOSDSYS(void *epc, void *gp);
+const char *getStringPointer(const char **strings, uint32_t index);
+int handleMenuEntry(int selected);
+void drawMenuItemSelected(int X, int Y, uint32_t *color, int alpha, const char *string, int num);
+void drawMenuItemUnselected(int X, int Y, uint32_t *color, int alpha, const char *string, int num);
+void getButtonsPanelType(int type);
+void drawIconLeft(int type, int X, int Y, int alpha);
+void drawIconRight(int type, int X, int Y, int alpha);
+void drawNonselectableEntryLeft(int X, int Y, uint32_t *color, int alpha, const char *string);
+void drawNonselectableEntryRight(int X, int Y, uint32_t *color, int alpha, const char *string);
+void versionInfoInitHandler();
+void browserDirSubmenuInitViewCustom(uint8_t *entryProps, uint8_t fileSubmenuType);
+int browserGetMcDirSizeCustom();
+extern uint32_t verinfoStringTableAddr;
+
+// OSDSYS is loaded at 0x200000 and the patches scan 1 MiB from there
+#define OSD_BASE 0x200000
+#define OSD_SIZE 0x100000
+
+// Pattern offsets in the synthetic image
+#define OFF_VIDEO_MODE 0x01000
+#define OFF_HDD_LOAD 0x02000
+#define OFF_DETECT_DISC 0x03000
+#define OFF_EXECUTE_DISC 0x04000
+#define OFF_MENU_LOOP 0x05000
+#define OFF_OSD_STRING 0x06000
+#define OFF_INPUT_HANDLER 0x07000
+#define OFF_MENU_INFO 0x08100
+#define OFF_DRAW_MENU_ITEM 0x09000
+#define OFF_BUTTON_PANEL 0x0a000
+#define OFF_VERSION_INIT 0x0b000
+#define OFF_VERSION_FUNC 0x0b400
+#define OFF_GS_GET_GPARAM 0x0c000
+#define OFF_FILE_MENU_INIT 0x0d000
+#define OFF_SUBMENU_FUNC 0x0d400
+#define OFF_GET_DIR_SIZE 0x0d800
+#define OFF_DIR_SIZE_FUNC 0x0dc00
+#define OFF_GET_DIR_FUNC 0x0de00
+#define OFF_STRINGS 0x0f000
+
+// Disc launch handler table address assembled from the ExecuteDisc lui/addiu pair
+#define DISC_HANDLERS 0x2f8010
+// Distance between the disc detection patterns, in instructions
+#define DETECT_DISC_DIST 0x10
+
+// Patches must finish well within this time on the host, even when the pattern is missing
+#define PATCH_TIME_LIMIT_US 50000
+
+static uint32_t seed;
+
+// Returns the next pseudo-random word
+static uint32_t nextRandom(void) {
+  seed = seed * 1664525 + 1013904223;
+  return seed;
+}
+
+static uint32_t jal(void *fn) { return 0x0c000000 | ((uint32_t)(uintptr_t)fn >> 2); }
+
+static uint32_t osdAddr(uint32_t offset) { return OSD_BASE + offset; }
+
+// Fills the image with pseudo-random words that don't match any pattern
+static void resetImage(void) {
+  seed = 0x4f534453;
+  for (uint32_t i = 0; i < OSD_SIZE; i += 4)
+    _sw(nextRandom(), OSD_BASE + i);
+}
+
+// Writes the pattern at the offset. Masked out bits are filled with random data to make sure the masks are honored
+static void placePattern(uint32_t offset, const uint32_t *pattern, const uint32_t *mask, int words) {
+  for (int i = 0; i < words; i++)
+    _sw((pattern[i] & mask[i]) | (nextRandom() & ~mask[i]), osdAddr(offset + i * 4));
+}
+#define PLACE(offset, name) placePattern((offset), name, name##_mask, sizeof(name) / sizeof(uint32_t))
+
+static void placeString(uint32_t offset, const char *str) { memcpy((void *)(uintptr_t)osdAddr(offset), str, strlen(str) + 1); }
+
+// Runs the patch and checks its duration
+#define TIMED_PATCH(res, call)                                                                                                                       \
+  do {                                                                                                                                               \
+    uint64_t _start = testTimeUs();                                                                                                                  \
+    res = (call);                                                                                                                                    \
+    uint64_t _time = testTimeUs() - _start;                                                                                                          \
+    printf("  %-40s %6llu us, result %d\n", #call, (unsigned long long)_time, res);                                                                 \
+    CHECK(_time < PATCH_TIME_LIMIT_US);                                                                                                              \
+  } while (0)
+
+// Menu items used by the menu patches
+static void initSettings(void) {
+  static char *names[] = {"Item A", ">Folder", "Item B"};
+  memset(&settings, 0, sizeof(settings));
+  settings.menuItemCount = 3;
+  for (int i = 0; i < 3; i++) {
+    settings.menuItemName[i] = names[i];
+    settings.menuItemIdx[i] = i + 1;
+    settings.menuItemParent[i] = -1;
+  }
+  settings.menuItemParent[2] = 1; // "Item B" is in ">Folder"
+  settings.initialItem = -1;
+  settings.displayedItems = 7;
+  settings.cursorMaxVelocity = 1000;
+  settings.cursorAcceleration = 100;
+  settings.scrollDuration = 150;
+}
+
+static void testVideoMode(void) {
+  int res;
+  resetImage();
+  TIMED_PATCH(res, patchVideoMode((uint8_t *)OSD_BASE, GS_MODE_NTSC));
+  CHECK_EQ(res, -1);
+
+  PLACE(OFF_VIDEO_MODE, patternVideoMode);
+  TIMED_PATCH(res, patchVideoMode((uint8_t *)OSD_BASE, GS_MODE_NTSC));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(osdAddr(OFF_VIDEO_MODE + 20)), 0x0000102d); // daddu v0, zero, zero
+
+  // The rewrite breaks the pattern, so the PAL patch needs a fresh image
+  resetImage();
+  PLACE(OFF_VIDEO_MODE, patternVideoMode);
+  TIMED_PATCH(res, patchVideoMode((uint8_t *)OSD_BASE, GS_MODE_PAL));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(osdAddr(OFF_VIDEO_MODE + 20)), 0x24020001); // li v0, 1
+}
+
+static void testSkipHDD(void) {
+  int res;
+  resetImage();
+  TIMED_PATCH(res, patchSkipHDD((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  PLACE(OFF_HDD_LOAD, patternHDDLoad);
+  _sw(0x04400012, osdAddr(OFF_HDD_LOAD + 28)); // bltz v0, +0x12
+  TIMED_PATCH(res, patchSkipHDD((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(osdAddr(OFF_HDD_LOAD + 8)), 0x10000017); // b +0x17, same target as the bltz
+}
+
+static void testSkipDisc(void) {
+  int res;
+  resetImage();
+  PLACE(OFF_DETECT_DISC, patternDetectDisc_1);
+  TIMED_PATCH(res, patchSkipDisc((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  // The second pattern is too far away
+  PLACE(OFF_DETECT_DISC + 48 + 4 * 0x42, patternDetectDisc_2);
+  uint32_t orig = _lw(osdAddr(OFF_DETECT_DISC + 48));
+  TIMED_PATCH(res, patchSkipDisc((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+  CHECK_EQ(_lw(osdAddr(OFF_DETECT_DISC + 48)), orig);
+
+  resetImage();
+  PLACE(OFF_DETECT_DISC, patternDetectDisc_1);
+  PLACE(OFF_DETECT_DISC + 48 + 4 * (DETECT_DISC_DIST + 1), patternDetectDisc_2);
+  TIMED_PATCH(res, patchSkipDisc((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(osdAddr(OFF_DETECT_DISC + 48)), 0x10000000 + DETECT_DISC_DIST); // b detectDisc2
+  CHECK_EQ(_lw(osdAddr(OFF_DETECT_DISC + 52)), 0);                             // nop
+}
+
+static void testDiscLaunch(void) {
+  int res;
+  resetImage();
+  TIMED_PATCH(res, patchDiscLaunch((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  PLACE(OFF_EXECUTE_DISC, patternExecuteDisc);
+  _sw(0x3c030030, osdAddr(OFF_EXECUTE_DISC + 40)); // lui v1, 0x0030
+  _sw(0x24638010, osdAddr(OFF_EXECUTE_DISC + 44)); // addiu v1, v1, -0x7ff0
+  _sw(0x12345678, DISC_HANDLERS + 12);             // DVD Video handler must stay
+  TIMED_PATCH(res, patchDiscLaunch((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+  for (int i = 0; i < 3; i++)
+    CHECK_EQ(_lw(DISC_HANDLERS + i * 4), (uint32_t)(uintptr_t)launchDisc);
+  CHECK_EQ(_lw(DISC_HANDLERS + 12), 0x12345678);
+}
+
+static void testInfiniteScrolling(void) {
+  static const uint32_t expected1[7] = {0x8e04fff8, 0x8e05fff0, 0x0004102a, 0x0082280b, 0x20a3ffff, 0x1000000c, 0xae03fff8};
+  static const uint32_t expected2[9] = {0x1040000e, 0x30620020, 0x8e05fff8, 0x8e02fff0, 0x24a30001, 0x0062102a, 0x0002180a, 0x00000000, 0xae03fff8};
+  uint32_t addr = osdAddr(OFF_MENU_LOOP);
+  int res;
+
+  resetImage();
+  PLACE(OFF_MENU_LOOP, patternMenuLoop);
+  // Unknown menu loop variant
+  TIMED_PATCH(res, patchMenuInfiniteScrolling((uint8_t *)OSD_BASE, 0));
+  CHECK_EQ(res, -1);
+
+  _sw(0x8e020100, addr - 4); // lw v0, 0x0100(s0)
+  _sw(0x30624000, addr + 9 * 4);
+  _sw(0x24045200, addr + 20 * 4);
+  TIMED_PATCH(res, patchMenuInfiniteScrolling((uint8_t *)OSD_BASE, 0));
+  CHECK_EQ(res, 0);
+  for (int i = 0; i < 7; i++)
+    CHECK_EQ(_lw(addr + (2 + i) * 4), expected1[i]);
+  for (int i = 0; i < 9; i++)
+    CHECK_EQ(_lw(addr + (11 + i) * 4), expected2[i]);
+  CHECK_EQ(_lw(addr + 10 * 4), 0x8e020100); // Reloads the normal pad variable
+  CHECK_EQ(_lw(addr - 4), 0x8e020108);      // Loads the key repeat variable
+}
+
+// Places the patterns used by patchMenu
+static void placeMenu(void) {
+  PLACE(OFF_OSD_STRING, patternOSDString);
+  PLACE(OFF_INPUT_HANDLER, patternUserInputHandler);
+  _sw(0x8c430c44, osdAddr(OFF_INPUT_HANDLER + 12)); // lw v1, 0x0c44(v0)
+
+  // Decoy struct that doesn't point to the menu
+  PLACE(OFF_MENU_INFO - 0x100, patternMenuInfo);
+  _sw(0x00100000, osdAddr(OFF_MENU_INFO - 0x100 + 4));
+
+  // Menu with "Browser" and "System Configuration" entries followed by the menu info struct
+  for (int i = 0; i < 4; i++)
+    _sw(0x100 + i, osdAddr(OFF_MENU_INFO - 16 + i * 4));
+  PLACE(OFF_MENU_INFO, patternMenuInfo);
+  _sw(osdAddr(OFF_MENU_INFO - 16), osdAddr(OFF_MENU_INFO + 4));
+}
+
+static void testMenu(void) {
+  uint32_t osdstr = osdAddr(OFF_OSD_STRING), handler = osdAddr(OFF_INPUT_HANDLER), menuInfo = osdAddr(OFF_MENU_INFO);
+  int res;
+
+  resetImage();
+  initSettings();
+  TIMED_PATCH(res, patchMenu((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  placeMenu();
+  TIMED_PATCH(res, patchMenu((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+
+  // OSD string function
+  CHECK_EQ(_lw(osdstr + 8), 0x0200282d); // daddu a1, s0, zero
+  CHECK_EQ(_lw(osdstr + 16), jal(getStringPointer));
+  CHECK_EQ(_lw(osdstr + 20), 0); // nop
+
+  // User input handler
+  CHECK_EQ(_lw(handler + 8), jal(handleMenuEntry));
+  CHECK_EQ(_lw(handler + 12), 0x8c440c44); // lw a0, 0x0c44(v0)
+  CHECK_EQ(_lw(handler + 16), 0x1040000a); // beq v0, zero, exit
+
+  // Menu info struct: 2 built-in entries and 2 top-level items, the decoy is untouched
+  CHECK(_lw(menuInfo + 4) != osdAddr(OFF_MENU_INFO - 16));
+  CHECK_EQ(_lw(menuInfo + 8), 4);
+  CHECK_EQ(_lw(osdAddr(OFF_MENU_INFO - 0x100 + 8)), 2);
+  uint32_t menu = _lw(menuInfo + 4);
+  for (int i = 0; i < 4; i++)
+    CHECK_EQ(((uint32_t *)(uintptr_t)menu)[i], 0x100 + i);
+  CHECK_EQ(((uint32_t *)(uintptr_t)menu)[4], 0x39390000); // "Item A"
+  CHECK_EQ(((uint32_t *)(uintptr_t)menu)[6], 0x39390001); // ">Folder"
+  CHECK_STR(getStringPointer(NULL, 0x39390001), ">Folder");
+}
+
+// Must run after testMenu since the menu draw patch uses the menu info struct
+static void testMenuDraw(void) {
+  uint32_t sel = osdAddr(OFF_DRAW_MENU_ITEM), unsel = sel + 48;
+  int res;
+
+  // The second call must follow the first one
+  PLACE(OFF_DRAW_MENU_ITEM, patternDrawMenuItem);
+  PLACE(OFF_DRAW_MENU_ITEM + 52, patternDrawMenuItem);
+  TIMED_PATCH(res, patchMenuDraw((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  PLACE(OFF_DRAW_MENU_ITEM + 48, patternDrawMenuItem);
+  TIMED_PATCH(res, patchMenuDraw((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(sel + 32), jal(drawMenuItemSelected));
+  CHECK_EQ(_lw(unsel + 32), jal(drawMenuItemUnselected));
+  CHECK_EQ(_lw(sel), 0x001048c0);       // sll t1, s0, 3
+  CHECK_EQ(_lw(sel + 4), 0x01231021);   // addu v0, t1, v1
+  CHECK_EQ(_lw(unsel), 0x001048c0);     // sll t1, s0, 3
+  CHECK_EQ(_lw(unsel + 4), 0x01231021); // addu v0, t1, v1
+}
+
+static void testMenuButtonPanel(void) {
+  uint32_t panel = osdAddr(OFF_BUTTON_PANEL);
+  uint32_t drawIcon = 0x0c0a0000, drawItem = 0x0c0b0000; // Original OSDSYS calls
+  int res;
+
+  PLACE(OFF_BUTTON_PANEL, patternDrawButtonPanel_1);
+  PLACE(OFF_BUTTON_PANEL + 0x100, patternDrawButtonPanel_2);
+  _sw(drawIcon, panel + 0x100 + 24);
+  PLACE(OFF_BUTTON_PANEL + 0x200, patternDrawButtonPanel_3);
+  _sw(drawItem, panel + 0x200 + 20);
+  // Second DrawNonSelectableItem call is missing
+  _sw(drawIcon, panel + 0x140);
+  TIMED_PATCH(res, patchMenuButtonPanel((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  resetImage();
+  PLACE(OFF_BUTTON_PANEL, patternDrawButtonPanel_1);
+  PLACE(OFF_BUTTON_PANEL + 0x100, patternDrawButtonPanel_2);
+  _sw(drawIcon, panel + 0x100 + 24);
+  _sw(drawIcon, panel + 0x140);
+  PLACE(OFF_BUTTON_PANEL + 0x200, patternDrawButtonPanel_3);
+  _sw(drawItem, panel + 0x200 + 20);
+  _sw(drawItem, panel + 0x240);
+  TIMED_PATCH(res, patchMenuButtonPanel((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(panel + 32), jal(getButtonsPanelType));
+  CHECK_EQ(_lw(panel + 0x100 + 24), jal(drawIconRight));
+  CHECK_EQ(_lw(panel + 0x140), jal(drawIconLeft));
+  CHECK_EQ(_lw(panel + 0x200 + 20), jal(drawNonselectableEntryRight));
+  CHECK_EQ(_lw(panel + 0x240), jal(drawNonselectableEntryLeft));
+}
+
+static void testVersionInfo(void) {
+  uint32_t call = osdAddr(OFF_VERSION_INIT + 4), func = osdAddr(OFF_VERSION_FUNC);
+  int res;
+
+  resetImage();
+  TIMED_PATCH(res, patchVersionInfo((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+
+  // String table address outside of the valid address space
+  PLACE(OFF_VERSION_INIT, patternVersionInit);
+  _sw(0x0c000000 | (func >> 2), call);
+  PLACE(OFF_VERSION_FUNC + 0x40, patternVersionStringTable);
+  _sw(0x3c030000, func + 0x40);     // lui v1, 0x0000
+  _sw(0x34631000, func + 0x40 + 8); // ori v1, v1, 0x1000
+  TIMED_PATCH(res, patchVersionInfo((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, -1);
+  CHECK_EQ(_lw(call), 0x0c000000 | (func >> 2));
+
+  _sw(0x3c03001f, func + 0x40);     // lui v1, 0x001f
+  _sw(0x34631238, func + 0x40 + 8); // ori v1, v1, 0x1238
+  PLACE(OFF_GS_GET_GPARAM, patternGsGetGParam);
+  TIMED_PATCH(res, patchVersionInfo((uint8_t *)OSD_BASE));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(call), jal(versionInfoInitHandler));
+  CHECK_EQ(verinfoStringTableAddr, 0x1f1238);
+}
+
+static void testBrowserLauncher(void) {
+  uint32_t fileMenu = osdAddr(OFF_FILE_MENU_INIT), getDirSize = osdAddr(OFF_GET_DIR_SIZE);
+  uint32_t dirSizeFunc = osdAddr(OFF_DIR_SIZE_FUNC), getDirFunc = osdAddr(OFF_GET_DIR_FUNC);
+  int res;
+
+  resetImage();
+  TIMED_PATCH(res, patchBrowserApplicationLaunch((uint8_t *)OSD_BASE, 0));
+  CHECK_EQ(res, -1);
+
+  // Browser file menu init calling browserDirSubmenuInitView
+  PLACE(OFF_FILE_MENU_INIT, patternBrowserFileMenuInit);
+  _sw(0xffb00000, fileMenu + 8);  // sd s0, 0x0000(sp)
+  _sw(0xffbf0010, fileMenu + 12); // sd ra, 0x0010(sp)
+  _sw(0x0c000000 | (osdAddr(OFF_SUBMENU_FUNC) >> 2), fileMenu + 16);
+  PLACE(OFF_SUBMENU_FUNC + 0x40, patternBrowserSelectedMC);
+
+  // browserGetMcDirSize call, the function and the sceMcGetDir wrapper it calls.
+  // The wrapper loads the result buffer address with lui v0 and addiu s1, v0
+  PLACE(OFF_GET_DIR_SIZE, patternBrowserGetMcDirSize);
+  _sw(0x0c000000 | (dirSizeFunc >> 2), getDirSize);
+  eeRamClear(dirSizeFunc, getDirFunc + 0x100);
+  _sw(0x0c000000 | (getDirFunc >> 2), dirSizeFunc + 8);
+  _sw(0x3c020030, getDirFunc + 12); // lui v0, 0x0030
+  _sw(0x24518000, getDirFunc + 20); // addiu s1, v0, -0x8000
+
+  TIMED_PATCH(res, patchBrowserApplicationLaunch((uint8_t *)OSD_BASE, 0));
+  CHECK_EQ(res, 0);
+  CHECK_EQ(_lw(fileMenu + 16), jal(browserDirSubmenuInitViewCustom));
+  CHECK_EQ(_lw(getDirSize), jal(browserGetMcDirSizeCustom));
+}
+
+// Runs patchExecuteOSDSYS on the image until it calls ExecPS2
+static void executeOSDSYS(void) {
+  jmp_buf exitJump;
+  memset(&shimExec, 0, sizeof(shimExec));
+  shimExitJump = &exitJump;
+  if (!setjmp(exitJump))
+    patchExecuteOSDSYS((void *)OSD_BASE, (void *)0x280000);
+  shimExitJump = NULL;
+}
+
+// Checks the patch table, the status string and the OSDSYS arguments
+static void testPatchEngine(void) {
+  resetImage();
+  initSettings();
+  settings.patcherFlags = FLAG_SKIP_DISC;
+  settings.videoMode = GS_MODE_NTSC;
+  PLACE(OFF_VIDEO_MODE, patternVideoMode);
+  PLACE(OFF_HDD_LOAD, patternHDDLoad);
+  _sw(0x04400012, osdAddr(OFF_HDD_LOAD + 28));
+  PLACE(OFF_DETECT_DISC, patternDetectDisc_1);
+  PLACE(OFF_DETECT_DISC + 48 + 4 * (DETECT_DISC_DIST + 1), patternDetectDisc_2);
+  PLACE(OFF_EXECUTE_DISC, patternExecuteDisc);
+  _sw(0x3c030030, osdAddr(OFF_EXECUTE_DISC + 40));
+  _sw(0x24638010, osdAddr(OFF_EXECUTE_DISC + 44));
+  placeString(OFF_STRINGS, "SkipMc");
+  placeString(OFF_STRINGS + 0x10, "mc0:/BREXEC-SYSTEM/osdmain.elf");
+  placeString(OFF_STRINGS + 0x40, "mc0:/BIEXEC-SYSTEM/osdmain.elf");
+
+  uint64_t start = testTimeUs();
+  executeOSDSYS();
+  printf("  %-40s %6llu us\n", "patchExecuteOSDSYS", (unsigned long long)(testTimeUs() - start));
+
+  // Video mode, skip disc, skip HDD and disc launch are applied, the version info patch fails
+  CHECK_STR(getPatchStatus(), "4/5 (00020)");
+  CHECK_EQ(_lw(osdAddr(OFF_VIDEO_MODE + 20)), 0x0000102d);
+  CHECK_EQ(_lw(osdAddr(OFF_HDD_LOAD + 8)), 0x10000017);
+  CHECK_EQ(_lw(osdAddr(OFF_DETECT_DISC + 48)), 0x10000000 + DETECT_DISC_DIST);
+  CHECK_EQ(_lw(DISC_HANDLERS), (uint32_t)(uintptr_t)launchDisc);
+
+  // System update paths are mangled
+  CHECK_STR((char *)(uintptr_t)osdAddr(OFF_STRINGS + 0x10), "mc0:/BREX");
+  CHECK_STR((char *)(uintptr_t)osdAddr(OFF_STRINGS + 0x40), "mc0:/BIEX");
+
+  CHECK_EQ(shimExec.calls, 1);
+  CHECK(shimExec.entry == (void *)OSD_BASE);
+  CHECK_EQ(shimExec.argc, 3);
+  CHECK_STR(shimExec.argv[0], "rom0:");
+  CHECK_STR(shimExec.argv[1], "BootClock");
+  CHECK_STR(shimExec.argv[2], "SkipMc");
+
+  // ROMs supporting SkipHdd get the argument instead of the patch
+  resetImage();
+  PLACE(OFF_HDD_LOAD, patternHDDLoad);
+  uint32_t orig = _lw(osdAddr(OFF_HDD_LOAD + 8));
+  placeString(OFF_STRINGS, "SkipHdd");
+  settings.patcherFlags = FLAG_BOOT_BROWSER;
+  settings.videoMode = 0;
+  executeOSDSYS();
+  CHECK_STR(getPatchStatus(), "0/2 (00220)"); // Only version info and disc launch are attempted, both fail
+  CHECK_EQ(_lw(osdAddr(OFF_HDD_LOAD + 8)), orig);
+  CHECK_EQ(shimExec.argc, 3);
+  CHECK_STR(shimExec.argv[1], "BootBrowser");
+  CHECK_STR(shimExec.argv[2], "SkipHdd");
+}
+
+// Checks that patches run only after the patch they depend on was applied
+static void testPatchDependencies(void) {
+  uint32_t sel = osdAddr(OFF_DRAW_MENU_ITEM);
+
+  // The menu patch fails, so the menu draw patch isn't applied even though its patterns are there
+  resetImage();
+  initSettings();
+  settings.patcherFlags = FLAG_CUSTOM_MENU;
+  PLACE(OFF_DRAW_MENU_ITEM, patternDrawMenuItem);
+  PLACE(OFF_DRAW_MENU_ITEM + 48, patternDrawMenuItem);
+  uint32_t orig = _lw(sel + 32);
+  executeOSDSYS();
+  CHECK_STR(getPatchStatus(), "0/7 (0032F)"); // Menu patches, version info, skip HDD and disc launch
+  CHECK_EQ(_lw(sel + 32), orig);
+
+  // Menu draw is applied once the menu patch is
+  placeMenu();
+  executeOSDSYS();
+  CHECK_STR(getPatchStatus(), "2/7 (0032C)");
+  CHECK_EQ(_lw(osdAddr(OFF_OSD_STRING + 16)), jal(getStringPointer));
+  CHECK_EQ(_lw(sel + 32), jal(drawMenuItemSelected));
+
+  // 480p is output as NTSC, both video mode patches are attempted
+  resetImage();
+  initSettings();
+  settings.videoMode = GS_MODE_DTV_480P;
+  PLACE(OFF_VIDEO_MODE, patternVideoMode);
+  executeOSDSYS();
+  CHECK_STR(getPatchStatus(), "1/5 (00720)"); // The GS patch fails
+  CHECK_EQ(_lw(osdAddr(OFF_VIDEO_MODE + 20)), 0x0000102d);
+}
+
+int main(void) {
+  eeRamInit();
+  stubsReset();
+
+  testVideoMode();
+  testSkipHDD();
+  testSkipDisc();
+  testDiscLaunch();
+  testInfiniteScrolling();
+  testMenu();
+  testMenuDraw();
+  testMenuButtonPanel();
+  testVersionInfo();
+  testBrowserLauncher();
+  testPatchEngine();
+  testPatchDependencies();
+
+  return testReport("test_patches");
+}
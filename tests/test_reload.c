@@ -0,0 +1,198 @@
+// Settings reload tests.
+// Boots with one config file, selects the reload entry of the patched menu with another config file on the card
+// and checks that the menu, the colors, the geometry and the resolved paths come from the new config file
+#include "loader.h"
+#include "patches_fmcb.h"
+#include "patterns_fmcb.h"
+#include "settings.h"
+#include "shim/shim.h"
+#include "test.h"
+#include <malloc.h>
+#include <unistd.h>
+
+// Patcher functions that are not declared in the headers
+const char *getStringPointer(const char **strings, uint32_t index);
+int handleMenuEntry(int selected);
+
+#define OSD_BASE 0x200000
+#define OFF_OSD_STRING 0x1000
+#define OFF_INPUT_HANDLER 0x2000
+#define OFF_MENU_INFO 0x3010
+
+// Menu info struct fields
+#define MENU_PTR (OSD_BASE + OFF_MENU_INFO + 4)
+#define ENTRY_COUNT (OSD_BASE + OFF_MENU_INFO + 8)
+
+#define IPCONFIG "SYS-CONF/IPCONFIG.DAT"
+
+// Config A is on the boot card. The launcher and IPCONFIG.DAT are next to it
+static const char cnfA[] = "OSDSYS_reload_item = 1\r\n"
+                           "OSDSYS_menu_x = 300\r\n"
+                           "OSDSYS_menu_y = 100\r\n"
+                           "OSDSYS_num_displayed_items = 5\r\n"
+                           "OSDSYS_selected_color = 0x10,0x20,0x30,0x80\r\n"
+                           "OSDSYS_unselected_color = 0x40,0x50,0x60,0x80\r\n"
+                           "path_LAUNCHER_ELF = mc?:/BOOT/A.ELF\r\n"
+                           "name_OSDSYS_ITEM_1 = First A\r\n"
+                           "path1_OSDSYS_ITEM_1 = mass:/A1.ELF\r\n"
+                           "name_OSDSYS_ITEM_2 = Second A\r\n"
+                           "path1_OSDSYS_ITEM_2 = mass:/A2.ELF\r\n";
+
+// Config B replaces every value. Its launcher is only on the other card
+static const char cnfB[] = "OSDSYS_reload_item = 1\r\n"
+                           "OSDSYS_menu_x = 340\r\n"
+                           "OSDSYS_menu_y = 120\r\n"
+                           "OSDSYS_num_displayed_items = 9\r\n"
+                           "OSDSYS_selected_color = 0x70,0x71,0x72,0x80\r\n"
+                           "OSDSYS_unselected_color = 0x73,0x74,0x75,0x80\r\n"
+                           "path_LAUNCHER_ELF = mc?:/BOOT/B.ELF\r\n"
+                           "name_OSDSYS_ITEM_3 = Only B\r\n"
+                           "path1_OSDSYS_ITEM_3 = mass:/B3.ELF\r\n"
+                           "name_OSDSYS_ITEM_5 = Second B\r\n"
+                           "path1_OSDSYS_ITEM_5 = mass:/B5.ELF\r\n"
+                           "name_OSDSYS_ITEM_7 = Third B\r\n";
+
+// Config on the other card that must never be loaded
+static const char cnfOther[] = "OSDSYS_reload_item = 1\r\n"
+                               "name_OSDSYS_ITEM_1 = Wrong card\r\n";
+
+static void placePattern(uint32_t offset, const uint32_t *pattern, int words) {
+  for (int i = 0; i < words; i++)
+    _sw(pattern[i], OSD_BASE + offset + i * 4);
+}
+#define PLACE(offset, name) placePattern((offset), name, sizeof(name) / sizeof(uint32_t))
+
+// Patches the menu of a freshly loaded OSDSYS image, as OSDSYS startup does
+static void patchImage(void) {
+  memset((void *)OSD_BASE, 0, 0x4000);
+  PLACE(OFF_OSD_STRING, patternOSDString);
+  PLACE(OFF_INPUT_HANDLER, patternUserInputHandler);
+  PLACE(OFF_MENU_INFO, patternMenuInfo);
+  _sw(OSD_BASE + OFF_MENU_INFO - 16, OSD_BASE + OFF_MENU_INFO + 4);
+  CHECK_EQ(patchMenu((uint8_t *)OSD_BASE), 0);
+}
+
+// Checks the custom entries of the top level. Names are separated with '|'
+static void checkMenu(const char *expected) {
+  char names[512] = "";
+  uint32_t *menu = (uint32_t *)(uintptr_t)_lw(MENU_PTR);
+  uint32_t count = _lw(ENTRY_COUNT);
+
+  for (uint32_t i = 2; i < count; i++) {
+    if (i > 2)
+      strcat(names, "|");
+    strcat(names, getStringPointer(NULL, menu[i * 2]));
+  }
+  CHECK_STR(names, expected);
+}
+
+static void checkColors(const uint32_t *color, uint32_t r, uint32_t g, uint32_t b) {
+  CHECK_EQ(color[0], r);
+  CHECK_EQ(color[1], g);
+  CHECK_EQ(color[2], b);
+  CHECK_EQ(color[3], 0x80);
+}
+
+// Boots the patcher from mc1 the way main does
+static void boot(void) {
+  initConfig();
+  settings.mcSlot = 1;
+  CHECK_EQ(loadConfig(), 0);
+  CHECK_EQ(probeLauncher(), 0);
+  resolveFilePaths();
+  patchImage();
+}
+
+// Selects the reload entry. Returns once the reloaded patcher fails to load OSDSYS from the host ROM
+static void selectReload(void) {
+  jmp_buf exitJump;
+  int loads = shimLoadElfCalls;
+
+  shimExitJump = &exitJump;
+  if (!setjmp(exitJump)) {
+    handleMenuEntry(_lw(ENTRY_COUNT) - 1);
+    CHECK(0); // Reload never returns
+  }
+  shimExitJump = NULL;
+  CHECK_EQ(shimLoadElfCalls, loads + 1); // OSDSYS was restarted
+}
+
+static void testReload(void) {
+  shimSetRoot("build/fs/reload");
+  shimWriteFile("mc1:/SYS-CONF/OSDMENU.CNF", cnfA, sizeof(cnfA) - 1);
+  shimWriteFile("mc0:/SYS-CONF/OSDMENU.CNF", cnfOther, sizeof(cnfOther) - 1);
+  shimWriteFile("mc1:/BOOT/A.ELF", "A", 1);
+  shimWriteFile("mc0:/BOOT/B.ELF", "B", 1);
+  shimWriteFile("mc1:/" IPCONFIG, "10.0.0.2", 8);
+
+  boot();
+  CHECK_EQ(settings.mcSlot, 1);
+  CHECK_STR(settings.launcherPath, "mc1:/BOOT/A.ELF");
+  CHECK_STR(settings.ipconfigPath, "mc1:/" IPCONFIG);
+  checkMenu("First A|Second A|Reload settings");
+
+  // Switch to config B and remove IPCONFIG.DAT
+  shimWriteFile("mc1:/SYS-CONF/OSDMENU.CNF", cnfB, sizeof(cnfB) - 1);
+  unlink(shimHostPath("mc1:/" IPCONFIG));
+  shimResetIO();
+  selectReload();
+  shimIOStats reloadIO = shimIO;
+  patchImage();
+
+  // The config is loaded from the same card even though the other card has one too
+  CHECK_EQ(settings.mcSlot, 1);
+  checkMenu("Only B|Second B|Third B|Reload settings");
+  CHECK_EQ(settings.menuItemCount, 3);
+  CHECK_STR(settings.menuItemName[0], "Only B");
+  CHECK_EQ(settings.menuItemIdx[0], 3);
+  CHECK_EQ(settings.menuItemIdx[1], 5);
+  CHECK_EQ(settings.menuItemIdx[2], 7);
+  CHECK(settings.menuItemName[3] == NULL);
+  checkColors(settings.colorSelected, 0x70, 0x71, 0x72);
+  checkColors(settings.colorUnselected, 0x73, 0x74, 0x75);
+  CHECK_EQ(settings.menuX, 340);
+  CHECK_EQ(settings.menuY, 120);
+  CHECK_EQ(settings.displayedItems, 9);
+
+  // Paths are resolved again: the launcher falls back to the other card and IPCONFIG.DAT is gone
+  CHECK_STR(settings.launcherPath, "mc0:/BOOT/B.ELF");
+  CHECK_STR(settings.ipconfigPath, "");
+
+  // Item paths come from the new config file
+  uint8_t handoff[256];
+  handoffInit((handoffHeader *)handoff, 5, settings.mcSlot, 0);
+  CHECK_EQ(loadItemHandoff(5, (handoffHeader *)handoff, sizeof(handoff)), 1);
+  handoffInit((handoffHeader *)handoff, 1, settings.mcSlot, 0);
+  CHECK(loadItemHandoff(1, (handoffHeader *)handoff, sizeof(handoff)) < 0);
+
+  // Back to config A
+  shimWriteFile("mc1:/SYS-CONF/OSDMENU.CNF", cnfA, sizeof(cnfA) - 1);
+  shimWriteFile("mc1:/" IPCONFIG, "10.0.0.2", 8);
+  selectReload();
+  patchImage();
+  checkMenu("First A|Second A|Reload settings");
+  CHECK_STR(settings.launcherPath, "mc1:/BOOT/A.ELF");
+  CHECK_STR(settings.ipconfigPath, "mc1:/" IPCONFIG);
+
+  // Reloading B and A again leaves the heap in the same state, so the string pool isn't leaked
+  size_t heapUsed = mallinfo2().uordblks;
+  for (int i = 0; i < 2; i++) {
+    shimWriteFile("mc1:/SYS-CONF/OSDMENU.CNF", cnfB, sizeof(cnfB) - 1);
+    selectReload();
+    patchImage();
+    shimWriteFile("mc1:/SYS-CONF/OSDMENU.CNF", cnfA, sizeof(cnfA) - 1);
+    selectReload();
+    patchImage();
+    CHECK_EQ(mallinfo2().uordblks, heapUsed);
+  }
+  checkMenu("First A|Second A|Reload settings");
+
+  // The reload cost before OSDSYS restarts and applies the patches again
+  printf("  reload: %d opens, %d failed opens, %d bytes read\n", reloadIO.opens, reloadIO.failedOpens, reloadIO.bytesRead);
+}
+
+int main(void) {
+  eeRamInit();
+  testReload();
+  return testReport("test_reload");
+}
@@ -0,0 +1,82 @@
+// Menu item string pool tests.
+// Loads config files with 10, 100 and 250 items and compares the memory used by PatcherSettings and the pool
+// with the fixed-size name arrays PatcherSettings had before the string pool
+#include "settings.h"
+#include "shim/shim.h"
+#include "stubs_patcher.h"
+#include "test.h"
+#include <malloc.h>
+
+#define CNF_FILE "mc0:/SYS-CONF/OSDMENU.CNF"
+
+// PatcherSettings size on the EE, where pointers are 32-bit
+#define EE_SETTINGS_SIZE (sizeof(PatcherSettings) - sizeof(settings.menuItemName) + CUSTOM_ITEMS * 4)
+// PatcherSettings size with the names stored in char[CUSTOM_ITEMS][NAME_LEN]
+#define FIXED_SETTINGS_SIZE (EE_SETTINGS_SIZE - CUSTOM_ITEMS * 4 + CUSTOM_ITEMS * NAME_LEN)
+
+static char cnf[CUSTOM_ITEMS * 96];
+
+// Returns the name of the item. Lengths vary between 6 and 37 characters
+static void itemName(char *buf, int item) { sprintf(buf, "Game %d %.*s", item, item % 32, "with a very long title that fits"); }
+
+// Writes the config file with the given number of items
+static void writeConfig(int count) {
+  char name[NAME_LEN];
+  int len = 0;
+
+  for (int i = 1; i <= count; i++) {
+    itemName(name, i);
+    len += sprintf(&cnf[len], "name_OSDSYS_ITEM_%d = %s\r\npath1_OSDSYS_ITEM_%d = mass:/APP%d.ELF\r\n", i, name, i, i);
+  }
+  shimWriteFile(CNF_FILE, cnf, len);
+}
+
+static void testFootprint(int count) {
+  char name[NAME_LEN], path[32];
+  size_t poolBytes = 0, nameBytes = 0;
+
+  shimSetRoot("build/fs/string_pool");
+  writeConfig(count);
+  // The first load allocates the file buffers kept by the C library, they don't belong to the patcher
+  initConfig();
+  CHECK_EQ(loadConfig(), 0);
+  initConfig();
+  size_t heapUsed = mallinfo2().uordblks;
+  CHECK_EQ(loadConfig(), 0);
+  CHECK_EQ(settings.menuItemCount, count);
+
+  // Each name is followed by the item path for the handoff block and the empty string ending the item
+  char *pool = settings.menuItemName[0];
+  for (int i = 0; i < count; i++) {
+    itemName(name, i + 1);
+    CHECK_STR(settings.menuItemName[i], name);
+    CHECK(settings.menuItemName[i] == pool + poolBytes);
+    nameBytes += strlen(name) + 1;
+    poolBytes += strlen(name) + 2 + sprintf(path, "mass:/APP%d.ELF", i + 1) + 2;
+  }
+
+  // The pool is the only allocation left behind by loadConfig and is sized to the strings
+  size_t poolSize = malloc_usable_size(pool);
+  CHECK(poolSize >= poolBytes);
+  CHECK(poolSize < poolBytes + 2 * sizeof(size_t));
+  CHECK(mallinfo2().uordblks - heapUsed <= poolSize + sizeof(size_t));
+
+  // Names alone take less than the fixed arrays even with the pointer table
+  CHECK(EE_SETTINGS_SIZE + nameBytes < FIXED_SETTINGS_SIZE);
+  CHECK(EE_SETTINGS_SIZE + poolSize < FIXED_SETTINGS_SIZE);
+
+  // The pool is released when the config is loaded again
+  initConfig();
+  CHECK_EQ(mallinfo2().uordblks, heapUsed);
+
+  printf("  %3d items: %5zu bytes (settings %zu, names %zu, item paths %zu), fixed names %zu bytes\n", count, EE_SETTINGS_SIZE + poolSize,
+         EE_SETTINGS_SIZE, nameBytes, poolSize - nameBytes, FIXED_SETTINGS_SIZE);
+}
+
+int main(void) {
+  eeRamInit();
+  testFootprint(10);
+  testFootprint(100);
+  testFootprint(CUSTOM_ITEMS);
+  return testReport("test_string_pool");
+}
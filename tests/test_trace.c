@@ -0,0 +1,140 @@
+// Boot trace tests.
+// Records events with a simulated COP0 Count register, checks the dumped blocks and decodes them with tracedump
+#include "shim/shim.h"
+#include "test.h"
+#include "trace.h"
+#include <stdlib.h>
+
+#define TRACE_FILE "mc0:/SYS-CONF/OSDMENU.TRC"
+
+// EE cycles per millisecond
+#define MS(n) ((uint32_t)((n) * 294912))
+
+static void record(uint32_t count, uint8_t phase, uint8_t type, uint16_t arg) {
+  shimCount = count;
+  traceRecord(phase, type, arg);
+}
+
+// Dumps the ring and returns the block events
+static traceEvent *dump(uint16_t source, int expectedCount) {
+  int size;
+  traceBlockHeader *header = traceDump(source, &size);
+  CHECK_EQ(header->magic, TRACE_MAGIC);
+  CHECK_EQ(header->source, source);
+  CHECK_EQ(header->eventCount, expectedCount);
+  CHECK_EQ(size, sizeof(traceBlockHeader) + expectedCount * sizeof(traceEvent));
+  return (traceEvent *)&header[1];
+}
+
+static void testTimestamps(void) {
+  record(0x12345600, TRACE_PATCHER_MAIN, TRACE_EVENT_BEGIN, 0);
+  record(0x12345700, TRACE_LOAD_CONFIG, TRACE_EVENT_END, 7);
+  // Count wraps around
+  record(0x00000100, TRACE_SPLASH, TRACE_EVENT_MARK, 0xffff);
+
+  traceEvent *events = dump(0, 3);
+  CHECK_EQ(events[0].timestamp, 0x00123456);
+  CHECK_EQ(events[0].phase, TRACE_PATCHER_MAIN);
+  CHECK_EQ(events[0].type, TRACE_EVENT_BEGIN);
+  CHECK_EQ(events[1].timestamp, 0x00123457);
+  CHECK_EQ(events[1].arg, 7);
+  CHECK_EQ(events[2].timestamp, 0x01000001); // Wraparound counter in the upper 8 bits
+  CHECK_EQ(events[2].type, TRACE_EVENT_MARK);
+  CHECK_EQ(events[2].arg, 0xffff);
+
+  // The ring is empty after the dump
+  dump(0, 0);
+}
+
+static void testRingOverflow(void) {
+  for (int i = 0; i < TRACE_MAX_EVENTS + 6; i++)
+    record(0x01000000 + i * 0x100, TRACE_LOAD_ELF, TRACE_EVENT_MARK, i);
+
+  // The oldest events are overwritten and the rest are dumped in order
+  traceEvent *events = dump(1, TRACE_MAX_EVENTS);
+  for (int i = 0; i < TRACE_MAX_EVENTS; i++)
+    CHECK_EQ(events[i].arg, i + 6);
+}
+
+// Appends the dumped block to the trace file
+static void appendBlock(FILE *f, uint16_t source) {
+  int size;
+  void *block = traceDump(source, &size);
+  fwrite(block, 1, size, f);
+}
+
+static void testDecoder(void) {
+  static const char expected[] = "block 0: patcher, 6 events\n"
+                                 "      0.000 ms  begin patcher_main (0)\n"
+                                 "      1.000 ms  begin load_config (0)\n"
+                                 "      3.500 ms  end   load_config (0), took 2.500 ms\n"
+                                 "      4.000 ms  begin patch_osdsys (0)\n"
+                                 "      5.250 ms  end   patch_osdsys (0), took 1.250 ms\n"
+                                 "      6.000 ms  mark  launch_item (3)\n"
+                                 "  total patcher_main   unfinished\n"
+                                 "  total load_config    2.500 ms\n"
+                                 "  total patch_osdsys   1.250 ms\n"
+                                 "block 1: launcher, 6 events\n"
+                                 "      0.000 ms  begin launcher_main (0)\n"
+                                 "      1.000 ms  begin bdm_wait (0)\n"
+                                 "      3.000 ms  end   bdm_wait (2), took 2.000 ms\n"
+                                 "      4.000 ms  begin load_elf (0)\n"
+                                 "     10.000 ms  end   load_elf (0), took 6.000 ms\n"
+                                 "     10.000 ms  end   launcher_main (0), took 10.000 ms\n"
+                                 "  total launcher_main  10.000 ms\n"
+                                 "  total bdm_wait       2.000 ms\n"
+                                 "  total load_elf       6.000 ms\n";
+  const uint32_t base = 0x10000000;
+
+  shimSetRoot("build/fs/trace");
+  shimWriteFile(TRACE_FILE, "", 0);
+  FILE *f = fopen(shimHostPath(TRACE_FILE), "wb");
+  if (!f) {
+    CHECK(f != NULL);
+    return;
+  }
+
+  // Patcher block
+  record(base, TRACE_PATCHER_MAIN, TRACE_EVENT_BEGIN, 0);
+  record(base + MS(1), TRACE_LOAD_CONFIG, TRACE_EVENT_BEGIN, 0);
+  record(base + MS(3.5), TRACE_LOAD_CONFIG, TRACE_EVENT_END, 0);
+  record(base + MS(4), TRACE_PATCH_OSDSYS, TRACE_EVENT_BEGIN, 0);
+  record(base + MS(5.25), TRACE_PATCH_OSDSYS, TRACE_EVENT_END, 0);
+  record(base + MS(6), TRACE_LAUNCH_ITEM, TRACE_EVENT_MARK, 3);
+  appendBlock(f, 0);
+
+  // Launcher block. Count wraps around while waiting for BDM devices
+  const uint32_t start = 0 - MS(2);
+  record(start, TRACE_LAUNCHER_MAIN, TRACE_EVENT_BEGIN, 0);
+  record(start + MS(1), TRACE_BDM_WAIT, TRACE_EVENT_BEGIN, 0);
+  record(start + MS(3), TRACE_BDM_WAIT, TRACE_EVENT_END, 2);
+  record(start + MS(4), TRACE_LOAD_ELF, TRACE_EVENT_BEGIN, 0);
+  record(start + MS(10), TRACE_LOAD_ELF, TRACE_EVENT_END, 0);
+  record(start + MS(10), TRACE_LAUNCHER_MAIN, TRACE_EVENT_END, 0);
+  appendBlock(f, 1);
+  fclose(f);
+
+  char cmd[1200], output[4096];
+  snprintf(cmd, sizeof(cmd), "%s '%s' 2>&1", TRACEDUMP, shimHostPath(TRACE_FILE));
+  FILE *p = popen(cmd, "r");
+  size_t len = fread(output, 1, sizeof(output) - 1, p);
+  output[len] = '\0';
+  CHECK_EQ(pclose(p), 0);
+  CHECK_STR(output, expected);
+
+  // Truncated files are rejected
+  int size = shimReadFile(TRACE_FILE, output, sizeof(output));
+  shimWriteFile(TRACE_FILE, output, size - 4);
+  p = popen(cmd, "r");
+  len = fread(output, 1, sizeof(output) - 1, p);
+  output[len] = '\0';
+  CHECK(pclose(p) != 0);
+  CHECK(strstr(output, "Block 1 is truncated") != NULL);
+}
+
+int main(void) {
+  testTimestamps();
+  testRingOverflow();
+  testDecoder();
+  return testReport("test_trace");
+}
@@ -0,0 +1,157 @@
+// Version menu patch tests.
+// Patches a synthetic OSDSYS image, checks the jal written at the version menu init call site
+// and opens the menu repeatedly, checking that the hardware revisions are only read on the first open.
+// OSDSYS functions called by the handler are x86-64 trampolines placed in the image
+#include "gs.h"
+#include "patches_osdmenu.h"
+#include "patterns_osdmenu.h"
+#include "shim/shim.h"
+#include "test.h"
+#include <sys/mman.h>
+
+// Patcher functions and variables that are not declared in the headers
+void versionInfoInitHandler();
+void formatRevision(char *dst, uint8_t rev);
+extern uint32_t verinfoStringTableAddr;
+
+#define OSD_BASE 0x200000
+#define OFF_VERSION_INIT 0x1000
+#define OFF_VERSION_FUNC 0x2000
+#define OFF_CD_APPLY_SCMD 0x3000
+
+#define STRING_TABLE 0x1f1238
+#define GS_REG_PAGE 0x12001000
+#define GS_REV 0x25
+#define MECHACON_MAJOR 5
+#define MECHACON_MINOR 12 // DTL flag is cleared
+
+static int versionInitCount;
+static int cdApplySCmdCount;
+
+static const char *builtinNames[] = {"Console", "Unit"};
+
+// Stands in for the OSDSYS version menu init function that rebuilds the built-in entries
+static void versionInfoInitStub(void) {
+  versionInitCount++;
+  memset((void *)STRING_TABLE, 0, 12 * 16);
+  for (int i = 0; i < 2; i++) {
+    _sw((uint32_t)(uintptr_t)builtinNames[i], STRING_TABLE + i * 12);
+    _sw((uint32_t)(uintptr_t)builtinNames[i], STRING_TABLE + i * 12 + 4);
+  }
+}
+
+// Stands in for sceCdApplySCmd and returns the MechaCon version
+static uint16_t *cdApplySCmdStub(uint16_t cmdNum, const void *inBuff, uint16_t inBuffSize, void *outBuff) {
+  static uint16_t result;
+  cdApplySCmdCount++;
+  if (cmdNum != 0x03)
+    return NULL;
+  ((uint8_t *)outBuff)[1] = MECHACON_MAJOR;
+  ((uint8_t *)outBuff)[2] = MECHACON_MINOR;
+  return &result;
+}
+
+// Writes x86-64 code jumping to fn at the address: movabs rax, fn; jmp rax
+static void placeTrampoline(uint32_t addr, void *fn) {
+  uint8_t *code = (uint8_t *)(uintptr_t)addr;
+  uint64_t target = (uint64_t)(uintptr_t)fn;
+  code[0] = 0x48;
+  code[1] = 0xb8;
+  memcpy(&code[2], &target, sizeof(target));
+  code[10] = 0xff;
+  code[11] = 0xe0;
+}
+
+static void placePattern(uint32_t offset, const uint32_t *pattern, int words) {
+  for (int i = 0; i < words; i++)
+    _sw(pattern[i], OSD_BASE + offset + i * 4);
+}
+#define PLACE(offset, name) placePattern((offset), name, sizeof(name) / sizeof(uint32_t))
+
+// Builds the image with the version menu init call, the init function and sceCdApplySCmd
+static void setupImage(void) {
+  uint32_t func = OSD_BASE + OFF_VERSION_FUNC, cmd = OSD_BASE + OFF_CD_APPLY_SCMD;
+
+  memset((void *)OSD_BASE, 0, 0x4000);
+  CHECK_EQ(mprotect((void *)OSD_BASE, 0x4000, PROT_READ | PROT_WRITE | PROT_EXEC), 0);
+
+  PLACE(OFF_VERSION_INIT, patternVersionInit);
+  _sw(0x0c000000 | (func >> 2), OSD_BASE + OFF_VERSION_INIT + 4);
+  placeTrampoline(func, versionInfoInitStub);
+  PLACE(OFF_VERSION_FUNC + 0x40, patternVersionStringTable);
+  _sw(0x3c030000 | (STRING_TABLE >> 16), func + 0x40);      // lui v1, 0x001f
+  _sw(0x34630000 | (STRING_TABLE & 0xffff), func + 0x40 + 8); // ori v1, v1, 0x1238
+
+  // The patch walks back from the pattern to addiu sp,sp,?. The jmp over its upper half is the prologue word
+  _sw(0x27bd02eb, cmd); // jmp +2
+  placeTrampoline(cmd + 4, cdApplySCmdStub);
+  PLACE(OFF_CD_APPLY_SCMD + 0x40, patternCdApplySCmd);
+}
+
+// Maps the GS registers page and sets the revision field of CSR
+static void setGSRevision(uint8_t rev) {
+  static int mapped = 0;
+  if (!mapped) {
+    void *regs = mmap((void *)GS_REG_PAGE, 0x1000, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    CHECK(regs == (void *)GS_REG_PAGE);
+    mapped = 1;
+  }
+  *GS_REG_CSR = (uint64_t)rev << 16;
+}
+
+// Returns the value of the custom entry with the given name or NULL
+static const char *entryValue(const char *name) {
+  for (uint32_t ptr = STRING_TABLE; _lw(ptr); ptr += 12)
+    if (!strcmp((const char *)(uintptr_t)_lw(ptr), name))
+      return (const char *)(uintptr_t)_lw(ptr + 4);
+  return NULL;
+}
+
+static void testPatchSite(void) {
+  uint32_t call = OSD_BASE + OFF_VERSION_INIT + 4;
+
+  setupImage();
+  CHECK_EQ(patchVersionInfo((uint8_t *)OSD_BASE), 0);
+  CHECK_EQ(verinfoStringTableAddr, STRING_TABLE);
+
+  // The call site is a jal to the handler, nothing else is touched
+  uint32_t word = _lw(call);
+  CHECK_EQ(word >> 26, 0x03);
+  CHECK_EQ((word & 0x03ffffff) << 2, (uint32_t)(uintptr_t)versionInfoInitHandler);
+  CHECK_EQ(_lw(call - 4), patternVersionInit[0]);
+  CHECK_EQ(_lw(call + 4), patternVersionInit[2]);
+
+  // Nothing is read from the hardware until the menu opens
+  CHECK_EQ(versionInitCount, 0);
+  CHECK_EQ(cdApplySCmdCount, 0);
+}
+
+static void testFirstOpen(void) {
+  char gsRev[5], eeRev[5];
+
+  setGSRevision(GS_REV);
+  formatRevision(gsRev, GS_REV);
+  formatRevision(eeRev, GetCop0(15));
+
+  for (int open = 1; open <= 3; open++) {
+    versionInfoInitHandler();
+
+    // The original init function runs on every open, the revisions are read once
+    CHECK_EQ(versionInitCount, open);
+    CHECK_EQ(cdApplySCmdCount, 1);
+    CHECK_STR(entryValue("Console"), "Console");
+    CHECK_STR(entryValue("Graphics Synthesizer"), gsRev);
+    CHECK_STR(entryValue("Emotion Engine"), eeRev);
+    CHECK_STR(entryValue("MechaCon"), "5.12");
+
+    // Changing the GS register after the first open doesn't change the value
+    setGSRevision(GS_REV + 1);
+  }
+}
+
+int main(void) {
+  eeRamInit();
+  testPatchSite();
+  testFirstOpen();
+  return testReport("test_version_info");
+}